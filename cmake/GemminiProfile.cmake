@@ -0,0 +1,53 @@
+# GemminiProfile.cmake - Compile definitions for a simulator specialized to a YAML profile
+#
+# gemmini_profile_definitions(<yaml> <name_var> <definitions_var>) reads the array
+# parameters from a configuration profile such as config/systolic_config.yaml and returns
+# the GEMMINI_PROFILE_* definitions that fix them at compile time (see src/utils/profile.hpp).
+# A parameter may appear in several sections (e.g. every PE) but must have one value.
+
+function(gemmini_profile_definitions yaml name_var definitions_var)
+    if(NOT EXISTS ${yaml})
+        message(FATAL_ERROR "GEMMINI_PROFILE file not found: ${yaml}")
+    endif()
+    get_filename_component(name ${yaml} NAME_WE)
+    string(MAKE_C_IDENTIFIER ${name} name)
+    file(STRINGS ${yaml} lines)
+
+    set(definitions "GEMMINI_PROFILE_NAME=\"${name}\"")
+    # Profile macro suffix and the YAML keys that set it
+    set(ROWS_KEYS rows systolic_rows)
+    set(COLS_KEYS cols systolic_cols)
+    set(COMPUTE_CYCLES_KEYS compute_cycles)
+    set(DELAY_CYCLES_KEYS delay_cycles)
+    set(ACT_WIDTH_KEYS act_width)
+    set(WEIGHT_WIDTH_KEYS weight_width)
+    foreach(param ROWS COLS COMPUTE_CYCLES DELAY_CYCLES ACT_WIDTH WEIGHT_WIDTH)
+        set(value "")
+        foreach(line IN LISTS lines)
+            foreach(key IN LISTS ${param}_KEYS)
+                if(line MATCHES "^[ \t]*${key}:[ \t]*([0-9]+)")
+                    if(NOT value STREQUAL "" AND NOT value STREQUAL CMAKE_MATCH_1)
+                        message(FATAL_ERROR "${yaml}: ${key} is set to both ${value} and "
+                                            "${CMAKE_MATCH_1}, a profile fixes one value")
+                    endif()
+                    set(value ${CMAKE_MATCH_1})
+                endif()
+            endforeach()
+        endforeach()
+        if(NOT value STREQUAL "")
+            list(APPEND definitions "GEMMINI_PROFILE_${param}=${value}")
+        endif()
+    endforeach()
+
+    # The array only implements the weight-stationary dataflow
+    foreach(line IN LISTS lines)
+        if(line MATCHES "^[ \t]*dataflow:[ \t]*([A-Za-z_]+)" AND
+           NOT CMAKE_MATCH_1 MATCHES "^(ws|WS|weight_stationary)$")
+            message(FATAL_ERROR "${yaml}: dataflow ${CMAKE_MATCH_1} is not supported, "
+                                "only weight stationary (ws)")
+        endif()
+    endforeach()
+
+    set(${name_var} ${name} PARENT_SCOPE)
+    set(${definitions_var} ${definitions} PARENT_SCOPE)
+endfunction()
@@ -0,0 +1,463 @@
+// batch_runner.cpp - Implementation of the parallel GEMM batch runner
+#include "driver/batch_runner.hpp"
+#include "gemmini/gemmini.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "utils/arena.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace gemmini {
+
+// The sparta tree-node registry is process-global, so trees are built and torn down
+// one at a time; the simulations themselves run concurrently
+static std::mutex & TreeMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// Parse a sysfs cpulist such as "0-3,8-11"
+static std::vector<uint32_t> ParseCpuList(const std::string & list) {
+    std::vector<uint32_t> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        size_t dash = range.find('-');
+        uint32_t first = std::stoul(range.substr(0, dash));
+        uint32_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+        for (uint32_t cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+// Order CPUs so consecutive workers alternate between NUMA nodes
+std::vector<uint32_t> BatchRunner::CpuOrder(std::vector<int32_t>* nodes) {
+    std::vector<std::vector<uint32_t>> nodeCpus;
+    for (uint32_t node = 0;; ++node) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file) {
+            break;
+        }
+        std::string list;
+        std::getline(file, list);
+        nodeCpus.push_back(ParseCpuList(list));
+    }
+
+    std::vector<uint32_t> order;
+    if (nodes) {
+        nodes->clear();
+    }
+    if (nodeCpus.empty()) {
+        // No NUMA information, use all CPUs in order
+        uint32_t count = std::max(1u, std::thread::hardware_concurrency());
+        for (uint32_t cpu = 0; cpu < count; ++cpu) {
+            order.push_back(cpu);
+            if (nodes) {
+                nodes->push_back(-1);
+            }
+        }
+        return order;
+    }
+
+    for (size_t i = 0;; ++i) {
+        bool added = false;
+        for (size_t node = 0; node < nodeCpus.size(); ++node) {
+            if (i < nodeCpus[node].size()) {
+                order.push_back(nodeCpus[node][i]);
+                if (nodes) {
+                    nodes->push_back(static_cast<int32_t>(node));
+                }
+                added = true;
+            }
+        }
+        if (!added) {
+            break;
+        }
+    }
+    return order;
+}
+
+// Pin the calling thread to one CPU
+static bool PinToCpu(uint32_t cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Load jobs from a file
+std::vector<BatchJob> BatchRunner::LoadJobs(const std::string & path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open batch file: " + path);
+    }
+
+    std::vector<BatchJob> jobs;
+    std::string line;
+    uint32_t lineNo = 0;
+    while (std::getline(file, line)) {
+        ++lineNo;
+        line = line.substr(0, line.find('#'));
+        std::stringstream ss(line);
+        BatchJob job;
+        if (!(ss >> job.name)) {
+            continue;
+        }
+        if (!(ss >> job.m >> job.k >> job.n) || job.m == 0 || job.k == 0 || job.n == 0) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNo) +
+                                     ": expected 'name m k n [seed]'");
+        }
+        if (!(ss >> job.seed)) {
+            job.seed = lineNo;
+        }
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+// Parse a what-if variant file
+std::vector<WhatIfVariant> BatchRunner::LoadVariants(const std::string & path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open variant file: " + path);
+    }
+
+    std::vector<WhatIfVariant> variants;
+    std::string line;
+    uint32_t lineNo = 0;
+    while (std::getline(file, line)) {
+        ++lineNo;
+        line = line.substr(0, line.find('#'));
+        std::stringstream ss(line);
+        WhatIfVariant variant;
+        if (!(ss >> variant.name)) {
+            continue;
+        }
+        std::string setting;
+        while (ss >> setting) {
+            size_t eq = setting.find('=');
+            if (eq == std::string::npos || eq + 1 == setting.size() ||
+                setting.find_first_not_of("0123456789", eq + 1) != std::string::npos) {
+                throw std::runtime_error(path + ":" + std::to_string(lineNo) +
+                                         ": expected knob=value, got '" + setting + "'");
+            }
+            variant.knobs.emplace_back(setting.substr(0, eq),
+                                       std::stoull(setting.substr(eq + 1)));
+        }
+        variants.push_back(variant);
+    }
+    return variants;
+}
+
+// Create a matrix with values from the generator
+static MatrixPtr CreateRandomMatrix(uint32_t rows, uint32_t cols, std::mt19937 & gen) {
+    MatrixPtr matrix = CreateMatrixPtr<Matrix>(rows, cols);
+    std::uniform_int_distribution<int16_t> dist(-10, 10);
+    for (uint32_t r = 0; r < rows; ++r) {
+        for (uint32_t c = 0; c < cols; ++c) {
+            matrix->At(r, c) = dist(gen);
+        }
+    }
+    return matrix;
+}
+
+// FNV-1a checksum over the result elements
+static uint64_t Checksum(const Matrix & matrix) {
+    uint64_t hash = 1469598103934665603ull;
+    for (uint32_t r = 0; r < matrix.Rows(); ++r) {
+        for (uint32_t c = 0; c < matrix.Cols(); ++c) {
+            hash ^= static_cast<uint16_t>(matrix.At(r, c));
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+// A built simulation, torn down under the tree lock
+struct SimulationInstance {
+    std::unique_ptr<sparta::Scheduler> scheduler;
+    std::unique_ptr<sparta::app::SimulationConfiguration> config;
+    std::unique_ptr<GemminiSimulation> sim;
+
+    ~SimulationInstance() {
+        std::lock_guard<std::mutex> lock(TreeMutex());
+        sim.reset();
+        config.reset();
+        scheduler.reset();
+    }
+};
+
+// Build and finalize a simulation tree
+static std::unique_ptr<SimulationInstance> BuildSimulation(const ClockConfig & clocks) {
+    std::unique_ptr<SimulationInstance> instance(new SimulationInstance());
+    std::lock_guard<std::mutex> lock(TreeMutex());
+    char progName[] = "gemmini_batch";
+    char* argv[] = {progName, nullptr};
+    instance->scheduler.reset(new sparta::Scheduler());
+    instance->config.reset(new sparta::app::SimulationConfiguration());
+    instance->sim.reset(new GemminiSimulation(instance->scheduler.get(), clocks));
+    instance->sim->configure(1, argv, instance->config.get());
+    instance->sim->buildTree();
+    instance->sim->configureTree();
+    instance->sim->finalizeTree();
+    instance->sim->finalizeFramework();
+    // Jobs run concurrently; results are reported through BatchResult instead
+    instance->sim->SetPrintResults(false);
+    return instance;
+}
+
+// Jobs running in this process, to tell whether a tree was measured in isolation
+static std::atomic<uint32_t> sRunningJobs(0);
+
+// Run a single job on the calling thread
+BatchResult BatchRunner::RunJob(const BatchJob & job, const ClockConfig & clocks,
+                                const MemoryBudget & budget) {
+    BatchResult result;
+    result.name = job.name;
+    auto start = std::chrono::steady_clock::now();
+    bool alone = sRunningJobs++ == 0;
+
+    try {
+        // Inputs are generated here so they are first touched by the thread that uses them
+        std::mt19937 gen(job.seed);
+        MatrixPtr a = CreateRandomMatrix(job.m, job.k, gen);
+        MatrixPtr b = CreateRandomMatrix(job.k, job.n, gen);
+
+        // The heap counters are process-wide: allocations of jobs running alongside the
+        // build would be counted as tree memory
+        std::unique_ptr<SimulationInstance> instance = BuildSimulation(clocks);
+        if (alone && sRunningJobs.load() == 1) {
+            result.tree_bytes = instance->sim->GetFootprint().TotalBytes();
+        }
+        instance->sim->SetMemoryBudget(budget);
+
+        MatrixPtr c = instance->sim->RunSimulation(a, b);
+        result.ticks = instance->sim->GetResultTick();
+        result.checksum = c ? Checksum(*c) : 0;
+        result.ok = c != nullptr;
+    } catch (const std::exception & e) {
+        result.ok = false;
+        result.error = e.what();
+    }
+
+    sRunningJobs--;
+    result.wall_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count();
+    return result;
+}
+
+// Build a job's tree and add the estimates for its run
+MemoryFootprint BatchRunner::MeasureJob(const BatchJob & job, const ClockConfig & clocks) {
+    std::unique_ptr<SimulationInstance> instance = BuildSimulation(clocks);
+    instance->sim->EstimateRun(job.m, job.k, job.n);
+    return instance->sim->GetFootprint();
+}
+
+// Finish a forked run with the variant's knobs applied
+static BatchResult RunVariant(SimulationInstance & instance, const WhatIfVariant & variant,
+                              uint64_t expectedCycles) {
+    BatchResult result;
+    auto start = std::chrono::steady_clock::now();
+    try {
+        for (const auto & knob : variant.knobs) {
+            if (!instance.sim->GetMatrixMultiplier()->SetKnob(knob.first, knob.second)) {
+                throw std::runtime_error("Unknown knob '" + knob.first + "'");
+            }
+        }
+        if (!instance.sim->RunUntilDone(expectedCycles)) {
+            throw std::runtime_error("Variant did not complete");
+        }
+        MatrixPtr c = instance.sim->FinishRun();
+        result.ticks = instance.sim->GetResultTick();
+        result.checksum = c ? Checksum(*c) : 0;
+        result.ok = c != nullptr;
+    } catch (const std::exception & e) {
+        result.ok = false;
+        result.error = e.what();
+    }
+    result.wall_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count();
+    return result;
+}
+
+// A forked variant run and the pipe its result comes back on
+struct WhatIfChild {
+    pid_t pid;
+    int fd;
+    size_t index;
+};
+
+// Read a child's result line ("ticks checksum wall_ms ok error") and reap it
+static BatchResult CollectChild(const WhatIfChild & child) {
+    std::string text;
+    char buffer[512];
+    ssize_t bytes;
+    while ((bytes = read(child.fd, buffer, sizeof(buffer))) > 0) {
+        text.append(buffer, static_cast<size_t>(bytes));
+    }
+    close(child.fd);
+    int status = 0;
+    waitpid(child.pid, &status, 0);
+
+    BatchResult result;
+    std::stringstream ss(text);
+    int ok = 0;
+    if (!(ss >> result.ticks >> std::hex >> result.checksum >> std::dec >> result.wall_ms >> ok)) {
+        result.error = "variant process exited without a result (status " +
+                       std::to_string(status) + ")";
+        return result;
+    }
+    result.ok = ok != 0;
+    std::getline(ss >> std::ws, result.error);
+    return result;
+}
+
+// Warm up once, then fork the variants off the warmed-up simulation
+std::vector<BatchResult> BatchRunner::RunWhatIf(const BatchJob & job, uint64_t warmupCycles,
+                                                const std::vector<WhatIfVariant> & variants,
+                                                const BatchRunnerConfig & config) {
+    std::mt19937 gen(job.seed);
+    MatrixPtr a = CreateRandomMatrix(job.m, job.k, gen);
+    MatrixPtr b = CreateRandomMatrix(job.k, job.n, gen);
+
+    std::unique_ptr<SimulationInstance> instance = BuildSimulation(config.clocks);
+    instance->sim->SetMemoryBudget(config.memory_budget);
+    uint64_t expectedCycles = instance->sim->StartRun(a, b);
+    uint64_t warmup = std::min(warmupCycles, expectedCycles);
+    instance->sim->RunCycles(warmup);
+
+    // Buffered output would otherwise be written once by every child
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(nullptr);
+
+    std::vector<BatchResult> results(variants.size());
+    std::vector<WhatIfChild> running;
+    size_t maxRunning = std::max(1u, config.workers);
+    for (size_t i = 0; i <= variants.size(); ++i) {
+        // Reap the oldest child when the pool is full, and all of them at the end
+        while (!running.empty() && (running.size() >= maxRunning || i == variants.size())) {
+            results[running.front().index] = CollectChild(running.front());
+            running.erase(running.begin());
+        }
+        if (i == variants.size()) {
+            break;
+        }
+
+        int fds[2];
+        if (pipe(fds) != 0) {
+            throw std::runtime_error("Cannot create pipe for what-if variant");
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            throw std::runtime_error("Cannot fork what-if variant");
+        }
+        if (pid == 0) {
+            // Child: finish the run and report; _exit skips the parent's teardown, so the
+            // child's DRAM trace is closed here
+            close(fds[0]);
+            MatrixMultiplier* multiplier = instance->sim->GetMatrixMultiplier();
+            multiplier->RestartDramTrace(variants[i].name);
+            BatchResult result = RunVariant(*instance, variants[i], expectedCycles);
+            multiplier->CloseDramTrace();
+            std::stringstream line;
+            line << result.ticks << " " << std::hex << result.checksum << std::dec << " "
+                 << result.wall_ms << " " << (result.ok ? 1 : 0) << " " << result.error << "\n";
+            std::string text = line.str();
+            ssize_t written = write(fds[1], text.data(), text.size());
+            std::cout.flush();
+            _exit(written == static_cast<ssize_t>(text.size()) ? 0 : 1);
+        }
+        close(fds[1]);
+        running.push_back({pid, fds[0], i});
+    }
+
+    for (size_t i = 0; i < variants.size(); ++i) {
+        results[i].name = job.name + "/" + variants[i].name;
+        results[i].worker = static_cast<uint32_t>(i % maxRunning);
+    }
+    return results;
+}
+
+// Worker thread body - claim jobs until none are left
+void BatchRunner::WorkerLoop(uint32_t worker, const std::vector<BatchJob> & jobs,
+                             std::vector<BatchResult> & results, std::atomic<size_t> & nextJob) {
+    int32_t cpu = -1;
+    int32_t node = -1;
+    if (mConfig.pin_workers) {
+        std::vector<int32_t> nodes;
+        std::vector<uint32_t> order = CpuOrder(&nodes);
+        size_t slot = worker % order.size();
+        if (PinToCpu(order[slot])) {
+            cpu = static_cast<int32_t>(order[slot]);
+            node = nodes[slot];
+        }
+    }
+
+    // The arena is created after pinning so its chunks land on this worker's node
+    Arena arena(mConfig.arena_chunk_bytes);
+    ArenaScope scope(&arena);
+
+    for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+        BatchResult result = RunJob(jobs[i], mConfig.clocks, mConfig.memory_budget);
+        result.worker = worker;
+        result.cpu = cpu;
+        result.numa_node = node;
+        result.arena_bytes = arena.BytesAllocated();
+        results[i] = result;
+
+        // Everything allocated for the job has been released
+        arena.Reset();
+    }
+}
+
+// Run all jobs across the worker pool
+std::vector<BatchResult> BatchRunner::Run(const std::vector<BatchJob> & jobs) {
+    std::vector<BatchResult> results(jobs.size());
+    std::atomic<size_t> nextJob(0);
+
+    uint32_t workers = std::max(1u, std::min<uint32_t>(mConfig.workers, jobs.size()));
+    std::vector<std::thread> threads;
+    for (uint32_t w = 0; w < workers; ++w) {
+        threads.emplace_back(&BatchRunner::WorkerLoop, this, w, std::cref(jobs), std::ref(results),
+                             std::ref(nextJob));
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    return results;
+}
+
+} // namespace gemmini
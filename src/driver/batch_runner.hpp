@@ -0,0 +1,98 @@
+// batch_runner.hpp - Parallel batch runner for independent GEMM simulations
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gemmini/common.hpp"
+#include "utils/clock_config.hpp"
+#include "utils/memory_footprint.hpp"
+
+BEGIN_NS(gemmini)
+
+// One GEMM job: C(m x n) = A(m x k) * B(k x n) with inputs generated from seed
+struct BatchJob {
+    std::string name;
+    uint32_t m = 0;
+    uint32_t k = 0;
+    uint32_t n = 0;
+    uint32_t seed = 0;
+};
+
+// Outcome of one job
+struct BatchResult {
+    std::string name;
+    uint64_t ticks = 0;        // Scheduler ticks simulated
+    uint64_t checksum = 0;     // Checksum of the result matrix
+    double wall_ms = 0.0;      // Host time for the job
+    uint32_t worker = 0;       // Worker that ran the job
+    int32_t cpu = -1;          // CPU the worker was pinned to, -1 if unpinned
+    int32_t numa_node = -1;    // NUMA node of that CPU, -1 if unknown
+    size_t arena_bytes = 0;    // Bytes served from the worker's arena
+    uint64_t tree_bytes = 0;   // Host memory of the simulation tree, 0 if not measured
+    std::string host;          // Host that ran the job, empty for local batches
+    bool ok = false;
+    std::string error;
+};
+
+// One what-if variant: runtime knobs applied to a forked copy of a warmed-up simulation
+struct WhatIfVariant {
+    std::string name;
+    std::vector<std::pair<std::string, uint64_t>> knobs; // MatrixMultiplier::SetKnob settings
+};
+
+// Batch runner configuration
+struct BatchRunnerConfig {
+    uint32_t workers = 1;              // Number of worker threads
+    bool pin_workers = true;           // Pin each worker to one CPU
+    size_t arena_chunk_bytes = 64 << 20; // Chunk size of each worker's arena
+    ClockConfig clocks;                // Clock domain frequencies for every job
+    MemoryBudget memory_budget;        // RSS budget checked before each job runs
+};
+
+// BatchRunner - runs jobs on a pool of workers. Each worker is pinned to a CPU (spread
+// across NUMA nodes), owns an allocation arena for matrices and payloads, and generates
+// its own input data and simulation tree, so all job memory is first touched locally.
+class BatchRunner {
+public:
+    explicit BatchRunner(const BatchRunnerConfig & config) : mConfig(config) {}
+
+    // Run all jobs, results are returned in job order
+    std::vector<BatchResult> Run(const std::vector<BatchJob> & jobs);
+
+    // Parse a job file: one "name m k n [seed]" per line, '#' starts a comment
+    static std::vector<BatchJob> LoadJobs(const std::string & path);
+
+    // Run a single job on the calling thread
+    static BatchResult RunJob(const BatchJob & job, const ClockConfig & clocks = ClockConfig(),
+                              const MemoryBudget & budget = MemoryBudget());
+
+    // Build the simulation tree for a job without running it and report its memory
+    static MemoryFootprint MeasureJob(const BatchJob & job,
+                                      const ClockConfig & clocks = ClockConfig());
+
+    // Run a job for warmupCycles mesh cycles, then fork one child process per variant that
+    // applies the variant's knobs and finishes the run. Children share the warmed-up state
+    // copy-on-write and at most config.workers run at once. Results are in variant order
+    // and named "job/variant".
+    static std::vector<BatchResult> RunWhatIf(const BatchJob & job, uint64_t warmupCycles,
+                                              const std::vector<WhatIfVariant> & variants,
+                                              const BatchRunnerConfig & config);
+
+    // Parse a variant file: one "name knob=value ..." per line, '#' starts a comment
+    static std::vector<WhatIfVariant> LoadVariants(const std::string & path);
+
+    // CPUs in pinning order, interleaved across NUMA nodes
+    static std::vector<uint32_t> CpuOrder(std::vector<int32_t>* nodes = nullptr);
+
+private:
+    const BatchRunnerConfig mConfig;
+
+    void WorkerLoop(uint32_t worker, const std::vector<BatchJob> & jobs,
+                    std::vector<BatchResult> & results, std::atomic<size_t> & nextJob);
+};
+
+END_NS(gemmini)
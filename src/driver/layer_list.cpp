@@ -0,0 +1,214 @@
+// layer_list.cpp - Implementation of network layer lists
+#include "driver/layer_list.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace gemmini {
+
+uint32_t Layer::OutH() const {
+    if (out_h > 0 || type == LayerType::Gemm) {
+        return out_h;
+    }
+    return (in_h + 2 * pad_h - kernel_h) / std::max(1u, stride_h) + 1;
+}
+
+uint32_t Layer::OutW() const {
+    if (out_w > 0 || type == LayerType::Gemm) {
+        return out_w;
+    }
+    return (in_w + 2 * pad_w - kernel_w) / std::max(1u, stride_w) + 1;
+}
+
+// im2col: one row per output pixel, one column per filter tap of a group
+uint32_t Layer::GemmM() const { return type == LayerType::Gemm ? m : batch * OutH() * OutW(); }
+
+uint32_t Layer::GemmK() const {
+    return type == LayerType::Gemm ? k : in_c / std::max(1u, groups) * kernel_h * kernel_w;
+}
+
+uint32_t Layer::GemmN() const {
+    return type == LayerType::Gemm ? n : out_c / std::max(1u, groups);
+}
+
+uint32_t Layer::GemmCount() const { return type == LayerType::Gemm ? 1 : std::max(1u, groups); }
+
+uint64_t Layer::Macs() const {
+    return uint64_t(GemmM()) * GemmK() * GemmN() * GemmCount();
+}
+
+const char* LayerTypeName(LayerType type) {
+    switch (type) {
+    case LayerType::Gemm:
+        return "gemm";
+    case LayerType::Conv:
+        return "conv";
+    case LayerType::DepthwiseConv:
+        return "dwconv";
+    }
+    return "unknown";
+}
+
+// Parse "AxBx..." into exactly count values
+static bool ParseDims(const std::string & text, uint32_t* values, size_t count) {
+    std::stringstream ss(text);
+    std::string part;
+    size_t i = 0;
+    while (std::getline(ss, part, 'x')) {
+        if (i == count || part.empty() ||
+            part.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        values[i++] = std::stoul(part);
+    }
+    return i == count;
+}
+
+std::vector<Layer> LayerList::Read(std::istream & is, const std::string & source) {
+    std::vector<Layer> layers;
+    std::string line;
+    uint32_t lineNo = 0;
+    while (std::getline(is, line)) {
+        ++lineNo;
+        line = line.substr(0, line.find('#'));
+        std::stringstream ss(line);
+        Layer layer;
+        std::string type;
+        if (!(ss >> layer.name)) {
+            continue;
+        }
+        auto fail = [&](const std::string & msg) {
+            throw std::runtime_error(source + ":" + std::to_string(lineNo) + ": " + msg);
+        };
+
+        if (!(ss >> type)) {
+            fail("missing layer type");
+        }
+        if (type == "gemm") {
+            layer.type = LayerType::Gemm;
+        } else if (type == "conv") {
+            layer.type = LayerType::Conv;
+        } else if (type == "dwconv") {
+            layer.type = LayerType::DepthwiseConv;
+        } else {
+            fail("unknown layer type '" + type + "'");
+        }
+
+        std::string token;
+        while (ss >> token) {
+            size_t eq = token.find('=');
+            if (eq == std::string::npos) {
+                fail("expected key=value, got '" + token + "'");
+            }
+            std::string key = token.substr(0, eq);
+            std::string value = token.substr(eq + 1);
+            uint32_t dims[4] = {0, 0, 0, 0};
+            bool ok = true;
+            if (key == "m" || key == "k" || key == "n" || key == "groups") {
+                ok = ParseDims(value, dims, 1);
+                uint32_t & target = key == "m"   ? layer.m
+                                    : key == "k" ? layer.k
+                                    : key == "n" ? layer.n
+                                                 : layer.groups;
+                target = dims[0];
+            } else if (key == "in") {
+                ok = ParseDims(value, dims, 4);
+                layer.batch = dims[0];
+                layer.in_c = dims[1];
+                layer.in_h = dims[2];
+                layer.in_w = dims[3];
+            } else if (key == "out") {
+                ok = ParseDims(value, dims, 3);
+                layer.out_c = dims[0];
+                layer.out_h = dims[1];
+                layer.out_w = dims[2];
+            } else if (key == "kernel" || key == "stride" || key == "pad") {
+                ok = ParseDims(value, dims, 2);
+                uint32_t* target = key == "kernel"   ? &layer.kernel_h
+                                   : key == "stride" ? &layer.stride_h
+                                                     : &layer.pad_h;
+                uint32_t* targetW = key == "kernel"   ? &layer.kernel_w
+                                    : key == "stride" ? &layer.stride_w
+                                                      : &layer.pad_w;
+                *target = dims[0];
+                *targetW = dims[1];
+            } else if (key == "precision") {
+                layer.precision = value;
+            } else if (key == "act") {
+                layer.activation = value;
+            } else if (key == "input") {
+                layer.input = value;
+            } else if (key == "residual") {
+                layer.residual = value;
+            } else if (key == "residual_then_act") {
+                layer.residual_then_act = value == "1";
+            } else if (key == "weights") {
+                layer.weights = value;
+            } else {
+                fail("unknown key '" + key + "'");
+            }
+            if (!ok) {
+                fail("bad value for " + key + ": '" + value + "'");
+            }
+        }
+
+        if (layer.type == LayerType::Gemm && (layer.m == 0 || layer.k == 0 || layer.n == 0)) {
+            fail("gemm layer needs m, k and n");
+        }
+        if (layer.type != LayerType::Gemm &&
+            (layer.in_c == 0 || layer.in_h == 0 || layer.in_w == 0 || layer.out_c == 0)) {
+            fail("convolution layer needs in and out");
+        }
+        layers.push_back(layer);
+    }
+    return layers;
+}
+
+void LayerList::Write(std::ostream & os, const std::vector<Layer> & layers) {
+    for (const auto & layer : layers) {
+        os << layer.name << " " << LayerTypeName(layer.type);
+        if (layer.type == LayerType::Gemm) {
+            os << " m=" << layer.m << " k=" << layer.k << " n=" << layer.n;
+        } else {
+            os << " in=" << layer.batch << "x" << layer.in_c << "x" << layer.in_h << "x"
+               << layer.in_w << " out=" << layer.out_c << "x" << layer.OutH() << "x"
+               << layer.OutW() << " kernel=" << layer.kernel_h << "x" << layer.kernel_w
+               << " stride=" << layer.stride_h << "x" << layer.stride_w << " pad=" << layer.pad_h
+               << "x" << layer.pad_w << " groups=" << layer.groups;
+        }
+        os << " precision=" << layer.precision << " act=" << layer.activation;
+        if (!layer.input.empty()) {
+            os << " input=" << layer.input;
+        }
+        if (!layer.residual.empty()) {
+            os << " residual=" << layer.residual;
+            if (layer.residual_then_act) {
+                os << " residual_then_act=1";
+            }
+        }
+        if (!layer.weights.empty()) {
+            os << " weights=" << layer.weights;
+        }
+        os << "\n";
+    }
+}
+
+std::vector<Layer> LayerList::LoadFromFile(const std::string & path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot open layer list: " + path);
+    }
+    return Read(file, path);
+}
+
+void LayerList::SaveToFile(const std::string & path, const std::vector<Layer> & layers) {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot create layer list: " + path);
+    }
+    Write(file, layers);
+}
+
+} // namespace gemmini
@@ -0,0 +1,86 @@
+// layer_list.hpp - Network layer lists for the Gemmini network runner
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// Kind of a layer, every kind runs on the array as one or more GEMMs
+enum class LayerType : uint8_t {
+    Gemm = 0,          // Fully connected / matrix multiply
+    Conv = 1,          // Convolution, lowered to a GEMM by im2col
+    DepthwiseConv = 2, // One filter per channel, lowered to one GEMM per channel
+};
+
+// One layer of a network
+struct Layer {
+    std::string name;
+    LayerType type = LayerType::Gemm;
+
+    // GEMM shape: (m x k) * (k x n)
+    uint32_t m = 0;
+    uint32_t k = 0;
+    uint32_t n = 0;
+
+    // Convolution shape (NCHW input, OIHW weights)
+    uint32_t batch = 1;
+    uint32_t in_c = 0;
+    uint32_t in_h = 0;
+    uint32_t in_w = 0;
+    uint32_t out_c = 0;
+    uint32_t out_h = 0; // 0 derives the size from kernel, stride and symmetric padding
+    uint32_t out_w = 0;
+    uint32_t kernel_h = 1;
+    uint32_t kernel_w = 1;
+    uint32_t stride_h = 1;
+    uint32_t stride_w = 1;
+    uint32_t pad_h = 0;
+    uint32_t pad_w = 0;
+    uint32_t groups = 1;
+
+    std::string precision = "int8";  // Weight and activation precision
+    std::string activation = "none"; // Fused activation: relu, relu6, sigmoid, ...
+    std::string input;               // Producing layer, empty for the previous layer
+    std::string residual;            // Layer whose output is added to this one's
+    bool residual_then_act = false;  // Residual is added before the activation
+    std::string weights;             // Tensor file holding the weights, if extracted
+
+    // Output spatial size of a convolution
+    uint32_t OutH() const;
+    uint32_t OutW() const;
+
+    // GEMM each group of the layer lowers to, and the number of groups
+    uint32_t GemmM() const;
+    uint32_t GemmK() const;
+    uint32_t GemmN() const;
+    uint32_t GemmCount() const;
+
+    // Multiply-accumulates of the whole layer
+    uint64_t Macs() const;
+};
+
+const char* LayerTypeName(LayerType type);
+
+// LayerList - text form of a network, one layer per line:
+//
+//   name gemm m=M k=K n=N [common keys]
+//   name conv|dwconv in=NxCxHxW out=CxHxW kernel=KHxKW stride=SHxSW pad=PHxPW groups=G
+//        [common keys]
+//
+// Common keys are precision, act, input, residual, residual_then_act and weights. Blank
+// lines and text after '#' are ignored.
+class LayerList {
+public:
+    static std::vector<Layer> Read(std::istream & is, const std::string & source = "input");
+    static void Write(std::ostream & os, const std::vector<Layer> & layers);
+
+    static std::vector<Layer> LoadFromFile(const std::string & path);
+    static void SaveToFile(const std::string & path, const std::vector<Layer> & layers);
+};
+
+END_NS(gemmini)
@@ -0,0 +1,441 @@
+// network_runner.cpp - Implementation of the multi-instance network runner
+#include "driver/network_runner.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "execute/tile_schedule.hpp"
+
+namespace gemmini {
+
+const char* NetworkModeName(NetworkMode mode) {
+    return mode == NetworkMode::Pipeline ? "pipeline" : "data_parallel";
+}
+
+bool ParseNetworkMode(const std::string & name, NetworkMode & mode) {
+    if (name == "pipeline") {
+        mode = NetworkMode::Pipeline;
+    } else if (name == "data" || name == "data_parallel") {
+        mode = NetworkMode::DataParallel;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+double NetworkReport::Throughput() const {
+    return makespan_cycles == 0 ? 0.0 : samples * 1e6 / makespan_cycles;
+}
+
+std::ostream & operator<<(std::ostream & os, const NetworkReport & report) {
+    os << NetworkModeName(report.mode) << ": " << report.samples << " sample(s) on "
+       << report.instances << " instance(s)" << std::endl;
+    os << "  makespan cycles:      " << report.makespan_cycles << std::endl;
+    os << "  throughput:           " << std::fixed << std::setprecision(2)
+       << report.Throughput() << " samples/Mcycle" << std::endl;
+    os << "  first sample latency: " << report.first_latency_cycles << std::endl;
+    os << "  average latency:      " << std::fixed << std::setprecision(1)
+       << report.avg_latency_cycles << std::endl;
+    if (report.mode == NetworkMode::Pipeline) {
+        os << "  buffer stall cycles:  " << report.stall_cycles << " ("
+           << report.buffer_slots << " activation(s) per shared buffer)" << std::endl;
+    }
+    for (size_t s = 0; s < report.stages.size(); ++s) {
+        const NetworkStage & stage = report.stages[s];
+        double utilization = report.makespan_cycles == 0
+                                 ? 0.0
+                                 : 100.0 * stage.busy_cycles / report.makespan_cycles;
+        os << "  instance " << s << ": layers " << stage.first_layer << "-"
+           << stage.first_layer + stage.num_layers - 1 << " compute=" << stage.compute_cycles
+           << " transfer=" << stage.transfer_cycles << " utilization=" << std::fixed
+           << std::setprecision(1) << utilization << "%" << std::endl;
+    }
+    if (!report.topology.empty()) {
+        // The busiest links show where traffic contends
+        std::vector<LinkStats> links = report.links;
+        std::sort(links.begin(), links.end(), [](const LinkStats & a, const LinkStats & b) {
+            return a.busy_cycles > b.busy_cycles;
+        });
+        links.resize(std::min<size_t>(links.size(), 4));
+        os << "  interconnect: " << report.topology << ", " << report.links.size()
+           << " link(s), busiest:" << std::endl;
+        for (const LinkStats & link : links) {
+            double utilization = report.makespan_cycles == 0
+                                     ? 0.0
+                                     : 100.0 * link.busy_cycles / report.makespan_cycles;
+            os << "    " << link.name << " bytes=" << link.bytes << " utilization=" << std::fixed
+               << std::setprecision(1) << std::min(100.0, utilization) << "%" << std::endl;
+        }
+    }
+    return os;
+}
+
+uint64_t NetworkRunner::GemmCycles(uint32_t m, uint32_t k, uint32_t n) {
+    auto key = std::make_tuple(m, k, n);
+    auto it = mGemmCycles.find(key);
+    if (it != mGemmCycles.end()) {
+        return it->second;
+    }
+    uint32_t kTile = mConfig.tile_rows * mConfig.memory.weights_per_pe;
+    TileSchedulePtr schedule =
+        TileSchedule::Plan(m, k, n, mConfig.tile_rows, mConfig.tile_cols, kTile);
+    ScheduleChecker checker(mConfig.memory, mConfig.host);
+    uint64_t cycles = checker.Check(*schedule).estimated_cycles;
+    mGemmCycles[key] = cycles;
+    return cycles;
+}
+
+uint64_t NetworkRunner::ReadCycles(uint64_t bytes) const {
+    uint64_t bandwidth = std::max(1u, mConfig.memory.dma_bytes_per_cycle);
+    return (bytes + bandwidth - 1) / bandwidth;
+}
+
+uint64_t NetworkRunner::LayerCycles(const Layer & layer) {
+    if (layer.GemmM() == 0 || layer.GemmK() == 0 || layer.GemmN() == 0) {
+        return 0;
+    }
+    return GemmCycles(layer.GemmM(), layer.GemmK(), layer.GemmN()) * layer.GemmCount();
+}
+
+uint64_t NetworkRunner::InputBytes(const Layer & layer) const {
+    // Inputs are stored as vectors along the reduction dimension (channels for a conv)
+    if (layer.type != LayerType::Gemm) {
+        return uint64_t(layer.batch) * layer.in_h * layer.in_w *
+               mConfig.memory.ActivationBytes(layer.in_c);
+    }
+    return uint64_t(layer.GemmM()) * layer.GemmCount() *
+           mConfig.memory.ActivationBytes(layer.GemmK());
+}
+
+uint64_t NetworkRunner::OutputBytes(const Layer & layer) const {
+    return uint64_t(layer.GemmM()) * layer.GemmN() * layer.GemmCount() *
+           mConfig.memory.element_bytes;
+}
+
+uint64_t NetworkRunner::WeightBytes(const Layer & layer) const {
+    return uint64_t(layer.GemmN()) * layer.GemmCount() *
+           mConfig.memory.WeightBytes(layer.GemmK());
+}
+
+std::vector<std::vector<uint32_t>> NetworkRunner::Producers(const std::vector<Layer> & layers) {
+    std::unordered_map<std::string, uint32_t> index;
+    std::vector<std::vector<uint32_t>> producers(layers.size());
+    for (uint32_t i = 0; i < layers.size(); ++i) {
+        const Layer & layer = layers[i];
+        if (layer.input.empty()) {
+            if (i > 0) {
+                producers[i].push_back(i - 1);
+            }
+        } else if (index.count(layer.input)) {
+            producers[i].push_back(index[layer.input]);
+        }
+        if (!layer.residual.empty() && index.count(layer.residual)) {
+            producers[i].push_back(index[layer.residual]);
+        }
+        index[layer.name] = i;
+    }
+    return producers;
+}
+
+uint64_t NetworkRunner::TransferCycles(const std::vector<Layer> & layers,
+                                       const std::vector<std::vector<uint32_t>> & producers,
+                                       uint32_t first, uint32_t end) const {
+    // Each activation produced before the stage is read once, however many layers use it
+    std::set<uint32_t> inputs;
+    for (uint32_t i = first; i < end; ++i) {
+        for (uint32_t p : producers[i]) {
+            if (p < first) {
+                inputs.insert(p);
+            }
+        }
+    }
+    uint64_t bytes = 0;
+    for (uint32_t p : inputs) {
+        bytes += OutputBytes(layers[p]);
+    }
+    uint64_t bandwidth = std::max(1u, mConfig.buffer_bytes_per_cycle);
+    return (bytes + bandwidth - 1) / bandwidth;
+}
+
+std::vector<uint32_t> NetworkRunner::Balance(const std::vector<Layer> & layers,
+                                             uint32_t stages) {
+    const uint32_t count = static_cast<uint32_t>(layers.size());
+    stages = std::max(1u, std::min(stages, count));
+    std::vector<std::vector<uint32_t>> producers = Producers(layers);
+
+    // prefix[i] = compute cycles of layers [0, i)
+    std::vector<uint64_t> prefix(count + 1, 0);
+    for (uint32_t i = 0; i < count; ++i) {
+        prefix[i + 1] = prefix[i] + LayerCycles(layers[i]);
+    }
+    auto cost = [&](uint32_t first, uint32_t end) {
+        return prefix[end] - prefix[first] + TransferCycles(layers, producers, first, end);
+    };
+
+    // best[s][j]: slowest stage when layers [0, j) form s + 1 stages; from[s][j]: start of
+    // the last of them
+    const uint64_t kInf = std::numeric_limits<uint64_t>::max();
+    std::vector<std::vector<uint64_t>> best(stages, std::vector<uint64_t>(count + 1, kInf));
+    std::vector<std::vector<uint32_t>> from(stages, std::vector<uint32_t>(count + 1, 0));
+    for (uint32_t j = 1; j <= count; ++j) {
+        best[0][j] = cost(0, j);
+    }
+    for (uint32_t s = 1; s < stages; ++s) {
+        for (uint32_t j = s + 1; j <= count; ++j) {
+            for (uint32_t i = s; i < j; ++i) {
+                if (best[s - 1][i] == kInf) {
+                    continue;
+                }
+                uint64_t slowest = std::max(best[s - 1][i], cost(i, j));
+                if (slowest < best[s][j]) {
+                    best[s][j] = slowest;
+                    from[s][j] = i;
+                }
+            }
+        }
+    }
+
+    std::vector<uint32_t> firsts(stages, 0);
+    uint32_t end = count;
+    for (uint32_t s = stages - 1; s > 0; --s) {
+        firsts[s] = from[s][end];
+        end = firsts[s];
+    }
+    return firsts;
+}
+
+std::unique_ptr<Interconnect> NetworkRunner::MakeInterconnect(uint32_t instances) const {
+    if (!mConfig.model_interconnect) {
+        return nullptr;
+    }
+    return std::make_unique<Interconnect>(mConfig.interconnect,
+                                          instances + std::max(1u, mConfig.memory_controllers));
+}
+
+void NetworkRunner::ReportLinks(const Interconnect * noc, NetworkReport & report) const {
+    if (noc == nullptr) {
+        return;
+    }
+    report.topology = TopologyName(mConfig.interconnect.topology);
+    for (const LinkStats & link : noc->Links()) {
+        if (!link.name.empty()) {
+            report.links.push_back(link);
+        }
+    }
+}
+
+NetworkReport NetworkRunner::Run(const std::vector<Layer> & layers, NetworkMode mode) {
+    if (layers.empty()) {
+        throw std::runtime_error("Network has no layers");
+    }
+    return mode == NetworkMode::Pipeline ? RunPipeline(layers) : RunDataParallel(layers);
+}
+
+NetworkReport NetworkRunner::RunPipeline(const std::vector<Layer> & layers) {
+    NetworkReport report;
+    report.mode = NetworkMode::Pipeline;
+    report.samples = std::max(1u, mConfig.samples);
+
+    std::vector<uint32_t> firsts = Balance(layers, std::max(1u, mConfig.instances));
+    std::vector<std::vector<uint32_t>> producers = Producers(layers);
+    const uint32_t numStages = static_cast<uint32_t>(firsts.size());
+    report.instances = numStages;
+    std::unique_ptr<Interconnect> noc = MakeInterconnect(numStages);
+    const uint32_t controllers = std::max(1u, mConfig.memory_controllers);
+
+    // Stage costs and how many activations fit the shared buffer after each stage
+    std::vector<uint64_t> slots(numStages, 0);
+    std::vector<uint32_t> stageOf(layers.size(), 0);
+    std::vector<uint64_t> weightBytes(numStages, 0);
+    report.buffer_slots = std::numeric_limits<uint64_t>::max();
+    for (uint32_t s = 0; s < numStages; ++s) {
+        uint32_t end = s + 1 < numStages ? firsts[s + 1] : layers.size();
+        NetworkStage stage;
+        stage.first_layer = firsts[s];
+        stage.num_layers = end - firsts[s];
+        for (uint32_t i = firsts[s]; i < end; ++i) {
+            stage.compute_cycles += LayerCycles(layers[i]);
+            weightBytes[s] += WeightBytes(layers[i]);
+            stageOf[i] = s;
+        }
+        stage.transfer_cycles = TransferCycles(layers, producers, firsts[s], end);
+        if (s == 0) {
+            stage.transfer_cycles += ReadCycles(InputBytes(layers[0]));
+        }
+        report.stages.push_back(stage);
+
+        if (s + 1 < numStages) {
+            uint32_t nextEnd = s + 2 < numStages ? firsts[s + 2] : layers.size();
+            uint64_t bytes = TransferCycles(layers, producers, end, nextEnd) *
+                             std::max(1u, mConfig.buffer_bytes_per_cycle);
+            slots[s] = std::max<uint64_t>(1, mConfig.buffer_bytes / std::max<uint64_t>(1, bytes));
+            report.buffer_slots = std::min(report.buffer_slots, slots[s]);
+        }
+    }
+    if (numStages == 1) {
+        report.buffer_slots = 0;
+    }
+
+    // Activations each stage pulls over the interconnect, by producing stage (numStages for
+    // the network input in memory)
+    std::vector<std::map<uint32_t, uint64_t>> pulls(numStages);
+    if (noc) {
+        pulls[0][numStages] = InputBytes(layers[0]);
+        for (uint32_t s = 1; s < numStages; ++s) {
+            std::set<uint32_t> inputs;
+            uint32_t end = s + 1 < numStages ? firsts[s + 1] : layers.size();
+            for (uint32_t i = firsts[s]; i < end; ++i) {
+                for (uint32_t p : producers[i]) {
+                    if (p < firsts[s]) {
+                        inputs.insert(p);
+                    }
+                }
+            }
+            for (uint32_t p : inputs) {
+                pulls[s][stageOf[p]] += OutputBytes(layers[p]);
+            }
+        }
+    }
+
+    // Samples enter together and flow through the stages in order. A stage starts a sample
+    // when it is free and its input is in the shared buffer, and hands the result over only
+    // once the next stage has taken the sample that many slots earlier. Stage steps are taken
+    // in start order so interconnect transfers are booked roughly in time order.
+    const uint32_t samples = report.samples;
+    std::vector<std::vector<uint64_t>> start(numStages, std::vector<uint64_t>(samples, 0));
+    std::vector<std::vector<uint64_t>> done(numStages, std::vector<uint64_t>(samples, 0));
+    std::vector<uint64_t> out(samples, 0);
+    std::vector<uint64_t> waited(numStages, 0);
+    std::vector<uint32_t> next(numStages, 0);
+    auto memoryNode = [&](uint32_t s) { return numStages + s % controllers; };
+    for (uint64_t step = 0; step < uint64_t(samples) * numStages; ++step) {
+        uint32_t s = numStages;
+        uint64_t earliest = std::numeric_limits<uint64_t>::max();
+        for (uint32_t c = 0; c < numStages; ++c) {
+            uint32_t i = next[c];
+            bool inputDone = c == 0 || next[c - 1] > i;
+            bool slotKnown = c + 1 == numStages || i < slots[c] || next[c + 1] > i - slots[c];
+            if (i >= samples || !inputDone || !slotKnown) {
+                continue;
+            }
+            uint64_t when = std::max(c > 0 ? done[c - 1][i] : 0, i > 0 ? done[c][i - 1] : 0);
+            if (when <= earliest) {
+                earliest = when;
+                s = c;
+            }
+        }
+        if (s == numStages) {
+            throw std::runtime_error("Pipeline has no stage ready to run");
+        }
+
+        const uint32_t i = next[s]++;
+        NetworkStage & stage = report.stages[s];
+        uint64_t free = i > 0 ? done[s][i - 1] : 0;
+        start[s][i] = earliest;
+        uint64_t ready = earliest;
+        bool loadWeights = i == 0 || weightBytes[s] > mConfig.memory.scratchpad_bytes;
+        if (noc) {
+            if (loadWeights) {
+                ready = std::max(ready, noc->Send(free, memoryNode(s), s, weightBytes[s]));
+            }
+            for (const auto & pull : pulls[s]) {
+                uint32_t from = pull.first == numStages ? memoryNode(s) : pull.first;
+                ready = std::max(ready, noc->Send(earliest, from, s, pull.second));
+            }
+        } else {
+            ready += stage.transfer_cycles + (loadWeights ? ReadCycles(weightBytes[s]) : 0);
+        }
+        waited[s] += ready - earliest;
+        uint64_t finish = ready + stage.compute_cycles;
+        stage.busy_cycles += finish - earliest;
+        done[s][i] = finish;
+        if (s + 1 < numStages && i >= slots[s]) {
+            // start[s + 1] of an earlier sample is already known
+            done[s][i] = std::max(finish, start[s + 1][i - slots[s]]);
+            report.stall_cycles += done[s][i] - finish;
+        }
+        if (s + 1 == numStages) {
+            out[i] = noc ? noc->Send(finish, s, memoryNode(s), OutputBytes(layers.back()))
+                         : finish;
+        }
+    }
+
+    double latencySum = 0.0;
+    for (uint32_t i = 0; i < samples; ++i) {
+        latencySum += out[i];
+        report.makespan_cycles = std::max(report.makespan_cycles, out[i]);
+    }
+    report.first_latency_cycles = out[0];
+    report.avg_latency_cycles = latencySum / samples;
+    for (uint32_t s = 0; s < numStages; ++s) {
+        report.stages[s].transfer_cycles = waited[s] / samples;
+    }
+    ReportLinks(noc.get(), report);
+    return report;
+}
+
+NetworkReport NetworkRunner::RunDataParallel(const std::vector<Layer> & layers) {
+    NetworkReport report;
+    report.mode = NetworkMode::DataParallel;
+    report.samples = std::max(1u, mConfig.samples);
+    report.instances = std::max(1u, std::min(mConfig.instances, report.samples));
+    std::unique_ptr<Interconnect> noc = MakeInterconnect(report.instances);
+    const uint32_t controllers = std::max(1u, mConfig.memory_controllers);
+
+    uint64_t network = 0;
+    uint64_t weights = 0;
+    for (const auto & layer : layers) {
+        network += LayerCycles(layer);
+        weights += WeightBytes(layer);
+    }
+    report.stages.assign(report.instances, NetworkStage());
+    for (NetworkStage & stage : report.stages) {
+        stage.num_layers = static_cast<uint32_t>(layers.size());
+        stage.compute_cycles = network;
+    }
+
+    // Samples are dealt round-robin; each instance runs its share back to back. Instances
+    // take their j-th samples together, so interconnect transfers are booked in time order.
+    std::vector<uint64_t> free(report.instances, 0);
+    std::vector<uint64_t> waited(report.instances, 0);
+    std::vector<uint32_t> share(report.instances, 0);
+    double latencySum = 0.0;
+    for (uint32_t i = 0; i < report.samples; ++i) {
+        const uint32_t inst = i % report.instances;
+        const uint32_t node = report.instances + inst % controllers;
+        uint64_t ready = free[inst];
+        bool loadWeights = share[inst] == 0 || weights > mConfig.memory.scratchpad_bytes;
+        if (noc) {
+            if (loadWeights) {
+                ready = std::max(ready, noc->Send(free[inst], node, inst, weights));
+            }
+            ready = std::max(ready, noc->Send(free[inst], node, inst, InputBytes(layers[0])));
+        } else {
+            ready += (loadWeights ? ReadCycles(weights) : 0) + ReadCycles(InputBytes(layers[0]));
+        }
+        waited[inst] += ready - free[inst];
+        uint64_t finish = ready + network;
+        uint64_t out = noc ? noc->Send(finish, inst, node, OutputBytes(layers.back())) : finish;
+        report.stages[inst].busy_cycles += finish - free[inst];
+        free[inst] = finish;
+        ++share[inst];
+
+        latencySum += out;
+        if (i == 0) {
+            report.first_latency_cycles = out;
+        }
+        report.makespan_cycles = std::max(report.makespan_cycles, out);
+    }
+    report.avg_latency_cycles = latencySum / report.samples;
+    for (uint32_t inst = 0; inst < report.instances; ++inst) {
+        report.stages[inst].transfer_cycles = waited[inst] / std::max(1u, share[inst]);
+    }
+    ReportLinks(noc.get(), report);
+    return report;
+}
+
+} // namespace gemmini
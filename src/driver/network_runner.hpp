@@ -0,0 +1,141 @@
+// network_runner.hpp - Runs layer lists on several accelerator instances
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "gemmini/common.hpp"
+#include "driver/layer_list.hpp"
+#include "execute/interconnect.hpp"
+#include "execute/schedule_checker.hpp"
+
+BEGIN_NS(gemmini)
+
+// How a batch of samples is spread over the accelerator instances
+enum class NetworkMode : uint8_t {
+    Pipeline = 0,     // Consecutive layers on different instances, samples stream through
+    DataParallel = 1, // Every instance runs the whole network on its share of the samples
+};
+
+const char* NetworkModeName(NetworkMode mode);
+bool ParseNetworkMode(const std::string & name, NetworkMode & mode);
+
+// Network runner configuration
+struct NetworkConfig {
+    uint32_t instances = 1;            // Accelerator instances
+    uint32_t samples = 1;              // Samples in the served batch
+    uint32_t tile_rows = 4;            // Systolic array of every instance
+    uint32_t tile_cols = 4;
+    MemoryConfig memory;               // Scratchpad, accumulator and DMA of every instance
+    HostConfig host;                   // Host command issue and fence cost of every GEMM
+    uint64_t buffer_bytes = 1 << 20;   // Shared activation buffer between two stages
+    uint32_t buffer_bytes_per_cycle = 32; // Bandwidth into and out of the shared buffer
+    bool model_interconnect = false;   // Move weights and activations over the interconnect
+    InterconnectConfig interconnect;   // On-chip network between instances and memory
+    uint32_t memory_controllers = 1;   // Interconnect nodes after the instances
+};
+
+// One pipeline stage: a contiguous range of layers on one instance
+struct NetworkStage {
+    uint32_t first_layer = 0;
+    uint32_t num_layers = 0;
+    uint64_t compute_cycles = 0;   // Cycles of the stage's layers for one sample
+    uint64_t transfer_cycles = 0;  // Average cycles per sample to read its inputs and
+                                   // weights, or that it waited on the interconnect
+    uint64_t busy_cycles = 0;      // Cycles the instance worked over the whole batch
+};
+
+// Outcome of serving a batch
+struct NetworkReport {
+    NetworkMode mode = NetworkMode::Pipeline;
+    uint32_t instances = 0;
+    uint32_t samples = 0;
+    std::vector<NetworkStage> stages;  // One per instance in use (pipeline mode)
+    uint64_t makespan_cycles = 0;      // First sample in to last sample out
+    uint64_t first_latency_cycles = 0; // Latency of the first sample
+    double avg_latency_cycles = 0.0;   // Average latency of all samples
+    uint64_t stall_cycles = 0;         // Cycles stages waited on a full shared buffer
+    uint64_t buffer_slots = 0;         // Activations a shared buffer holds at once
+    std::string topology;              // Interconnect topology, empty when not modeled
+    std::vector<LinkStats> links;      // Traffic of every interconnect link
+
+    // Samples per million cycles
+    double Throughput() const;
+};
+
+std::ostream & operator<<(std::ostream & os, const NetworkReport & report);
+
+// NetworkRunner - estimates serving a batch of samples through a layer list on several
+// accelerator instances. Layer costs come from the static checker's timeline for the
+// planned tile schedule of each layer's GEMMs, so whole networks are evaluated without
+// simulating every tile. The timeline walks every K block of every output tile, so layer
+// costs (and the stage balance built on them) grow with K.
+//
+// Pipeline mode splits the layers into one contiguous stage per instance, balanced so the
+// slowest stage is as fast as possible, and streams samples through them. A stage writes
+// its outputs to a shared buffer that holds a limited number of activations; the next
+// stage reads them from there, and a full buffer stalls the producer. Data-parallel mode
+// gives every instance the whole network and an equal share of the samples.
+//
+// Without the interconnect, every instance reads weights and the network input from memory
+// over its own DMA: weights once when they fit the scratchpad, otherwise for every sample.
+// A pipeline stage reads only its own layers' weights, while a data-parallel instance reads
+// all of them.
+//
+// With model_interconnect set, the instances and memory controllers are nodes of an
+// interconnect. A stage fetches its weights from its memory controller (once when they fit
+// the scratchpad, otherwise for every sample) and pulls its input activations from the
+// instances that produced them, or from memory for the network input; the last stage writes
+// its outputs back to memory. Transfers share the links, so contention shows up as waiting
+// before compute and as link utilization.
+class NetworkRunner {
+public:
+    explicit NetworkRunner(const NetworkConfig & config) : mConfig(config) {}
+
+    NetworkReport Run(const std::vector<Layer> & layers, NetworkMode mode);
+
+    // Cycles of one layer for one sample on one instance
+    uint64_t LayerCycles(const Layer & layer);
+
+    // Bytes of a layer's input activations, output activations and weights
+    uint64_t InputBytes(const Layer & layer) const;
+    uint64_t OutputBytes(const Layer & layer) const;
+    uint64_t WeightBytes(const Layer & layer) const;
+
+    // Split layers into at most stages contiguous stages minimizing the slowest stage;
+    // returns the first layer of each stage
+    std::vector<uint32_t> Balance(const std::vector<Layer> & layers, uint32_t stages);
+
+private:
+    const NetworkConfig mConfig;
+
+    // Checker estimates by GEMM shape
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t>, uint64_t> mGemmCycles;
+
+    uint64_t GemmCycles(uint32_t m, uint32_t k, uint32_t n);
+
+    // Cycles for an instance's DMA to read bytes from memory
+    uint64_t ReadCycles(uint64_t bytes) const;
+
+    // Layers whose outputs each layer reads (its input and residual)
+    static std::vector<std::vector<uint32_t>> Producers(const std::vector<Layer> & layers);
+
+    // Cycles to read the activations a stage of layers [first, end) takes from earlier stages
+    uint64_t TransferCycles(const std::vector<Layer> & layers,
+                            const std::vector<std::vector<uint32_t>> & producers, uint32_t first,
+                            uint32_t end) const;
+
+    // Interconnect for the given instances plus the memory controllers, null when not modeled
+    std::unique_ptr<Interconnect> MakeInterconnect(uint32_t instances) const;
+    void ReportLinks(const Interconnect * noc, NetworkReport & report) const;
+
+    NetworkReport RunPipeline(const std::vector<Layer> & layers);
+    NetworkReport RunDataParallel(const std::vector<Layer> & layers);
+};
+
+END_NS(gemmini)
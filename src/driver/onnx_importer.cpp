@@ -0,0 +1,679 @@
+// onnx_importer.cpp - Implementation of the ONNX model importer
+#include "driver/onnx_importer.hpp"
+#include "driver/proto_reader.hpp"
+#include "driver/tensor_file.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace gemmini {
+
+// Field numbers from onnx.proto
+namespace onnx {
+constexpr uint32_t kModelGraph = 7;
+constexpr uint32_t kGraphNode = 1;
+constexpr uint32_t kGraphInitializer = 5;
+constexpr uint32_t kGraphInput = 11;
+constexpr uint32_t kNodeInput = 1;
+constexpr uint32_t kNodeOutput = 2;
+constexpr uint32_t kNodeName = 3;
+constexpr uint32_t kNodeOpType = 4;
+constexpr uint32_t kNodeAttribute = 5;
+constexpr uint32_t kAttrName = 1;
+constexpr uint32_t kAttrFloat = 2;
+constexpr uint32_t kAttrInt = 3;
+constexpr uint32_t kAttrString = 4;
+constexpr uint32_t kAttrTensor = 5;
+constexpr uint32_t kAttrInts = 8;
+constexpr uint32_t kTensorDims = 1;
+constexpr uint32_t kTensorDataType = 2;
+constexpr uint32_t kTensorFloatData = 4;
+constexpr uint32_t kTensorInt32Data = 5;
+constexpr uint32_t kTensorInt64Data = 7;
+constexpr uint32_t kTensorName = 8;
+constexpr uint32_t kTensorRawData = 9;
+constexpr uint32_t kValueName = 1;
+constexpr uint32_t kValueType = 2;
+constexpr uint32_t kTypeTensor = 1;
+constexpr uint32_t kTensorTypeShape = 2;
+constexpr uint32_t kShapeDim = 1;
+constexpr uint32_t kDimValue = 1;
+} // namespace onnx
+
+int64_t OnnxImporter::Node::Int(const std::string & key, int64_t fallback) const {
+    auto it = ints.find(key);
+    return it == ints.end() ? fallback : it->second;
+}
+
+std::vector<int64_t> OnnxImporter::Node::List(const std::string & key, size_t size,
+                                              int64_t fallback) const {
+    auto it = lists.find(key);
+    if (it == lists.end() || it->second.size() != size) {
+        return std::vector<int64_t>(size, fallback);
+    }
+    return it->second;
+}
+
+// Read a TensorProto, converting the typed repeated fields to raw bytes
+static std::string ParseTensor(ProtoReader reader, uint32_t & type, std::vector<int64_t> & dims,
+                               std::string & data) {
+    std::string name;
+    std::vector<float> floats;
+    std::vector<int64_t> ints;
+    bool wide = false;
+    while (reader.Next()) {
+        switch (reader.Field()) {
+        case onnx::kTensorDims:
+            reader.AppendInts(dims);
+            break;
+        case onnx::kTensorDataType:
+            type = static_cast<uint32_t>(reader.UInt());
+            break;
+        case onnx::kTensorFloatData:
+            reader.AppendFloats(floats);
+            break;
+        case onnx::kTensorInt32Data:
+            reader.AppendInts(ints);
+            break;
+        case onnx::kTensorInt64Data:
+            reader.AppendInts(ints);
+            wide = true;
+            break;
+        case onnx::kTensorName:
+            name = reader.String();
+            break;
+        case onnx::kTensorRawData:
+            data = reader.String();
+            break;
+        }
+    }
+
+    if (data.empty() && !floats.empty()) {
+        data.assign(reinterpret_cast<const char*>(floats.data()), floats.size() * sizeof(float));
+    } else if (data.empty() && !ints.empty()) {
+        // int32_data holds one element of any narrow type per entry
+        size_t bytes = wide ? 8 : std::max<size_t>(1, TensorTypeBytes(type));
+        for (int64_t value : ints) {
+            for (size_t i = 0; i < bytes; ++i) {
+                data.push_back(static_cast<char>(uint64_t(value) >> (8 * i)));
+            }
+        }
+    }
+    return name;
+}
+
+// Integer contents of an int32 or int64 tensor
+static std::vector<int64_t> TensorInts(uint32_t type, const std::string & data) {
+    size_t bytes = type == static_cast<uint32_t>(TensorType::Int64) ? 8 : 4;
+    std::vector<int64_t> values;
+    for (size_t pos = 0; pos + bytes <= data.size(); pos += bytes) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            value |= uint64_t(uint8_t(data[pos + i])) << (8 * i);
+        }
+        if (bytes == 4) {
+            value = uint64_t(int64_t(int32_t(value)));
+        }
+        values.push_back(static_cast<int64_t>(value));
+    }
+    return values;
+}
+
+// Names become whitespace-free so they survive the layer list format and file names
+static std::string SanitizeName(const std::string & name) {
+    std::string result = name;
+    for (char & c : result) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-' && c != '.') {
+            c = '_';
+        }
+    }
+    return result;
+}
+
+std::vector<Layer> OnnxImporter::Import(const std::string & path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open ONNX model: " + path);
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return ImportBytes(buffer.str());
+}
+
+std::vector<Layer> OnnxImporter::ImportBytes(const std::string & bytes) {
+    mWarnings.clear();
+    mLayers.clear();
+    mValues.clear();
+    mInitializers.clear();
+    mConsumers.clear();
+
+    ProtoReader model(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+    bool found = false;
+    while (model.Next()) {
+        if (model.Field() == onnx::kModelGraph && model.Type() == ProtoReader::LengthDelimited) {
+            ParseGraph(model.Data(), model.Size());
+            found = true;
+        }
+    }
+    if (!found) {
+        throw std::runtime_error("ONNX model has no graph");
+    }
+    return mLayers;
+}
+
+void OnnxImporter::ParseGraph(const uint8_t* data, size_t size) {
+    std::vector<Node> nodes;
+    std::vector<std::pair<std::string, Value>> inputs;
+
+    ProtoReader graph(data, size);
+    while (graph.Next()) {
+        if (graph.Field() == onnx::kGraphNode) {
+            Node node;
+            ProtoReader reader = graph.Message();
+            while (reader.Next()) {
+                switch (reader.Field()) {
+                case onnx::kNodeInput:
+                    node.inputs.push_back(reader.String());
+                    break;
+                case onnx::kNodeOutput:
+                    node.outputs.push_back(reader.String());
+                    break;
+                case onnx::kNodeName:
+                    node.name = reader.String();
+                    break;
+                case onnx::kNodeOpType:
+                    node.op = reader.String();
+                    break;
+                case onnx::kNodeAttribute: {
+                    std::string name;
+                    int kind = -1;
+                    int64_t i = 0;
+                    float f = 0.0f;
+                    std::string s;
+                    std::vector<int64_t> list;
+                    Tensor tensor;
+                    ProtoReader attr = reader.Message();
+                    while (attr.Next()) {
+                        switch (attr.Field()) {
+                        case onnx::kAttrName:
+                            name = attr.String();
+                            break;
+                        case onnx::kAttrFloat:
+                            f = attr.Float();
+                            kind = onnx::kAttrFloat;
+                            break;
+                        case onnx::kAttrInt:
+                            i = attr.Int();
+                            kind = onnx::kAttrInt;
+                            break;
+                        case onnx::kAttrString:
+                            s = attr.String();
+                            kind = onnx::kAttrString;
+                            break;
+                        case onnx::kAttrTensor:
+                            ParseTensor(attr.Message(), tensor.type, tensor.dims, tensor.data);
+                            kind = onnx::kAttrTensor;
+                            break;
+                        case onnx::kAttrInts:
+                            attr.AppendInts(list);
+                            kind = onnx::kAttrInts;
+                            break;
+                        }
+                    }
+                    if (kind == onnx::kAttrFloat) {
+                        node.floats[name] = f;
+                    } else if (kind == onnx::kAttrInt) {
+                        node.ints[name] = i;
+                    } else if (kind == onnx::kAttrString) {
+                        node.strings[name] = s;
+                    } else if (kind == onnx::kAttrTensor) {
+                        node.tensors[name] = tensor;
+                    } else if (kind == onnx::kAttrInts) {
+                        node.lists[name] = list;
+                    }
+                    break;
+                }
+                }
+            }
+            nodes.push_back(node);
+        } else if (graph.Field() == onnx::kGraphInitializer) {
+            Tensor tensor;
+            std::string name = ParseTensor(graph.Message(), tensor.type, tensor.dims, tensor.data);
+            mInitializers[name] = tensor;
+        } else if (graph.Field() == onnx::kGraphInput) {
+            // ValueInfoProto -> TypeProto -> Tensor -> TensorShapeProto -> Dimension
+            std::string name;
+            Value value;
+            ProtoReader info = graph.Message();
+            while (info.Next()) {
+                if (info.Field() == onnx::kValueName) {
+                    name = info.String();
+                } else if (info.Field() == onnx::kValueType) {
+                    ProtoReader type = info.Message();
+                    while (type.Next()) {
+                        if (type.Field() != onnx::kTypeTensor) {
+                            continue;
+                        }
+                        ProtoReader tensor = type.Message();
+                        while (tensor.Next()) {
+                            if (tensor.Field() != onnx::kTensorTypeShape) {
+                                continue;
+                            }
+                            ProtoReader shape = tensor.Message();
+                            while (shape.Next()) {
+                                if (shape.Field() != onnx::kShapeDim) {
+                                    continue;
+                                }
+                                // Symbolic dims are the batch if leading, otherwise 1
+                                int64_t dim = value.shape.empty() ? mOptions.batch : 1;
+                                ProtoReader dimension = shape.Message();
+                                while (dimension.Next()) {
+                                    if (dimension.Field() == onnx::kDimValue) {
+                                        dim = dimension.Int();
+                                    }
+                                }
+                                value.shape.push_back(dim);
+                            }
+                        }
+                    }
+                }
+            }
+            inputs.emplace_back(name, value);
+        }
+    }
+
+    // Older exporters list initializers as graph inputs too
+    for (const auto & input : inputs) {
+        if (!mInitializers.count(input.first)) {
+            mValues[input.first] = input.second;
+        }
+    }
+    for (const auto & node : nodes) {
+        for (const auto & input : node.inputs) {
+            ++mConsumers[input];
+        }
+    }
+    for (const auto & node : nodes) {
+        if (!node.outputs.empty()) {
+            ImportNode(node);
+        }
+    }
+}
+
+void OnnxImporter::ImportNode(const Node & node) {
+    const std::string & op = node.op;
+    if (op == "Conv" || op == "ConvInteger" || op == "QLinearConv") {
+        AddConv(node);
+    } else if (op == "Gemm" || op == "MatMul" || op == "MatMulInteger" ||
+               op == "QLinearMatMul") {
+        AddGemm(node);
+    } else if (op == "Relu") {
+        FuseActivation(node, "relu");
+    } else if (op == "Sigmoid") {
+        FuseActivation(node, "sigmoid");
+    } else if (op == "Tanh") {
+        FuseActivation(node, "tanh");
+    } else if (op == "HardSwish") {
+        FuseActivation(node, "hardswish");
+    } else if (op == "LeakyRelu") {
+        FuseActivation(node, "leaky_relu");
+    } else if (op == "Clip") {
+        // Bounds are attributes before opset 11 and optional inputs after
+        float lo = node.floats.count("min") ? node.floats.at("min") : -1.0f;
+        float hi = node.floats.count("max") ? node.floats.at("max") : -1.0f;
+        for (size_t i = 1; i < node.inputs.size() && i < 3; ++i) {
+            const Tensor* bound = Initializer(node.inputs[i]);
+            if (bound && bound->data.size() == sizeof(float)) {
+                std::memcpy(i == 1 ? &lo : &hi, bound->data.data(), sizeof(float));
+            }
+        }
+        FuseActivation(node, lo == 0.0f && hi == 6.0f ? "relu6" : lo == 0.0f ? "relu" : "clip");
+    } else if (op == "Add" || op == "Sum") {
+        AddSum(node);
+    } else {
+        Propagate(node);
+    }
+}
+
+void OnnxImporter::AddConv(const Node & node) {
+    size_t weightIndex = node.op == "QLinearConv" ? 3 : 1;
+    Value x = Input(node, 0);
+    Value w = Input(node, weightIndex);
+    if (x.shape.size() != 4 || w.shape.size() != 4) {
+        Warn(node, "only 2-D convolutions with known shapes are lowered");
+        Propagate(node);
+        return;
+    }
+
+    int64_t groups = std::max<int64_t>(1, node.Int("group", 1));
+    std::vector<int64_t> kernel = node.List("kernel_shape", 2, 0);
+    std::vector<int64_t> strides = node.List("strides", 2, 1);
+    std::vector<int64_t> pads = node.List("pads", 4, 0);
+    std::vector<int64_t> dilations = node.List("dilations", 2, 1);
+    if (kernel[0] == 0) {
+        kernel = {w.shape[2], w.shape[3]};
+    }
+    if (dilations[0] != 1 || dilations[1] != 1) {
+        Warn(node, "dilation is ignored");
+    }
+
+    auto it = node.strings.find("auto_pad");
+    if (it != node.strings.end() && it->second.compare(0, 4, "SAME") == 0) {
+        for (int d = 0; d < 2; ++d) {
+            int64_t in = x.shape[2 + d];
+            int64_t out = (in + strides[d] - 1) / strides[d];
+            int64_t total = std::max<int64_t>(0, (out - 1) * strides[d] + kernel[d] - in);
+            pads[d] = it->second == "SAME_UPPER" ? total / 2 : total - total / 2;
+            pads[d + 2] = total - pads[d];
+        }
+    }
+
+    int64_t outH = (x.shape[2] + pads[0] + pads[2] - kernel[0]) / strides[0] + 1;
+    int64_t outW = (x.shape[3] + pads[1] + pads[3] - kernel[1]) / strides[1] + 1;
+
+    Layer & layer = NewLayer(node, x);
+    layer.type = groups > 1 && groups == x.shape[1] ? LayerType::DepthwiseConv : LayerType::Conv;
+    layer.batch = static_cast<uint32_t>(x.shape[0]);
+    layer.in_c = static_cast<uint32_t>(x.shape[1]);
+    layer.in_h = static_cast<uint32_t>(x.shape[2]);
+    layer.in_w = static_cast<uint32_t>(x.shape[3]);
+    layer.out_c = static_cast<uint32_t>(w.shape[0]);
+    layer.out_h = static_cast<uint32_t>(outH);
+    layer.out_w = static_cast<uint32_t>(outW);
+    layer.kernel_h = static_cast<uint32_t>(kernel[0]);
+    layer.kernel_w = static_cast<uint32_t>(kernel[1]);
+    layer.stride_h = static_cast<uint32_t>(strides[0]);
+    layer.stride_w = static_cast<uint32_t>(strides[1]);
+    layer.pad_h = static_cast<uint32_t>(pads[0]);
+    layer.pad_w = static_cast<uint32_t>(pads[1]);
+    layer.groups = static_cast<uint32_t>(groups);
+    AttachWeights(layer, node.inputs[weightIndex]);
+
+    Value out;
+    out.shape = {x.shape[0], w.shape[0], outH, outW};
+    out.layer = static_cast<int>(mLayers.size() - 1);
+    out.direct = true;
+    mValues[node.outputs[0]] = out;
+}
+
+void OnnxImporter::AddGemm(const Node & node) {
+    size_t weightIndex = node.op == "QLinearMatMul" ? 3 : 1;
+    Value a = Input(node, 0);
+    Value b = Input(node, weightIndex);
+    if (a.shape.empty() || b.shape.size() < 2) {
+        Warn(node, "operand shapes are unknown");
+        Propagate(node);
+        return;
+    }
+
+    int64_t m = 1;
+    int64_t k = 0;
+    int64_t n = 0;
+    std::vector<int64_t> shape;
+    if (node.op == "Gemm") {
+        bool transA = node.Int("transA", 0) != 0;
+        bool transB = node.Int("transB", 0) != 0;
+        m = transA ? a.shape.back() : a.shape.front();
+        k = transA ? a.shape.front() : a.shape.back();
+        n = transB ? b.shape[0] : b.shape[1];
+        shape = {m, n};
+    } else {
+        // Leading dimensions of A fold into M; batched B is treated as shared
+        if (b.shape.size() > 2) {
+            Warn(node, "batched right-hand operand is treated as shared");
+        }
+        for (size_t i = 0; i + 1 < a.shape.size(); ++i) {
+            m *= a.shape[i];
+        }
+        k = a.shape.back();
+        n = b.shape.back();
+        shape = a.shape;
+        shape.back() = n;
+    }
+
+    Layer & layer = NewLayer(node, a);
+    layer.type = LayerType::Gemm;
+    layer.m = static_cast<uint32_t>(m);
+    layer.k = static_cast<uint32_t>(k);
+    layer.n = static_cast<uint32_t>(n);
+    AttachWeights(layer, node.inputs[weightIndex]);
+
+    Value out;
+    out.shape = shape;
+    out.layer = static_cast<int>(mLayers.size() - 1);
+    out.direct = true;
+    mValues[node.outputs[0]] = out;
+}
+
+void OnnxImporter::FuseActivation(const Node & node, const std::string & activation) {
+    Value x = Input(node, 0);
+    if (x.layer < 0 || !x.direct || mLayers[x.layer].activation != "none" ||
+        mConsumers[node.inputs[0]] != 1) {
+        Warn(node, "activation is not directly after a layer and runs unfused");
+        x.direct = false;
+        mValues[node.outputs[0]] = x;
+        return;
+    }
+
+    Layer & layer = mLayers[x.layer];
+    layer.activation = activation;
+    layer.residual_then_act = !layer.residual.empty();
+    mValues[node.outputs[0]] = x;
+}
+
+void OnnxImporter::AddSum(const Node & node) {
+    if (node.inputs.size() != 2) {
+        Warn(node, "only two-operand sums are lowered");
+        Propagate(node);
+        return;
+    }
+
+    // A constant operand is a bias, folded into the layer
+    for (size_t i = 0; i < 2; ++i) {
+        if (Initializer(node.inputs[i])) {
+            mValues[node.outputs[0]] = Input(node, 1 - i);
+            return;
+        }
+    }
+
+    Value a = Input(node, 0);
+    Value b = Input(node, 1);
+    Value & later = a.layer > b.layer ? a : b;
+    Value & earlier = a.layer > b.layer ? b : a;
+    if (earlier.layer < 0 || earlier.layer == later.layer || !later.direct ||
+        !mLayers[later.layer].residual.empty()) {
+        Warn(node, "sum is not a residual connection into a layer and runs on the host");
+        later.direct = false;
+        mValues[node.outputs[0]] = later;
+        return;
+    }
+
+    mLayers[later.layer].residual = mLayers[earlier.layer].name;
+    mLayers[later.layer].residual_then_act = false;
+    mValues[node.outputs[0]] = later;
+}
+
+void OnnxImporter::Propagate(const Node & node) {
+    const std::string & op = node.op;
+    const std::string & output = node.outputs[0];
+
+    if (op == "Constant") {
+        auto it = node.tensors.find("value");
+        if (it != node.tensors.end()) {
+            mInitializers[output] = it->second;
+        } else {
+            Warn(node, "only tensor constants are supported");
+        }
+        return;
+    }
+
+    // Ops that leave a layer's output as it is, up to precision and affine folding
+    if (op == "Identity" || op == "Dropout" || op == "BatchNormalization" || op == "Cast" ||
+        op == "QuantizeLinear" || op == "DequantizeLinear") {
+        const Tensor* tensor = Initializer(node.inputs[0]);
+        if (tensor) {
+            // Quantized weights keep their stored type as the layer's precision
+            mInitializers[output] = *tensor;
+        } else {
+            mValues[output] = Input(node, 0);
+        }
+        return;
+    }
+
+    Value value = Input(node, 0);
+    value.direct = false;
+    std::vector<int64_t> & shape = value.shape;
+
+    if ((op == "MaxPool" || op == "AveragePool") && shape.size() == 4) {
+        std::vector<int64_t> kernel = node.List("kernel_shape", 2, 1);
+        std::vector<int64_t> strides = node.List("strides", 2, 1);
+        std::vector<int64_t> pads = node.List("pads", 4, 0);
+        shape[2] = (shape[2] + pads[0] + pads[2] - kernel[0]) / strides[0] + 1;
+        shape[3] = (shape[3] + pads[1] + pads[3] - kernel[1]) / strides[1] + 1;
+    } else if ((op == "GlobalAveragePool" || op == "GlobalMaxPool") && shape.size() == 4) {
+        shape[2] = 1;
+        shape[3] = 1;
+    } else if (op == "Flatten" && !shape.empty()) {
+        int64_t axis = node.Int("axis", 1);
+        if (axis < 0) {
+            axis += static_cast<int64_t>(shape.size());
+        }
+        int64_t outer = 1;
+        int64_t inner = 1;
+        for (size_t i = 0; i < shape.size(); ++i) {
+            (static_cast<int64_t>(i) < axis ? outer : inner) *= shape[i];
+        }
+        shape = {outer, inner};
+    } else if (op == "Reshape") {
+        const Tensor* target = node.inputs.size() > 1 ? Initializer(node.inputs[1]) : nullptr;
+        if (!target) {
+            Warn(node, "reshape target is not constant, shape kept");
+        } else {
+            int64_t total = 1;
+            for (int64_t dim : shape) {
+                total *= dim;
+            }
+            std::vector<int64_t> result = TensorInts(target->type, target->data);
+            int64_t known = 1;
+            int inferred = -1;
+            for (size_t i = 0; i < result.size(); ++i) {
+                if (result[i] == 0 && i < shape.size()) {
+                    result[i] = shape[i];
+                }
+                if (result[i] == -1) {
+                    inferred = static_cast<int>(i);
+                } else {
+                    known *= result[i];
+                }
+            }
+            if (inferred >= 0) {
+                result[inferred] = known > 0 ? total / known : 0;
+            }
+            shape = result;
+        }
+    } else if (op == "Transpose" && !shape.empty()) {
+        std::vector<int64_t> perm = node.List("perm", shape.size(), -1);
+        std::vector<int64_t> result(shape.rbegin(), shape.rend());
+        if (perm[0] >= 0) {
+            for (size_t i = 0; i < perm.size(); ++i) {
+                result[i] = shape[perm[i]];
+            }
+        }
+        shape = result;
+    } else if (op == "Concat" && !shape.empty()) {
+        int64_t axis = node.Int("axis", 0);
+        if (axis < 0) {
+            axis += static_cast<int64_t>(shape.size());
+        }
+        for (size_t i = 1; i < node.inputs.size(); ++i) {
+            Value other = Input(node, i);
+            if (static_cast<size_t>(axis) < other.shape.size()) {
+                shape[axis] += other.shape[axis];
+            }
+        }
+    } else {
+        Warn(node, "op is not lowered to the array, shape passed through");
+    }
+    mValues[output] = value;
+}
+
+Layer & OnnxImporter::NewLayer(const Node & node, const Value & input) {
+    std::string base = SanitizeName(node.name.empty() ? node.op + "_" +
+                                    std::to_string(mLayers.size()) : node.name);
+    std::string name = base;
+    for (int suffix = 1;
+         std::any_of(mLayers.begin(), mLayers.end(),
+                     [&](const Layer & layer) { return layer.name == name; });
+         ++suffix) {
+        name = base + "_" + std::to_string(suffix);
+    }
+
+    Layer layer;
+    layer.name = name;
+    if (input.layer >= 0 && input.layer + 1 != static_cast<int>(mLayers.size())) {
+        layer.input = mLayers[input.layer].name;
+    }
+
+    // Integer ops without a typed weight initializer are int8
+    bool integer = node.op != "Conv" && node.op != "Gemm" && node.op != "MatMul";
+    size_t weightIndex = node.op.compare(0, 6, "QLinear") == 0 ? 3 : 1;
+    const Tensor* weights =
+        weightIndex < node.inputs.size() ? Initializer(node.inputs[weightIndex]) : nullptr;
+    layer.precision = weights ? TensorTypeName(weights->type) : integer ? "int8" : "fp32";
+
+    mLayers.push_back(layer);
+    return mLayers.back();
+}
+
+void OnnxImporter::AttachWeights(Layer & layer, const std::string & name) {
+    const Tensor* tensor = Initializer(name);
+    if (mOptions.weights_dir.empty() || !tensor) {
+        return;
+    }
+    if (tensor->data.empty()) {
+        mWarnings.push_back(layer.name + ": weights are stored externally and were not extracted");
+        return;
+    }
+
+    fs::create_directories(mOptions.weights_dir);
+    std::string path = (fs::path(mOptions.weights_dir) / (layer.name + ".bin")).string();
+    std::vector<uint64_t> dims(tensor->dims.begin(), tensor->dims.end());
+    TensorFile::Write(path, tensor->type, dims, tensor->data.data(), tensor->data.size());
+    layer.weights = path;
+}
+
+const OnnxImporter::Tensor* OnnxImporter::Initializer(const std::string & name) const {
+    auto it = mInitializers.find(name);
+    return it == mInitializers.end() ? nullptr : &it->second;
+}
+
+OnnxImporter::Value OnnxImporter::Input(const Node & node, size_t index) {
+    Value value;
+    if (index >= node.inputs.size()) {
+        return value;
+    }
+    auto it = mValues.find(node.inputs[index]);
+    if (it != mValues.end()) {
+        return it->second;
+    }
+    const Tensor* tensor = Initializer(node.inputs[index]);
+    if (tensor) {
+        value.shape = tensor->dims;
+    } else {
+        Warn(node, "input '" + node.inputs[index] + "' has no known shape");
+    }
+    return value;
+}
+
+void OnnxImporter::Warn(const Node & node, const std::string & msg) {
+    std::string name = node.name.empty() ? node.outputs[0] : node.name;
+    mWarnings.push_back(node.op + " " + name + ": " + msg);
+}
+
+} // namespace gemmini
@@ -0,0 +1,90 @@
+// onnx_importer.hpp - Convert ONNX models into network layer lists
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "driver/layer_list.hpp"
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// OnnxImporter - reads an ONNX model and lowers its compute ops to a layer list.
+//
+// Conv, Gemm and MatMul (and their integer / QLinear forms) become layers. Activations
+// directly after a layer are fused into it, an Add of two layer outputs becomes a residual
+// edge, and shape-only ops (pooling, flatten, reshape, normalization) just propagate shapes.
+// Anything else is passed through with a warning. The protobuf is decoded directly, so no
+// ONNX or protobuf library is needed.
+class OnnxImporter {
+public:
+    struct Options {
+        std::string weights_dir; // Write each layer's weights here as a tensor file
+        uint32_t batch = 1;      // Batch size used for symbolic input dimensions
+    };
+
+    OnnxImporter() = default;
+    explicit OnnxImporter(const Options & options) : mOptions(options) {}
+
+    std::vector<Layer> Import(const std::string & path);
+    std::vector<Layer> ImportBytes(const std::string & bytes);
+
+    // Ops that were not understood or only partly lowered by the last import
+    const std::vector<std::string> & Warnings() const { return mWarnings; }
+
+private:
+    // An initializer, with its data as raw little-endian bytes
+    struct Tensor {
+        uint32_t type = 0;
+        std::vector<int64_t> dims;
+        std::string data;
+    };
+
+    // One graph node and the attributes the importer understands
+    struct Node {
+        std::string name;
+        std::string op;
+        std::vector<std::string> inputs;
+        std::vector<std::string> outputs;
+        std::map<std::string, int64_t> ints;
+        std::map<std::string, float> floats;
+        std::map<std::string, std::string> strings;
+        std::map<std::string, std::vector<int64_t>> lists;
+        std::map<std::string, Tensor> tensors;
+
+        int64_t Int(const std::string & key, int64_t fallback) const;
+        std::vector<int64_t> List(const std::string & key, size_t size, int64_t fallback) const;
+    };
+
+    // A value flowing through the graph
+    struct Value {
+        std::vector<int64_t> shape;
+        int layer = -1;      // Layer producing the value, -1 for graph inputs
+        bool direct = false; // Value is the layer's output, not reshaped or pooled
+    };
+
+    Options mOptions;
+    std::vector<std::string> mWarnings;
+    std::vector<Layer> mLayers;
+    std::map<std::string, Value> mValues;
+    std::map<std::string, Tensor> mInitializers;
+    std::map<std::string, uint32_t> mConsumers;
+
+    void ImportNode(const Node & node);
+    void AddConv(const Node & node);
+    void AddGemm(const Node & node);
+    void FuseActivation(const Node & node, const std::string & activation);
+    void AddSum(const Node & node);
+    void Propagate(const Node & node);
+
+    void ParseGraph(const uint8_t* data, size_t size);
+    Layer & NewLayer(const Node & node, const Value & input);
+    void AttachWeights(Layer & layer, const std::string & name);
+    const Tensor* Initializer(const std::string & name) const;
+    Value Input(const Node & node, size_t index);
+    void Warn(const Node & node, const std::string & msg);
+};
+
+END_NS(gemmini)
@@ -0,0 +1,163 @@
+// proto_reader.hpp - Minimal protobuf wire-format reader
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// ProtoReader - walks the fields of one protobuf message without a schema or libprotobuf.
+// Next() moves to the next field; the accessors then interpret its value. Nested messages
+// are read with Message(), which returns a reader over the field's bytes.
+class ProtoReader {
+public:
+    enum WireType : uint32_t {
+        Varint = 0,
+        Fixed64 = 1,
+        LengthDelimited = 2,
+        Fixed32 = 5,
+    };
+
+    ProtoReader(const uint8_t* data, size_t size) : mPos(data), mEnd(data + size) {}
+
+    // Advance to the next field, false at the end of the message
+    bool Next() {
+        if (mPos >= mEnd) {
+            return false;
+        }
+        uint64_t key = ReadVarint();
+        mField = static_cast<uint32_t>(key >> 3);
+        mWireType = static_cast<uint32_t>(key & 7);
+        switch (mWireType) {
+        case Varint:
+            mVarint = ReadVarint();
+            break;
+        case Fixed64:
+            mValue = Take(8);
+            mLength = 8;
+            break;
+        case LengthDelimited:
+            mLength = static_cast<size_t>(ReadVarint());
+            mValue = Take(mLength);
+            break;
+        case Fixed32:
+            mValue = Take(4);
+            mLength = 4;
+            break;
+        default:
+            throw std::runtime_error("Unsupported protobuf wire type " +
+                                     std::to_string(mWireType));
+        }
+        return true;
+    }
+
+    uint32_t Field() const { return mField; }
+    uint32_t Type() const { return mWireType; }
+
+    // Scalar values of the current field; the accessors throw std::runtime_error when the
+    // field has another wire type
+    uint64_t UInt() const {
+        Expect(Varint);
+        return mVarint;
+    }
+    int64_t Int() const { return static_cast<int64_t>(UInt()); }
+    float Float() const {
+        Expect(Fixed32);
+        float value;
+        std::memcpy(&value, mValue, sizeof(value));
+        return value;
+    }
+
+    // Length-delimited values of the current field
+    std::string String() const {
+        Expect(LengthDelimited);
+        return std::string(reinterpret_cast<const char*>(mValue), mLength);
+    }
+    const uint8_t* Data() const {
+        Expect(LengthDelimited);
+        return mValue;
+    }
+    size_t Size() const { return mLength; }
+    ProtoReader Message() const {
+        Expect(LengthDelimited);
+        return ProtoReader(mValue, mLength);
+    }
+
+    // Repeated integers, either packed into one field or one value per field
+    void AppendInts(std::vector<int64_t> & out) const {
+        if (mWireType != LengthDelimited) {
+            out.push_back(Int());
+            return;
+        }
+        ProtoReader packed(mValue, mLength);
+        while (packed.mPos < packed.mEnd) {
+            out.push_back(static_cast<int64_t>(packed.ReadVarint()));
+        }
+    }
+
+    // Repeated floats, either packed or one per field
+    void AppendFloats(std::vector<float> & out) const {
+        if (mWireType != LengthDelimited) {
+            out.push_back(Float());
+            return;
+        }
+        if (mLength % 4 != 0) {
+            throw std::runtime_error("Packed protobuf floats of " + std::to_string(mLength) +
+                                     " bytes");
+        }
+        for (size_t i = 0; i + 4 <= mLength; i += 4) {
+            float value;
+            std::memcpy(&value, mValue + i, sizeof(value));
+            out.push_back(value);
+        }
+    }
+
+private:
+    const uint8_t* mPos;
+    const uint8_t* mEnd;
+    uint32_t mField = 0;
+    uint32_t mWireType = 0;
+    uint64_t mVarint = 0;
+    const uint8_t* mValue = nullptr;
+    size_t mLength = 0;
+
+    void Expect(WireType type) const {
+        if (mWireType != type) {
+            throw std::runtime_error("Protobuf field " + std::to_string(mField) +
+                                     " has wire type " + std::to_string(mWireType) +
+                                     ", expected " + std::to_string(type));
+        }
+    }
+
+    uint64_t ReadVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (mPos >= mEnd) {
+                throw std::runtime_error("Truncated protobuf varint");
+            }
+            uint8_t byte = *mPos++;
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        throw std::runtime_error("Malformed protobuf varint");
+    }
+
+    const uint8_t* Take(size_t bytes) {
+        if (bytes > static_cast<size_t>(mEnd - mPos)) {
+            throw std::runtime_error("Truncated protobuf field");
+        }
+        const uint8_t* p = mPos;
+        mPos += bytes;
+        return p;
+    }
+};
+
+END_NS(gemmini)
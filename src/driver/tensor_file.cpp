@@ -0,0 +1,144 @@
+// tensor_file.cpp - Implementation of memory-mappable tensor files
+#include "driver/tensor_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace gemmini {
+
+static const char kTensorMagic[4] = {'G', 'T', 'E', 'N'};
+static const uint32_t kTensorVersion = 1;
+
+size_t TensorTypeBytes(uint32_t type) {
+    switch (static_cast<TensorType>(type)) {
+    case TensorType::UInt8:
+    case TensorType::Int8:
+        return 1;
+    case TensorType::Int16:
+    case TensorType::Float16:
+    case TensorType::BFloat16:
+        return 2;
+    case TensorType::Float32:
+    case TensorType::Int32:
+        return 4;
+    case TensorType::Int64:
+    case TensorType::Float64:
+        return 8;
+    }
+    return 0;
+}
+
+std::string TensorTypeName(uint32_t type) {
+    switch (static_cast<TensorType>(type)) {
+    case TensorType::Float32:
+        return "fp32";
+    case TensorType::UInt8:
+        return "uint8";
+    case TensorType::Int8:
+        return "int8";
+    case TensorType::Int16:
+        return "int16";
+    case TensorType::Int32:
+        return "int32";
+    case TensorType::Int64:
+        return "int64";
+    case TensorType::Float16:
+        return "fp16";
+    case TensorType::Float64:
+        return "fp64";
+    case TensorType::BFloat16:
+        return "bf16";
+    }
+    return "type" + std::to_string(type);
+}
+
+// Little-endian stores into the header
+static void PutU32(char* p, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        p[i] = static_cast<char>(value >> (8 * i));
+    }
+}
+
+static void PutU64(char* p, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        p[i] = static_cast<char>(value >> (8 * i));
+    }
+}
+
+static uint64_t GetU64(const unsigned char* p, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= uint64_t(p[i]) << (8 * i);
+    }
+    return value;
+}
+
+void TensorFile::Write(const std::string & path, uint32_t type, const std::vector<uint64_t> & dims,
+                       const void* data, size_t bytes) {
+    if (dims.size() > kMaxRank) {
+        throw std::runtime_error("Tensor rank " + std::to_string(dims.size()) +
+                                 " is too large for " + path);
+    }
+
+    char header[kHeaderBytes] = {0};
+    std::memcpy(header, kTensorMagic, 4);
+    PutU32(header + 4, kTensorVersion);
+    PutU32(header + 8, type);
+    PutU32(header + 12, static_cast<uint32_t>(dims.size()));
+    for (size_t i = 0; i < dims.size(); ++i) {
+        PutU64(header + 16 + 8 * i, dims[i]);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(header, kHeaderBytes);
+    file.write(static_cast<const char*>(data), bytes);
+    if (!file) {
+        throw std::runtime_error("Cannot write tensor file: " + path);
+    }
+}
+
+MappedTensor::MappedTensor(const std::string & path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open tensor file: " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(TensorFile::kHeaderBytes)) {
+        close(fd);
+        throw std::runtime_error("Tensor file too short: " + path);
+    }
+    mMappedBytes = static_cast<size_t>(st.st_size);
+    mMapping = mmap(nullptr, mMappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mMapping == MAP_FAILED) {
+        mMapping = nullptr;
+        throw std::runtime_error("Cannot map tensor file: " + path);
+    }
+
+    const unsigned char* header = static_cast<const unsigned char*>(mMapping);
+    uint32_t rank = static_cast<uint32_t>(GetU64(header + 12, 4));
+    if (std::memcmp(header, kTensorMagic, 4) != 0 || GetU64(header + 4, 4) != kTensorVersion ||
+        rank > TensorFile::kMaxRank) {
+        munmap(mMapping, mMappedBytes);
+        mMapping = nullptr;
+        throw std::runtime_error("Not a tensor file: " + path);
+    }
+    mType = static_cast<uint32_t>(GetU64(header + 8, 4));
+    for (uint32_t i = 0; i < rank; ++i) {
+        mDims.push_back(GetU64(header + 16 + 8 * i, 8));
+    }
+}
+
+MappedTensor::~MappedTensor() {
+    if (mMapping) {
+        munmap(mMapping, mMappedBytes);
+    }
+}
+
+} // namespace gemmini
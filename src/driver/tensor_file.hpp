@@ -0,0 +1,72 @@
+// tensor_file.hpp - Memory-mappable tensor files for extracted weights
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// Element types, numbered like ONNX TensorProto.DataType
+enum class TensorType : uint32_t {
+    Float32 = 1,
+    UInt8 = 2,
+    Int8 = 3,
+    Int16 = 5,
+    Int32 = 6,
+    Int64 = 7,
+    Float16 = 10,
+    Float64 = 11,
+    BFloat16 = 16,
+};
+
+// Bytes per element, 0 for unknown types
+size_t TensorTypeBytes(uint32_t type);
+
+// Precision name used in layer lists (fp32, int8, ...)
+std::string TensorTypeName(uint32_t type);
+
+// TensorFile - a 64-byte header followed by the raw little-endian elements, so the data
+// starts cache-line aligned and can be used in place from an mmap.
+//
+//   char     magic[4]  "GTEN"
+//   uint32_t version   1
+//   uint32_t type      TensorType
+//   uint32_t rank      at most 6
+//   uint64_t dims[6]   unused dims are 0
+class TensorFile {
+public:
+    static constexpr size_t kHeaderBytes = 64;
+    static constexpr size_t kMaxRank = 6;
+
+    static void Write(const std::string & path, uint32_t type, const std::vector<uint64_t> & dims,
+                      const void* data, size_t bytes);
+};
+
+// MappedTensor - read-only mapping of a tensor file
+class MappedTensor {
+public:
+    explicit MappedTensor(const std::string & path);
+    ~MappedTensor();
+
+    MappedTensor(const MappedTensor &) = delete;
+    MappedTensor & operator=(const MappedTensor &) = delete;
+
+    uint32_t Type() const { return mType; }
+    const std::vector<uint64_t> & Dims() const { return mDims; }
+    const void* Data() const {
+        return static_cast<const char*>(mMapping) + TensorFile::kHeaderBytes;
+    }
+    size_t Bytes() const { return mMappedBytes - TensorFile::kHeaderBytes; }
+
+private:
+    void* mMapping = nullptr;
+    size_t mMappedBytes = 0;
+    uint32_t mType = 0;
+    std::vector<uint64_t> mDims;
+};
+
+END_NS(gemmini)
@@ -0,0 +1,383 @@
+// work_queue.cpp - Implementation of the shared-directory work queue
+#include "driver/work_queue.hpp"
+#include "utils/arena.hpp"
+
+#include <signal.h>
+#include <sqlite3.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace gemmini {
+
+static const char kPendingDir[] = "pending";
+static const char kClaimedDir[] = "claimed";
+static const char kResultsDir[] = "results";
+static const char kJobSuffix[] = ".job";
+static const char kResultSuffix[] = ".result";
+static const char kMalformedOwner[] = "malformed";
+
+// "host.pid" of this process
+static std::string OwnerName() {
+    char host[256] = {0};
+    if (gethostname(host, sizeof(host) - 1) != 0) {
+        std::strcpy(host, "unknown");
+    }
+    return std::string(host) + "." + std::to_string(getpid());
+}
+
+// Job names become file names, so path separators and whitespace are replaced
+static std::string SafeName(const std::string & name) {
+    std::string safe = name;
+    for (char & ch : safe) {
+        if (ch == '/' || ch == '@' || std::isspace(static_cast<unsigned char>(ch))) {
+            ch = '_';
+        }
+    }
+    return safe;
+}
+
+// Unique id of one Submit call: the time in milliseconds, so ids sort in submission order,
+// then the submitting process and a per-process count
+static std::string SubmissionId(const std::string & owner) {
+    static std::atomic<uint32_t> submissions(0);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::system_clock::now().time_since_epoch())
+                  .count();
+    std::stringstream id;
+    id << std::setw(13) << std::setfill('0') << ms << "-" << SafeName(owner) << "-"
+       << submissions++;
+    return id.str();
+}
+
+// Regular files in a directory, sorted, skipping temporary files
+static std::vector<std::string> ListFiles(const std::string & dir) {
+    std::vector<std::string> names;
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        std::string name = it->path().filename().string();
+        if (!name.empty() && name[0] != '.') {
+            names.push_back(name);
+        }
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+WorkQueue::WorkQueue(const std::string & dir, std::chrono::seconds lease)
+    : mDir(dir), mOwner(OwnerName()), mLease(lease), mNextId(0) {
+    for (const char* sub : {kPendingDir, kClaimedDir, kResultsDir}) {
+        std::error_code ec;
+        fs::create_directories(fs::path(mDir) / sub, ec);
+        if (ec) {
+            throw std::runtime_error("Cannot create queue directory " + mDir + "/" + sub + ": " +
+                                     ec.message());
+        }
+    }
+}
+
+// Write to a hidden temporary file next to path, then rename it into place
+void WorkQueue::WriteAtomically(const std::string & path, const std::string & contents) {
+    fs::path target(path);
+    std::string tmp = (target.parent_path() / ("." + mOwner + "." + std::to_string(mNextId++)))
+                          .string();
+    {
+        std::ofstream file(tmp, std::ios::trunc);
+        file << contents;
+        if (!file.flush()) {
+            throw std::runtime_error("Cannot write " + tmp);
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("Cannot rename " + tmp + " to " + path + ": " +
+                                 std::strerror(errno));
+    }
+}
+
+// Job files hold one "name m k n seed" line and are prefixed with the submission id and
+// their index in it
+size_t WorkQueue::Submit(const std::vector<BatchJob> & jobs) {
+    std::string submission = SubmissionId(mOwner);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const BatchJob & job = jobs[i];
+        std::stringstream name;
+        name << submission << "_" << std::setw(6) << std::setfill('0') << i << "_"
+             << SafeName(job.name) << kJobSuffix;
+        std::stringstream line;
+        line << job.name << " " << job.m << " " << job.k << " " << job.n << " " << job.seed
+             << "\n";
+        WriteAtomically((fs::path(mDir) / kPendingDir / name.str()).string(), line.str());
+    }
+    return jobs.size();
+}
+
+// Claim by renaming into claimed/. A failed rename means another process won the job.
+bool WorkQueue::TryClaim(Claim & claim) {
+    std::string pending = (fs::path(mDir) / kPendingDir).string();
+    for (const auto & name : ListFiles(pending)) {
+        std::string from = pending + "/" + name;
+        std::string to = (fs::path(mDir) / kClaimedDir / (name + "@" + mOwner)).string();
+        if (std::rename(from.c_str(), to.c_str()) != 0) {
+            continue;
+        }
+
+        // The lease runs from the claim, not from the submission
+        std::error_code ec;
+        fs::last_write_time(to, fs::file_time_type::clock::now(), ec);
+
+        std::ifstream file(to);
+        BatchJob job;
+        if (!(file >> job.name >> job.m >> job.k >> job.n >> job.seed)) {
+            // Leave the malformed job in claimed/ for inspection, owned by nobody
+            std::string kept = (fs::path(mDir) / kClaimedDir /
+                                (name + "@" + kMalformedOwner)).string();
+            std::rename(to.c_str(), kept.c_str());
+            std::cerr << "WorkQueue: skipping malformed job file " << kept << std::endl;
+            continue;
+        }
+        claim.job = job;
+        claim.file = to;
+        claim.base = name.substr(0, name.size() - std::strlen(kJobSuffix));
+        return true;
+    }
+    return false;
+}
+
+// A claim is stale once its lease has run out, or when its owner ran on this host and the
+// process is gone. Owners on other hosts cannot be checked and wait for the lease.
+bool WorkQueue::IsStale(const std::string & claimedName) const {
+    size_t at = claimedName.rfind('@');
+    if (at == std::string::npos) {
+        return false;
+    }
+    std::string owner = claimedName.substr(at + 1);
+    if (owner == kMalformedOwner) {
+        return false;
+    }
+
+    std::error_code ec;
+    fs::path path = fs::path(mDir) / kClaimedDir / claimedName;
+    fs::file_time_type claimed = fs::last_write_time(path, ec);
+    if (!ec && fs::file_time_type::clock::now() - claimed > mLease) {
+        return true;
+    }
+
+    size_t dot = owner.rfind('.');
+    if (dot == std::string::npos || owner.substr(0, dot) != mOwner.substr(0, mOwner.rfind('.'))) {
+        return false;
+    }
+    pid_t pid = static_cast<pid_t>(std::strtol(owner.c_str() + dot + 1, nullptr, 10));
+    return pid > 0 && kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+// Rename stale claims back to their pending name; a failed rename means the owner finished
+// or another process requeued the job first
+size_t WorkQueue::RequeueStale() {
+    std::string claimed = (fs::path(mDir) / kClaimedDir).string();
+    size_t requeued = 0;
+    for (const auto & name : ListFiles(claimed)) {
+        if (!IsStale(name)) {
+            continue;
+        }
+        std::string from = claimed + "/" + name;
+        std::string to = (fs::path(mDir) / kPendingDir / name.substr(0, name.rfind('@'))).string();
+        if (std::rename(from.c_str(), to.c_str()) == 0) {
+            std::cerr << "WorkQueue: requeued stale claim " << name << std::endl;
+            ++requeued;
+        }
+    }
+    return requeued;
+}
+
+// Result files hold one tab-separated line, the error message comes last
+void WorkQueue::Complete(const Claim & claim, const BatchResult & result) {
+    std::string error = result.error;
+    std::replace(error.begin(), error.end(), '\n', ' ');
+    std::stringstream line;
+    line << result.name << "\t" << result.ok << "\t" << result.ticks << "\t" << result.checksum
+         << "\t" << result.wall_ms << "\t" << result.host << "\t" << result.worker << "\t"
+         << error << "\n";
+    WriteAtomically((fs::path(mDir) / kResultsDir / (claim.base + kResultSuffix)).string(),
+                    line.str());
+    std::remove(claim.file.c_str());
+}
+
+// Worker threads claim one job at a time, so hosts with more workers take more jobs
+size_t WorkQueue::Work(uint32_t workers, const JobFunction & run) {
+    std::atomic<size_t> done(0);
+    auto loop = [&](uint32_t worker) {
+        Arena arena;
+        ArenaScope scope(&arena);
+        Claim claim;
+        while (TryClaim(claim) || (RequeueStale() > 0 && TryClaim(claim))) {
+            BatchResult result = run(claim.job);
+            result.worker = worker;
+            result.host = mOwner;
+            Complete(claim, result);
+            arena.Reset();
+            ++done;
+        }
+    };
+
+    // Jobs abandoned by crashed workers go first
+    RequeueStale();
+
+    std::vector<std::thread> threads;
+    for (uint32_t w = 0; w < std::max(1u, workers); ++w) {
+        threads.emplace_back(loop, w);
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    return done;
+}
+
+std::vector<BatchResult> WorkQueue::LoadResults() const {
+    std::vector<BatchResult> results;
+    for (auto & entry : LoadResultFiles()) {
+        results.push_back(std::move(entry.second));
+    }
+    return results;
+}
+
+std::vector<std::pair<std::string, BatchResult>> WorkQueue::LoadResultFiles() const {
+    std::string dir = (fs::path(mDir) / kResultsDir).string();
+    std::vector<std::pair<std::string, BatchResult>> results;
+    for (const auto & name : ListFiles(dir)) {
+        std::ifstream file(dir + "/" + name);
+        std::string line;
+        if (!std::getline(file, line)) {
+            continue;
+        }
+
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (fields.size() < 7 && std::getline(ss, field, '\t')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 7) {
+            std::cerr << "WorkQueue: skipping malformed result file " << name << std::endl;
+            continue;
+        }
+        BatchResult result;
+        result.name = fields[0];
+        result.ok = fields[1] == "1";
+        result.ticks = std::stoull(fields[2]);
+        result.checksum = std::stoull(fields[3]);
+        result.wall_ms = std::stod(fields[4]);
+        result.host = fields[5];
+        result.worker = std::stoul(fields[6]);
+        std::getline(ss, result.error);
+        std::string job = name.substr(0, name.size() - std::min(name.size(),
+                                                                 std::strlen(kResultSuffix)));
+        results.emplace_back(job, result);
+    }
+    return results;
+}
+
+WorkQueue::MergeSummary WorkQueue::MergeResults(const std::string & dbPath) const {
+    std::vector<std::pair<std::string, BatchResult>> results = LoadResultFiles();
+
+    sqlite3* db = nullptr;
+    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK) {
+        std::string msg = db ? sqlite3_errmsg(db) : "out of memory";
+        sqlite3_close(db);
+        throw std::runtime_error("Cannot open results database " + dbPath + ": " + msg);
+    }
+
+    auto exec = [&](const char* sql) {
+        char* err = nullptr;
+        if (sqlite3_exec(db, sql, nullptr, nullptr, &err) != SQLITE_OK) {
+            std::string msg = err ? err : "unknown error";
+            sqlite3_free(err);
+            sqlite3_close(db);
+            throw std::runtime_error("Results database error: " + msg);
+        }
+    };
+    // Rows are keyed by the job file, so a job submitted twice keeps both results and
+    // merging again only replaces rows with themselves
+    exec("CREATE TABLE IF NOT EXISTS results ("
+         "job TEXT PRIMARY KEY, name TEXT, ok INTEGER, ticks INTEGER, checksum INTEGER, "
+         "wall_ms REAL, host TEXT, worker INTEGER, error TEXT)");
+    sqlite3_stmt* probe = nullptr;
+    bool keyed = sqlite3_prepare_v2(db, "SELECT job FROM results", -1, &probe, nullptr) ==
+                 SQLITE_OK;
+    sqlite3_finalize(probe);
+    if (!keyed) {
+        sqlite3_close(db);
+        throw std::runtime_error("Results database " + dbPath +
+                                 " has no job column; merge into a new database");
+    }
+    exec("BEGIN TRANSACTION");
+
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db,
+                       "INSERT OR REPLACE INTO results VALUES "
+                       "(?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9)",
+                       -1, &stmt, nullptr);
+    for (const auto & entry : results) {
+        const BatchResult & result = entry.second;
+        sqlite3_bind_text(stmt, 1, entry.first.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, result.name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 3, result.ok);
+        sqlite3_bind_int64(stmt, 4, static_cast<sqlite3_int64>(result.ticks));
+        sqlite3_bind_int64(stmt, 5, static_cast<sqlite3_int64>(result.checksum));
+        sqlite3_bind_double(stmt, 6, result.wall_ms);
+        sqlite3_bind_text(stmt, 7, result.host.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 8, result.worker);
+        sqlite3_bind_text(stmt, 9, result.error.c_str(), -1, SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            std::string msg = sqlite3_errmsg(db);
+            sqlite3_finalize(stmt);
+            sqlite3_close(db);
+            throw std::runtime_error("Cannot insert result " + entry.first + ": " + msg);
+        }
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    exec("COMMIT");
+    sqlite3_close(db);
+
+    // Jobs without a result, and names that ran in more than one submission
+    MergeSummary summary;
+    summary.merged = results.size();
+    for (const auto & name : ListFiles((fs::path(mDir) / kPendingDir).string())) {
+        summary.pending.push_back(name);
+    }
+    for (const auto & name : ListFiles((fs::path(mDir) / kClaimedDir).string())) {
+        (IsStale(name) ? summary.stale : summary.claimed).push_back(name);
+    }
+    std::map<std::string, size_t> runs;
+    for (const auto & entry : results) {
+        if (++runs[entry.second.name] == 2) {
+            summary.repeated.push_back(entry.second.name);
+        }
+    }
+    return summary;
+}
+
+size_t WorkQueue::NumPending() const {
+    return ListFiles((fs::path(mDir) / kPendingDir).string()).size();
+}
+
+size_t WorkQueue::NumClaimed() const {
+    return ListFiles((fs::path(mDir) / kClaimedDir).string()).size();
+}
+
+} // namespace gemmini
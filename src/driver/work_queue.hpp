@@ -0,0 +1,95 @@
+// work_queue.hpp - Shared-directory work queue for multi-host GEMM sweeps
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "driver/batch_runner.hpp"
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// WorkQueue - a job queue kept as files in a directory that every host can reach.
+//
+//   pending/  one file per job waiting to run
+//   claimed/  jobs being run, renamed here by the process that took them
+//   results/  one file per finished job
+//
+// A job is claimed by renaming it from pending/ to claimed/. rename() is atomic, so when
+// several processes race for a job exactly one succeeds. Files are written under a
+// temporary name and renamed into place, so readers never see partial files.
+//
+// Job files are named "<submission>_<index>_<name>.job", where the submission id is the
+// submit time and "host.pid" of the submitting process, so resubmitting a job never
+// overwrites an earlier one. A claim whose owner process has died, or which is older than
+// the lease, is stale and is put back into pending/. A job that outlives its lease can run
+// twice; its result file is then written twice with the same contents.
+class WorkQueue {
+public:
+    // A claimed job and the file that marks the claim
+    struct Claim {
+        BatchJob job;
+        std::string file; // Path in claimed/
+        std::string base; // Job file name without directory or owner suffix
+    };
+
+    // Outcome of a merge, with the jobs that have no result yet
+    struct MergeSummary {
+        size_t merged = 0;                  // Results written to the database
+        std::vector<std::string> pending;   // Jobs nobody has claimed
+        std::vector<std::string> claimed;   // Jobs being run
+        std::vector<std::string> stale;     // Claims whose owner died or whose lease ran out
+        std::vector<std::string> repeated;  // Job names with results from several submissions
+    };
+
+    using JobFunction = std::function<BatchResult(const BatchJob &)>;
+
+    // Use (and create if needed) the queue rooted at dir. Claims older than lease are
+    // considered abandoned.
+    explicit WorkQueue(const std::string & dir,
+                       std::chrono::seconds lease = std::chrono::hours(24));
+
+    // Add jobs to pending/ under a new submission id, returns the number added
+    size_t Submit(const std::vector<BatchJob> & jobs);
+
+    // Take the next pending job, returns false once none are left
+    bool TryClaim(Claim & claim);
+
+    // Move stale claims back to pending/, returns the number requeued
+    size_t RequeueStale();
+
+    // Write the result of a claimed job and release the claim
+    void Complete(const Claim & claim, const BatchResult & result);
+
+    // Claim and run jobs on worker threads until the queue is empty, returns the number run
+    size_t Work(uint32_t workers, const JobFunction & run);
+
+    // Read every result written so far
+    std::vector<BatchResult> LoadResults() const;
+
+    // Insert or replace all results in an SQLite database, one row per submitted job
+    MergeSummary MergeResults(const std::string & dbPath) const;
+
+    size_t NumPending() const;
+    size_t NumClaimed() const;
+
+private:
+    const std::string mDir;
+    const std::string mOwner; // "host.pid", appended to claimed file names
+    const std::chrono::seconds mLease;
+    std::atomic<uint32_t> mNextId; // Distinguishes this process's temporary files
+
+    void WriteAtomically(const std::string & path, const std::string & contents);
+    bool IsStale(const std::string & claimedName) const;
+
+    // Results by job file name (without suffix)
+    std::vector<std::pair<std::string, BatchResult>> LoadResultFiles() const;
+};
+
+END_NS(gemmini)
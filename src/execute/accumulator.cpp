@@ -0,0 +1,65 @@
+// accumulator.cpp - Implementation of the Accumulator output regions and drain pipeline
+#include "execute/accumulator.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/kernel/SpartaHandler.hpp"
+#include <algorithm>
+
+namespace gemmini {
+// Initialize static name
+const char Accumulator::name[] = "accumulator";
+
+// Constructor
+Accumulator::Accumulator(sparta::TreeNode* node, const AccumulatorParameterSet* params)
+    : sparta::Unit(node), mPortSet(node), mUnitEventSet(node),
+      mRegions(std::max(1u, static_cast<uint32_t>(params->output_regions))),
+      mPipeline(params->drain_bytes_per_cycle, params->drain_latency),
+      mDrains(getStatisticSet(), "drains", "Count of accumulator regions drained to DRAM",
+              sparta::Counter::COUNT_NORMAL),
+      mDrainBytes(getStatisticSet(), "drain_bytes", "Bytes drained to DRAM",
+                  sparta::Counter::COUNT_NORMAL),
+      mDrainBusy(getStatisticSet(), "drain_busy_cycles",
+                 "Cycles the output pipeline spent moving data", sparta::Counter::COUNT_NORMAL),
+      mDrainDoneEvent(&mUnitEventSet, "drain_done_event",
+                      CREATE_SPARTA_HANDLER(Accumulator, DrainDone)) {
+    mPortSet.in_drain.registerConsumerHandler(
+        CREATE_SPARTA_HANDLER_WITH_DATA(Accumulator, HandleDrain, uint64_t));
+}
+
+bool Accumulator::SetKnob(const std::string & knob, uint64_t value) {
+    uint32_t setting = static_cast<uint32_t>(value);
+    if (knob == "drain_bytes_per_cycle") {
+        mPipeline.SetRate(setting, mPipeline.Latency());
+    } else if (knob == "drain_latency") {
+        mPipeline.SetRate(mPipeline.BytesPerCycle(), setting);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Queue a stored region on the output pipeline
+void Accumulator::HandleDrain(const uint64_t & bytes) {
+    uint64_t now = getClock()->currentCycle();
+    uint64_t busyBefore = mPipeline.BusyCycles();
+    uint64_t done = mPipeline.Issue(now, bytes);
+    mDrainBusy += mPipeline.BusyCycles() - busyBefore;
+    mDrainBytes += bytes;
+    mDoneCycles.push_back(done);
+    mDrainDoneEvent.schedule(done - now);
+}
+
+// Report every drain that has completed by now
+void Accumulator::DrainDone() {
+    uint64_t now = getClock()->currentCycle();
+    uint32_t count = 0;
+    while (!mDoneCycles.empty() && mDoneCycles.front() <= now) {
+        mDoneCycles.pop_front();
+        ++count;
+    }
+    if (count > 0) {
+        mDrains += count;
+        mPortSet.out_drained.send(count);
+    }
+}
+
+} // namespace gemmini
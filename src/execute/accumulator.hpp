@@ -0,0 +1,116 @@
+// accumulator.hpp - Accumulator output regions and drain pipeline for Gemmini using SPARTA
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+
+#include "sparta/ports/PortSet.hpp"
+#include "sparta/ports/DataPort.hpp"
+#include "sparta/events/EventSet.hpp"
+#include "sparta/events/UniqueEvent.hpp"
+#include "sparta/simulation/Unit.hpp"
+#include "sparta/simulation/ParameterSet.hpp"
+#include "sparta/simulation/TreeNode.hpp"
+#include "sparta/simulation/ResourceFactory.hpp"
+#include "sparta/statistics/Counter.hpp"
+
+#include "gemmini/common.hpp"
+#include "execute/drain_pipeline.hpp"
+
+BEGIN_NS(gemmini)
+
+class Accumulator;
+
+// Parameter Set for Accumulator
+class AccumulatorParameterSet : public sparta::ParameterSet {
+public:
+    // Constructor - connect params to the Accumulator's TreeNode
+    AccumulatorParameterSet(sparta::TreeNode* n) : sparta::ParameterSet(n) {
+        // Parameters are initialized using the PARAMETER macro
+    }
+
+    // Parameters
+    PARAMETER(uint32_t, output_regions, 2,
+              "Accumulator output regions; with 2 a tile computes into one while the other "
+              "drains, with 1 every drain is exposed")
+    PARAMETER(uint32_t, drain_bytes_per_cycle, 16, "Width of the output (mvout) pipeline")
+    PARAMETER(uint32_t, drain_latency, 4, "Fixed cycles from the pipeline to DRAM per drain")
+};
+
+// Port Set for Accumulator
+class AccumulatorPortSet : public sparta::PortSet {
+public:
+    // Constructor
+    AccumulatorPortSet(sparta::TreeNode* n)
+        : sparta::PortSet(n),
+          in_drain(n, "in_drain", sparta::SchedulingPhase::Tick, 0),
+          out_drained(n, "out_drained") {
+        // No need to register ports explicitly - the base class does this
+    }
+
+    // Bytes of a result region to drain to DRAM
+    sparta::DataInPort<uint64_t> in_drain;
+
+    // Number of drains that completed this cycle, their regions are free again
+    sparta::DataOutPort<uint32_t> out_drained;
+};
+
+// Accumulator - holds computed tiles in its output regions and drains stored regions through
+// the output pipeline to DRAM. Timing only; the matrix multiplier moves the data when it
+// issues the store and waits here for a free region before the next compute.
+class Accumulator : public sparta::Unit {
+public:
+    // Static name for this resource
+    static const char name[];
+
+    // Constructor
+    Accumulator(sparta::TreeNode* node, const AccumulatorParameterSet* params);
+
+    // Define parameter set type for use with ResourceFactory
+    typedef AccumulatorParameterSet ParameterSet;
+
+    // Factory for Accumulator creation
+    class Factory : public sparta::ResourceFactory<Accumulator, AccumulatorParameterSet> {
+    public:
+        // Using parent constructor
+        using sparta::ResourceFactory<Accumulator, AccumulatorParameterSet>::ResourceFactory;
+    };
+
+    // Return port set
+    AccumulatorPortSet & GetPortSet() { return mPortSet; }
+
+    uint32_t NumRegions() const { return mRegions; }
+
+    // Change drain_bytes_per_cycle or drain_latency for drains queued from now on. Returns
+    // false for an unknown knob.
+    bool SetKnob(const std::string & knob, uint64_t value);
+
+private:
+    // Port set
+    AccumulatorPortSet mPortSet;
+
+    // Event set for scheduling
+    sparta::EventSet mUnitEventSet;
+
+    // Configuration
+    const uint32_t mRegions;
+
+    // Output pipeline and the cycles queued drains complete, in order
+    DrainPipeline mPipeline;
+    std::deque<uint64_t> mDoneCycles;
+
+    // Statistics
+    sparta::Counter mDrains;         // Count of drained regions
+    sparta::Counter mDrainBytes;     // Bytes drained to DRAM
+    sparta::Counter mDrainBusy;      // Cycles the output pipeline moved data
+
+    // Fires when the oldest queued drain completes
+    sparta::UniqueEvent<> mDrainDoneEvent;
+
+    // Internal methods
+    void HandleDrain(const uint64_t & bytes);
+    void DrainDone();
+};
+
+END_NS(gemmini)
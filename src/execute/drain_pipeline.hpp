@@ -0,0 +1,49 @@
+// drain_pipeline.hpp - Timing of the accumulator output (mvout) pipeline
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// DrainPipeline - accumulator regions drained to DRAM one after another. A drain occupies
+// the pipeline for its bytes at the pipeline width; its fixed latency overlaps the next
+// drain, so back-to-back drains stream at full width.
+class DrainPipeline {
+public:
+    DrainPipeline(uint32_t bytesPerCycle, uint32_t latency)
+        : mBytesPerCycle(std::max(1u, bytesPerCycle)), mLatency(latency) {}
+
+    // Queue a drain of bytes issued at cycle, returns the cycle its data is out
+    uint64_t Issue(uint64_t cycle, uint64_t bytes) {
+        uint64_t start = std::max(cycle, mFreeCycle);
+        uint64_t occupancy = (bytes + mBytesPerCycle - 1) / mBytesPerCycle;
+        mFreeCycle = start + occupancy;
+        mBusyCycles += occupancy;
+        return mFreeCycle + mLatency;
+    }
+
+    // Change the width and latency for drains issued from now on
+    void SetRate(uint32_t bytesPerCycle, uint32_t latency) {
+        mBytesPerCycle = std::max(1u, bytesPerCycle);
+        mLatency = latency;
+    }
+    uint32_t BytesPerCycle() const { return mBytesPerCycle; }
+    uint32_t Latency() const { return mLatency; }
+
+    // First cycle the pipeline can start another drain
+    uint64_t FreeCycle() const { return mFreeCycle; }
+
+    // Cycles the pipeline has spent moving data
+    uint64_t BusyCycles() const { return mBusyCycles; }
+
+private:
+    uint32_t mBytesPerCycle;
+    uint32_t mLatency;
+    uint64_t mFreeCycle = 0;
+    uint64_t mBusyCycles = 0;
+};
+
+END_NS(gemmini)
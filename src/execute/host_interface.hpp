@@ -0,0 +1,84 @@
+// host_interface.hpp - Timing of the host issuing commands to the accelerator
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// Host interface configuration, in accelerator command-clock cycles
+struct HostConfig {
+    uint32_t issue_cycles = 0;  // Host cycles to issue one command (load, preload, compute, store)
+    uint32_t queue_depth = 0;   // Commands issued but not yet retired, 0 for unlimited
+    uint32_t fence_cycles = 0;  // Cost of the fence that ends a GEMM, after all commands retire
+};
+
+// HostInterface - one host thread feeding the accelerator's command queue. The host issues
+// commands in order, one per issue_cycles, and runs ahead of the accelerator until the queue
+// holds queue_depth unretired commands; then it waits for the oldest to retire. A GEMM ends
+// with a fence: the host waits for every command to retire and pays the fence cost before it
+// can issue anything else. Commands leave the queue in order.
+class HostInterface {
+public:
+    explicit HostInterface(const HostConfig & config = HostConfig()) : mConfig(config) {}
+
+    // Change the configuration for commands issued and fences from now on
+    void SetConfig(const HostConfig & config) { mConfig = config; }
+    const HostConfig & Config() const { return mConfig; }
+
+    // The host gets work at cycle; it cannot issue that work's commands earlier
+    void Submit(uint64_t cycle) { mHostFree = std::max(mHostFree, cycle); }
+
+    // Issue the next command, returns the cycle it reaches the accelerator
+    uint64_t Issue() {
+        uint64_t start = mHostFree;
+        if (mConfig.queue_depth > 0 && mRetired.size() >= mConfig.queue_depth) {
+            // The command queue_depth places back must have left the queue
+            uint64_t slotFree = mRetired[mRetired.size() - mConfig.queue_depth];
+            if (slotFree > start) {
+                mQueueFullCycles += slotFree - start;
+                start = slotFree;
+            }
+        }
+        mHostFree = start + mConfig.issue_cycles;
+        ++mCommands;
+        return mHostFree;
+    }
+
+    // The oldest issued command finished at cycle; it leaves the queue once all older ones have
+    void Retire(uint64_t cycle) {
+        mRetired.push_back(mRetired.empty() ? cycle : std::max(cycle, mRetired.back()));
+        if (mRetired.size() > std::max(1u, mConfig.queue_depth)) {
+            mRetired.pop_front();
+        }
+    }
+
+    // Fence once every command has retired at cycle, returns the cycle the host continues
+    uint64_t Fence(uint64_t cycle) {
+        mHostFree = std::max(mHostFree, cycle) + mConfig.fence_cycles;
+        mFenceCycles += mConfig.fence_cycles;
+        ++mFences;
+        return mHostFree;
+    }
+
+    uint64_t Commands() const { return mCommands; }
+    uint64_t Fences() const { return mFences; }
+    uint64_t FenceCycles() const { return mFenceCycles; }
+
+    // Cycles the host waited for a slot in a full command queue
+    uint64_t QueueFullCycles() const { return mQueueFullCycles; }
+
+private:
+    HostConfig mConfig;
+    uint64_t mHostFree = 0;
+    std::deque<uint64_t> mRetired;  // Retire cycles of the most recent commands
+    uint64_t mCommands = 0;
+    uint64_t mFences = 0;
+    uint64_t mFenceCycles = 0;
+    uint64_t mQueueFullCycles = 0;
+};
+
+END_NS(gemmini)
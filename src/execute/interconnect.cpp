@@ -0,0 +1,198 @@
+// interconnect.cpp - Implementation of the on-chip network model
+#include "execute/interconnect.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace gemmini {
+
+namespace {
+
+// Mesh link directions out of a router
+enum MeshDir : uint32_t { kEast = 0, kWest = 1, kSouth = 2, kNorth = 3, kMeshDirs = 4 };
+
+} // namespace
+
+const char* TopologyName(Topology topology) {
+    switch (topology) {
+    case Topology::Mesh:
+        return "mesh";
+    case Topology::Ring:
+        return "ring";
+    case Topology::Crossbar:
+        return "crossbar";
+    }
+    return "unknown";
+}
+
+bool ParseTopology(const std::string & name, Topology & topology) {
+    if (name == "mesh") {
+        topology = Topology::Mesh;
+    } else if (name == "ring") {
+        topology = Topology::Ring;
+    } else if (name == "crossbar" || name == "xbar") {
+        topology = Topology::Crossbar;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+Interconnect::Interconnect(const InterconnectConfig & config, uint32_t nodes)
+    : mConfig(config), mNodes(nodes) {
+    if (nodes == 0) {
+        throw std::runtime_error("Interconnect needs at least one node");
+    }
+    if (config.link_bytes == 0 || config.packet_bytes == 0 || config.virtual_channels == 0) {
+        throw std::runtime_error("Interconnect link_bytes, packet_bytes and virtual_channels "
+                                 "must be non-zero");
+    }
+
+    switch (config.topology) {
+    case Topology::Mesh: {
+        // Nodes fill a near-square grid row by row; routers in an incomplete last row exist
+        // so XY routes never leave the grid
+        mMeshCols = static_cast<uint32_t>(std::ceil(std::sqrt(double(nodes))));
+        uint32_t rows = (nodes + mMeshCols - 1) / mMeshCols;
+        mLinks.resize(rows * mMeshCols * kMeshDirs);
+        mStats.resize(mLinks.size());
+        for (uint32_t y = 0; y < rows; ++y) {
+            for (uint32_t x = 0; x < mMeshCols; ++x) {
+                uint32_t r = y * mMeshCols + x;
+                auto name = [](uint32_t from, uint32_t to) {
+                    return std::to_string(from) + "->" + std::to_string(to);
+                };
+                if (x + 1 < mMeshCols) {
+                    AddLink(r * kMeshDirs + kEast, name(r, r + 1));
+                    AddLink((r + 1) * kMeshDirs + kWest, name(r + 1, r));
+                }
+                if (y + 1 < rows) {
+                    AddLink(r * kMeshDirs + kSouth, name(r, r + mMeshCols));
+                    AddLink((r + mMeshCols) * kMeshDirs + kNorth, name(r + mMeshCols, r));
+                }
+            }
+        }
+        break;
+    }
+    case Topology::Ring:
+        // Link 2i runs clockwise out of node i, link 2i + 1 counter-clockwise
+        mLinks.resize(nodes * 2);
+        mStats.resize(mLinks.size());
+        if (nodes > 1) {
+            for (uint32_t i = 0; i < nodes; ++i) {
+                uint32_t next = (i + 1) % nodes;
+                uint32_t prev = (i + nodes - 1) % nodes;
+                AddLink(i * 2, std::to_string(i) + "->" + std::to_string(next));
+                AddLink(i * 2 + 1, std::to_string(i) + "->" + std::to_string(prev));
+            }
+        }
+        break;
+    case Topology::Crossbar:
+        // Link 2i injects from node i, link 2i + 1 ejects to it
+        mLinks.resize(nodes * 2);
+        mStats.resize(mLinks.size());
+        for (uint32_t i = 0; i < nodes; ++i) {
+            AddLink(i * 2, std::to_string(i) + "->xbar");
+            AddLink(i * 2 + 1, "xbar->" + std::to_string(i));
+        }
+        break;
+    }
+}
+
+void Interconnect::AddLink(uint32_t index, const std::string & name) {
+    mLinks[index].vcs.assign(mConfig.virtual_channels, 0);
+    mStats[index].name = name;
+}
+
+std::vector<uint32_t> Interconnect::Route(uint32_t src, uint32_t dst) const {
+    if (src >= mNodes || dst >= mNodes) {
+        throw std::runtime_error("Interconnect node out of range");
+    }
+    std::vector<uint32_t> route;
+    if (src == dst) {
+        return route;
+    }
+    switch (mConfig.topology) {
+    case Topology::Mesh: {
+        // Dimension order: along the row first, then along the column
+        uint32_t x = src % mMeshCols, y = src / mMeshCols;
+        const uint32_t dx = dst % mMeshCols, dy = dst / mMeshCols;
+        while (x != dx) {
+            uint32_t r = y * mMeshCols + x;
+            route.push_back(r * kMeshDirs + (x < dx ? kEast : kWest));
+            x = x < dx ? x + 1 : x - 1;
+        }
+        while (y != dy) {
+            uint32_t r = y * mMeshCols + x;
+            route.push_back(r * kMeshDirs + (y < dy ? kSouth : kNorth));
+            y = y < dy ? y + 1 : y - 1;
+        }
+        break;
+    }
+    case Topology::Ring: {
+        uint32_t clockwise = (dst + mNodes - src) % mNodes;
+        bool cw = clockwise <= mNodes - clockwise;
+        for (uint32_t i = src; i != dst; i = cw ? (i + 1) % mNodes : (i + mNodes - 1) % mNodes) {
+            route.push_back(i * 2 + (cw ? 0 : 1));
+        }
+        break;
+    }
+    case Topology::Crossbar:
+        route.push_back(src * 2);
+        route.push_back(dst * 2 + 1);
+        break;
+    }
+    return route;
+}
+
+uint64_t Interconnect::SendPacket(uint64_t cycle, const std::vector<uint32_t> & route,
+                                  uint64_t bytes) {
+    const uint64_t flits = (bytes + mConfig.link_bytes - 1) / mConfig.link_bytes;
+    std::vector<uint64_t> at(route.size());
+    std::vector<size_t> vc(route.size());
+
+    // The head enters each link once the link has bandwidth and a virtual channel is free
+    uint64_t head = cycle;
+    for (size_t i = 0; i < route.size(); ++i) {
+        Link & link = mLinks[route[i]];
+        auto channel = std::min_element(link.vcs.begin(), link.vcs.end());
+        vc[i] = channel - link.vcs.begin();
+        at[i] = std::max({head, link.free, *channel});
+        link.free = at[i] + flits;
+        LinkStats & stats = mStats[route[i]];
+        ++stats.packets;
+        stats.bytes += bytes;
+        stats.busy_cycles += flits;
+        head = at[i] + mConfig.router_latency + 1;
+    }
+
+    // A virtual channel is held until the tail has moved on to the next link
+    for (size_t i = 0; i < route.size(); ++i) {
+        uint64_t tailOut = (i + 1 < route.size() ? at[i + 1] : head) + flits;
+        mLinks[route[i]].vcs[vc[i]] = tailOut;
+    }
+    return head + flits;
+}
+
+uint64_t Interconnect::Send(uint64_t cycle, uint32_t src, uint32_t dst, uint64_t bytes) {
+    std::vector<uint32_t> route = Route(src, dst);
+    if (route.empty() || bytes == 0) {
+        return cycle;
+    }
+    uint64_t arrival = cycle;
+    for (uint64_t sent = 0; sent < bytes; sent += mConfig.packet_bytes) {
+        uint64_t size = std::min<uint64_t>(mConfig.packet_bytes, bytes - sent);
+        arrival = std::max(arrival, SendPacket(cycle, route, size));
+    }
+    return arrival;
+}
+
+double Interconnect::Utilization(size_t link, uint64_t cycles) const {
+    if (cycles == 0 || link >= mStats.size()) {
+        return 0.0;
+    }
+    return std::min(1.0, double(mStats[link].busy_cycles) / cycles);
+}
+
+} // namespace gemmini
@@ -0,0 +1,88 @@
+// interconnect.hpp - On-chip network between accelerator instances and memory controllers
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// Interconnect topology
+enum class Topology : uint8_t {
+    Mesh = 0,     // 2D mesh with dimension-order (XY) routing
+    Ring = 1,     // Bidirectional ring, shortest direction
+    Crossbar = 2, // One injection and one ejection port per node, one router hop
+};
+
+const char* TopologyName(Topology topology);
+bool ParseTopology(const std::string & name, Topology & topology);
+
+// Interconnect configuration
+struct InterconnectConfig {
+    Topology topology = Topology::Mesh;
+    uint32_t link_bytes = 32;      // Link width, bytes per cycle (one flit)
+    uint32_t router_latency = 2;   // Cycles a packet head spends in each router
+    uint32_t virtual_channels = 2; // Packets a link can buffer at once
+    uint32_t packet_bytes = 256;   // Transfers are split into packets of at most this size
+};
+
+// Traffic carried by one directed link
+struct LinkStats {
+    std::string name;
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint64_t busy_cycles = 0; // Cycles the link moved flits
+};
+
+// Interconnect - reservation-based model of a wormhole-routed network. A packet's head
+// moves one router per router_latency + 1 cycles and its flits follow back to back, so an
+// uncontended transfer takes hops * (router_latency + 1) + flits cycles. Each link moves one
+// flit per cycle and holds a virtual channel from the packet's head arriving until its tail
+// has moved on to the next link; a packet blocked downstream therefore keeps its upstream
+// virtual channels, and with one virtual channel it blocks the link for everyone else.
+//
+// Packets are booked in the order they are sent, so callers should send in roughly
+// increasing cycle order.
+class Interconnect {
+public:
+    Interconnect(const InterconnectConfig & config, uint32_t nodes);
+
+    // Move bytes from node src to node dst starting at cycle; returns the cycle the last byte
+    // arrives. A node sending to itself takes no time.
+    uint64_t Send(uint64_t cycle, uint32_t src, uint32_t dst, uint64_t bytes);
+
+    // Router hops between two nodes
+    uint32_t Hops(uint32_t src, uint32_t dst) const {
+        return static_cast<uint32_t>(Route(src, dst).size());
+    }
+
+    uint32_t NumNodes() const { return mNodes; }
+    // Per-link traffic; links a mesh does not have are unnamed and stay empty
+    const std::vector<LinkStats> & Links() const { return mStats; }
+
+    // Fraction of cycles a link was busy over a run of the given length
+    double Utilization(size_t link, uint64_t cycles) const;
+
+private:
+    // Reservation state of one directed link
+    struct Link {
+        uint64_t free = 0;            // First cycle the link can move another flit
+        std::vector<uint64_t> vcs;    // First cycle each virtual channel is free
+    };
+
+    const InterconnectConfig mConfig;
+    const uint32_t mNodes;
+    uint32_t mMeshCols = 1;
+    std::vector<Link> mLinks;
+    std::vector<LinkStats> mStats;
+
+    // Links a packet from src to dst crosses, in order
+    std::vector<uint32_t> Route(uint32_t src, uint32_t dst) const;
+
+    void AddLink(uint32_t index, const std::string & name);
+    uint64_t SendPacket(uint64_t cycle, const std::vector<uint32_t> & route, uint64_t bytes);
+};
+
+END_NS(gemmini)
@@ -1,12 +1,15 @@
 // matrix.hpp - Matrix and Vector data structures for Gemmini simulator
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <vector>
 
 #include "gemmini/common.hpp"
+#include "utils/aligned_allocator.hpp"
 
 BEGIN_NS(gemmini)
 
@@ -18,6 +21,12 @@ class Vector;
 using MatrixPtr = std::shared_ptr<Matrix>;
 using VectorPtr = std::shared_ptr<Vector>;
 
+// Element storage, 64-byte aligned so SIMD kernels can use aligned loads
+using ElementBuffer = std::vector<int16_t, AlignedAllocator<int16_t>>;
+
+// Elements per cache line
+constexpr uint32_t kElemsPerCacheLine = kCacheLineBytes / sizeof(int16_t);
+
 // Simple Vector class for data storage and manipulation
 class Vector {
 public:
@@ -38,6 +47,10 @@ public:
     // Fill with zeros
     void fillZero() { std::fill(mData.begin(), mData.end(), 0); }
 
+    // Raw aligned storage
+    int16_t* Data() { return mData.data(); }
+    const int16_t* Data() const { return mData.data(); }
+
     friend std::ostream & operator<<(std::ostream & os, const Vector & vec) {
         os << "[";
         for (size_t i = 0; i < vec.Size(); ++i) {
@@ -50,38 +63,178 @@ public:
     }
 
 private:
-    std::vector<int16_t> mData;
+    ElementBuffer mData;
+};
+
+// Storage layout of a Matrix
+enum class MatrixLayout {
+    RowMajor,  // Plain row-major order
+    TileMajor, // Tiles stored contiguously, row-major inside each tile and across tiles
 };
 
 // Simple Matrix class for data storage and manipulation
 class Matrix {
 public:
+    // Read-only view of one tile, hides the storage layout of the parent matrix
+    class TileView {
+    public:
+        TileView(const Matrix* mat, uint32_t rowOffset, uint32_t colOffset, uint32_t rows,
+                 uint32_t cols, const int16_t* data, uint32_t ld)
+            : mMat(mat), mRowOffset(rowOffset), mColOffset(colOffset), mRows(rows), mCols(cols),
+              mData(data), mLd(ld) {}
+
+        // Valid extent of the tile (edge tiles can be smaller than the tile shape)
+        uint32_t Rows() const { return mRows; }
+        uint32_t Cols() const { return mCols; }
+
+        // Element access relative to the tile origin
+        int16_t At(uint32_t row, uint32_t col) const {
+            return mData ? mData[row * mLd + col] : mMat->At(mRowOffset + row, mColOffset + col);
+        }
+
+        // Contiguous tile storage, nullptr when the parent matrix is not tiled with this shape
+        const int16_t* Data() const { return mData; }
+        bool IsContiguous() const { return mData != nullptr; }
+
+    private:
+        const Matrix* mMat;
+        uint32_t mRowOffset;
+        uint32_t mColOffset;
+        uint32_t mRows;
+        uint32_t mCols;
+        const int16_t* mData;
+        uint32_t mLd;
+    };
+
     // Public member variables for direct access
     uint32_t rows;
     uint32_t cols;
     
-    // Constructor
-    Matrix(uint32_t rows, uint32_t cols) 
-        : rows(rows), cols(cols), mRows(rows), mCols(cols), mData(rows * cols, 0) {}
+    // Constructor. With padMultiple > 1 every row is padded to a multiple of padMultiple
+    // elements and of a cache line, so rows start 64-byte aligned and never split lines.
+    Matrix(uint32_t rows, uint32_t cols, uint32_t padMultiple = 1)
+        : rows(rows), cols(cols), mRows(rows), mCols(cols),
+          mStride(PaddedStride(cols, padMultiple)), mData(rows * mStride, 0) {}
     
     // Access operators with two naming styles for compatibility
-    int16_t & At(uint32_t row, uint32_t col) { return mData[row * mCols + col]; }
-    const int16_t & At(uint32_t row, uint32_t col) const { return mData[row * mCols + col]; }
+    int16_t & At(uint32_t row, uint32_t col) { return mData[Index(row, col)]; }
+    const int16_t & At(uint32_t row, uint32_t col) const { return mData[Index(row, col)]; }
     
-    int16_t & at(uint32_t row, uint32_t col) { return mData[row * mCols + col]; }
-    const int16_t & at(uint32_t row, uint32_t col) const { return mData[row * mCols + col]; }
+    int16_t & at(uint32_t row, uint32_t col) { return mData[Index(row, col)]; }
+    const int16_t & at(uint32_t row, uint32_t col) const { return mData[Index(row, col)]; }
 
     // Property getters with two naming styles for compatibility
     uint32_t Rows() const { return mRows; }
     uint32_t Cols() const { return mCols; }
     
     // Element access
-    int16_t get(uint32_t row, uint32_t col) const { return mData[row * mCols + col]; }
-    void set(uint32_t row, uint32_t col, int16_t value) { mData[row * mCols + col] = value; }
+    int16_t get(uint32_t row, uint32_t col) const { return mData[Index(row, col)]; }
+    void set(uint32_t row, uint32_t col, int16_t value) { mData[Index(row, col)] = value; }
     
     // Fill with zeros
     void fillZero() { std::fill(mData.begin(), mData.end(), 0); }
 
+    // Leading dimension (elements between the starts of consecutive rows, row-major only)
+    uint32_t Stride() const { return mStride; }
+    uint32_t LeadingDim() const { return mStride; }
+
+    // Start of a row in row-major storage, nullptr when the matrix is tile-major
+    int16_t* RowData(uint32_t row) {
+        return mLayout == MatrixLayout::RowMajor ? &mData[static_cast<size_t>(row) * mStride]
+                                                 : nullptr;
+    }
+    const int16_t* RowData(uint32_t row) const {
+        return mLayout == MatrixLayout::RowMajor ? &mData[static_cast<size_t>(row) * mStride]
+                                                 : nullptr;
+    }
+
+    // Copy one row into dst (at least Cols() elements), contiguous when row-major
+    void CopyRow(uint32_t row, int16_t* dst) const {
+        if (const int16_t* src = RowData(row)) {
+            std::copy(src, src + mCols, dst);
+            return;
+        }
+        for (uint32_t c = 0; c < mCols; ++c) {
+            dst[c] = At(row, c);
+        }
+    }
+
+    // Row stride for cols columns padded to padMultiple elements and a whole cache line
+    static uint32_t PaddedStride(uint32_t cols, uint32_t padMultiple) {
+        if (padMultiple <= 1) {
+            return cols;
+        }
+        uint32_t multiple = std::lcm(padMultiple, kElemsPerCacheLine);
+        return (cols + multiple - 1) / multiple * multiple;
+    }
+
+    // Layout information
+    MatrixLayout Layout() const { return mLayout; }
+    uint32_t TileRows() const { return mTileRows; }
+    uint32_t TileCols() const { return mTileCols; }
+    bool IsTileMajor(uint32_t tileRows, uint32_t tileCols) const {
+        return mLayout == MatrixLayout::TileMajor && mTileRows == tileRows &&
+               mTileCols == tileCols;
+    }
+
+    // Re-store the data tile-major with the given tile shape. Edge tiles are zero padded
+    // to the full tile shape so every tile occupies tileRows * tileCols elements. The new
+    // storage comes from the same arena or heap as the old.
+    void ToTileMajor(uint32_t tileRows, uint32_t tileCols) {
+        if (tileRows == 0 || tileCols == 0 || IsTileMajor(tileRows, tileCols)) {
+            return;
+        }
+        uint32_t tilesPerRow = (mCols + tileCols - 1) / tileCols;
+        uint32_t tilesPerCol = (mRows + tileRows - 1) / tileRows;
+        ElementBuffer tiled(tilesPerRow * tilesPerCol * tileRows * tileCols, 0,
+                            mData.get_allocator());
+        for (uint32_t r = 0; r < mRows; ++r) {
+            for (uint32_t c = 0; c < mCols; ++c) {
+                uint32_t tile = (r / tileRows) * tilesPerRow + c / tileCols;
+                tiled[tile * tileRows * tileCols + (r % tileRows) * tileCols + c % tileCols] =
+                    At(r, c);
+            }
+        }
+        mData.swap(tiled);
+        mLayout = MatrixLayout::TileMajor;
+        mTileRows = tileRows;
+        mTileCols = tileCols;
+        mTilesPerRow = tilesPerRow;
+    }
+
+    // Re-store the data in plain row-major order, keeping the padded stride
+    void ToRowMajor() {
+        if (mLayout == MatrixLayout::RowMajor) {
+            return;
+        }
+        ElementBuffer flat(static_cast<size_t>(mRows) * mStride, 0, mData.get_allocator());
+        for (uint32_t r = 0; r < mRows; ++r) {
+            for (uint32_t c = 0; c < mCols; ++c) {
+                flat[static_cast<size_t>(r) * mStride + c] = At(r, c);
+            }
+        }
+        mData.swap(flat);
+        mLayout = MatrixLayout::RowMajor;
+        mTileRows = 0;
+        mTileCols = 0;
+        mTilesPerRow = 0;
+    }
+
+    // View of tile (tileRow, tileCol) for the given tile shape. The view is contiguous
+    // (no copy needed) when the matrix is already tile-major with the same shape.
+    TileView Tile(uint32_t tileRow, uint32_t tileCol, uint32_t tileRows,
+                  uint32_t tileCols) const {
+        uint32_t rowOffset = tileRow * tileRows;
+        uint32_t colOffset = tileCol * tileCols;
+        uint32_t validRows = rowOffset < mRows ? std::min(tileRows, mRows - rowOffset) : 0;
+        uint32_t validCols = colOffset < mCols ? std::min(tileCols, mCols - colOffset) : 0;
+        const int16_t* data = nullptr;
+        if (IsTileMajor(tileRows, tileCols) && validRows > 0 && validCols > 0) {
+            data = &mData[(tileRow * mTilesPerRow + tileCol) * tileRows * tileCols];
+        }
+        return TileView(this, rowOffset, colOffset, validRows, validCols, data, tileCols);
+    }
+
     friend std::ostream & operator<<(std::ostream & os, const Matrix & mat) {
         for (uint32_t r = 0; r < mat.Rows(); ++r) {
             os << "[";
@@ -100,12 +253,35 @@ public:
 private:
     uint32_t mRows;
     uint32_t mCols;
-    std::vector<int16_t> mData;
+    uint32_t mStride;
+    ElementBuffer mData;
+
+    // Layout state
+    MatrixLayout mLayout = MatrixLayout::RowMajor;
+    uint32_t mTileRows = 0;
+    uint32_t mTileCols = 0;
+    uint32_t mTilesPerRow = 0;
+
+    // Storage index of element (row, col) for the current layout
+    size_t Index(uint32_t row, uint32_t col) const {
+        if (mLayout == MatrixLayout::RowMajor) {
+            return static_cast<size_t>(row) * mStride + col;
+        }
+        size_t tile = static_cast<size_t>(row / mTileRows) * mTilesPerRow + col / mTileCols;
+        return tile * mTileRows * mTileCols + (row % mTileRows) * mTileCols + col % mTileCols;
+    }
 };
 
-// Create matrix shared pointer using standard library
+// Create matrix shared pointer; the object and its control block come from the current arena
 template <typename T, typename... Args> std::shared_ptr<T> CreateMatrixPtr(Args &&... args) {
-    return std::make_shared<T>(std::forward<Args>(args)...);
+    return std::allocate_shared<T>(AlignedAllocator<T>(), std::forward<Args>(args)...);
+}
+
+// Create a short-lived matrix or vector, such as a scratchpad tile, on the global heap. It
+// is freed with its last reference instead of staying in the current arena until a reset.
+template <typename T, typename... Args> std::shared_ptr<T> CreateTransientPtr(Args &&... args) {
+    ArenaScope heap(nullptr);
+    return CreateMatrixPtr<T>(std::forward<Args>(args)...);
 }
 
 END_NS(gemmini)
\ No newline at end of file
@@ -1,26 +1,173 @@
 // matrix_multiplier.cpp - Implementation of Matrix Multiplier for Gemmini using SPARTA
 #include "execute/matrix_multiplier.hpp"
+#include "utils/memory_footprint.hpp"
 #include "sparta/kernel/Scheduler.hpp"
 #include "sparta/kernel/SpartaHandler.hpp"
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 
 namespace gemmini {
 // Initialize static name
 const char MatrixMultiplier::name[] = "matrix_multiplier";
 
+// Tenant settings from the parameter vectors, missing entries take the defaults
+static std::vector<TenantConfig> TenantConfigs(const MatrixMultiplierParameterSet* params) {
+    const std::vector<uint32_t> & priorities = params->tenant_priorities;
+    const std::vector<uint32_t> & weights = params->tenant_weights;
+    std::vector<TenantConfig> tenants(std::max<size_t>(1, std::max(priorities.size(),
+                                                                   weights.size())));
+    for (size_t t = 0; t < tenants.size(); ++t) {
+        if (t < priorities.size()) {
+            tenants[t].priority = priorities[t];
+        }
+        if (t < weights.size()) {
+            tenants[t].weight = std::max(1u, weights[t]);
+        }
+    }
+    return tenants;
+}
+
 // MatrixMultiplier Constructor
 MatrixMultiplier::MatrixMultiplier(sparta::TreeNode* node,
                                    const MatrixMultiplierParameterSet* params)
     : sparta::Unit(node), mPortSet(node), mToSystolicWeights(node, "to_systolic_weights"),
       mToSystolicVector(node, "to_systolic_vector"),
       mFromSystolicResults(node, "from_systolic_results", sparta::SchedulingPhase::Tick, 0),
+      mToAccumulatorDrain(node, "to_accumulator_drain"),
+      mFromAccumulatorDrained(node, "from_accumulator_drained", sparta::SchedulingPhase::Tick,
+                              0),
       mUnitEventSet(node), mLogger(node, "matrix_multiplier", "Matrix Multiplier Log"),
-      mSystolicRows(params->systolic_rows), mSystolicCols(params->systolic_cols),
+      mSystolicRows(params->systolic_rows, "systolic_rows"),
+      mSystolicCols(params->systolic_cols, "systolic_cols"),
+      mScheduleDumpFile(params->schedule_dump_file), mCheckSchedules(params->check_schedules),
+      mClockCrossingCycles(params->clock_crossing_cycles),
+      mPreemption(params->preemption), mPreemptSaveCycles(params->preempt_save_cycles),
+      mPreemptRestoreCycles(params->preempt_restore_cycles), mArbiter(TenantConfigs(params)),
       mTotalMms(getStatisticSet(), "total_mms", "Count of matrix multiplications",
                 sparta::Counter::COUNT_NORMAL),
       mTotalBlocks(getStatisticSet(), "total_blocks", "Count of block operations",
-                   sparta::Counter::COUNT_NORMAL) {
+                   sparta::Counter::COUNT_NORMAL),
+      mRejectedSchedules(getStatisticSet(), "rejected_schedules",
+                         "Count of schedules rejected by the static checker",
+                         sparta::Counter::COUNT_NORMAL),
+      mPreemptions(getStatisticSet(), "preemptions",
+                   "Count of requests preempted at a tile boundary",
+                   sparta::Counter::COUNT_NORMAL),
+      mSaveCycles(getStatisticSet(), "preempt_save_cycles",
+                  "Cycles spent saving preempted requests", sparta::Counter::COUNT_NORMAL),
+      mRestoreCycles(getStatisticSet(), "preempt_restore_cycles",
+                     "Cycles spent restoring preempted requests", sparta::Counter::COUNT_NORMAL),
+      mDramReadBytes(getStatisticSet(), "dram_read_bytes", "Bytes read from DRAM by the DMA",
+                     sparta::Counter::COUNT_NORMAL),
+      mDramWriteBytes(getStatisticSet(), "dram_write_bytes", "Bytes written to DRAM by the DMA",
+                      sparta::Counter::COUNT_NORMAL),
+      mDrainStalls(getStatisticSet(), "drain_stalls",
+                   "Times a compute or completion waited for an accumulator region to drain",
+                   sparta::Counter::COUNT_NORMAL),
+      mExposedDrainCycles(getStatisticSet(), "exposed_drain_cycles",
+                          "Cycles spent waiting for accumulator regions to drain",
+                          sparta::Counter::COUNT_NORMAL),
+      mHostCommands(getStatisticSet(), "host_commands", "Commands issued by the host",
+                    sparta::Counter::COUNT_NORMAL),
+      mHostWaitCycles(getStatisticSet(), "host_wait_cycles",
+                      "Cycles the schedule waited for the host to issue its next command",
+                      sparta::Counter::COUNT_NORMAL),
+      mHostQueueFullCycles(getStatisticSet(), "host_queue_full_cycles",
+                           "Cycles the host waited for room in the command queue",
+                           sparta::Counter::COUNT_NORMAL),
+      mHostFenceCycles(getStatisticSet(), "host_fence_cycles",
+                       "Cycles spent in fences at the end of multiplications",
+                       sparta::Counter::COUNT_NORMAL),
+      mDmaWaitCycles(getStatisticSet(), "dma_wait_cycles",
+                     "Cycles the schedule waited for DMA loads and stores to land",
+                     sparta::Counter::COUNT_NORMAL),
+      mResumeEvent(&getEventSet(), "resume_event",
+                   CREATE_SPARTA_HANDLER(MatrixMultiplier, ExecuteSchedule)) {
+    // Memory configuration the static schedule checker works against
+    mMemoryConfig.scratchpad_bytes = uint64_t(params->scratchpad_kb) * 1024;
+    mMemoryConfig.scratchpad_banks = params->scratchpad_banks;
+    mMemoryConfig.accumulator_bytes = uint64_t(params->accumulator_kb) * 1024;
+    mMemoryConfig.dma_bytes_per_cycle = params->dma_bytes_per_cycle;
+    mHostConfig.issue_cycles = params->host_issue_cycles;
+    mHostConfig.queue_depth = params->host_queue_depth;
+    mHostConfig.fence_cycles = params->host_fence_cycles;
+    if (!ParseMxElement(params->operand_format, mMemoryConfig.operand_format.element)) {
+        std::cerr << "Unknown operand format '" << std::string(params->operand_format)
+                  << "', using int16" << std::endl;
+    }
+    if (params->mx_block_size == 16 || params->mx_block_size == 32) {
+        mMemoryConfig.operand_format.block_size = params->mx_block_size;
+    } else {
+        std::cerr << "MX block size must be 16 or 32, using 32" << std::endl;
+    }
+    mMemoryConfig.int4_weights = params->int4_weights;
+    if (mMemoryConfig.int4_weights && mMemoryConfig.operand_format.Enabled()) {
+        std::cerr << "int4 weights cannot be combined with MX operands, using "
+                  << MxElementName(mMemoryConfig.operand_format.element) << std::endl;
+        mMemoryConfig.int4_weights = false;
+    }
+    // A build profile fixes the PEs' weight width, so weights are packed to match it
+    if (Profile::kWeightWidth != kProfileNotFixed &&
+        mMemoryConfig.int4_weights != (Profile::kWeightWidth == 4)) {
+        std::cerr << "The " << Profile::kName << " build profile fixes weight_width to "
+                  << Profile::kWeightWidth << ", "
+                  << (mMemoryConfig.int4_weights ? "ignoring" : "enabling") << " int4_weights"
+                  << std::endl;
+        mMemoryConfig.int4_weights = Profile::kWeightWidth == 4;
+        if (mMemoryConfig.int4_weights && mMemoryConfig.operand_format.Enabled()) {
+            std::cerr << "int4 weights cannot be combined with MX operands, using int16"
+                      << std::endl;
+            mMemoryConfig.operand_format.element = MxElement::None;
+        }
+    }
+    if (mMemoryConfig.int4_weights && params->int4_dual_mac) {
+        mMemoryConfig.weights_per_pe = 2;
+    }
+
+    // The DRAM trace is only written when asked for
+    if (!std::string(params->dram_trace_file).empty()) {
+        DramTraceConfig trace;
+        trace.path = params->dram_trace_file;
+        trace.burst_bytes = params->dram_burst_bytes;
+        trace.bytes_per_cycle = params->dma_bytes_per_cycle;
+        if (!ParseDramTraceFormat(params->dram_trace_format, trace.format)) {
+            std::cerr << "Unknown DRAM trace format '" << std::string(params->dram_trace_format)
+                      << "', using dramsim3" << std::endl;
+        }
+        mDramTrace.reset(new DramTraceWriter(trace));
+    }
+    if (params->dram_image) {
+        mDram.reset(new SparseMemory(uint64_t(params->dram_page_kb) * 1024));
+    }
+
+    // One request queue and set of statistics per tenant
+    mQueues.resize(mArbiter.NumTenants());
+    mHosts.assign(mArbiter.NumTenants(), HostInterface(mHostConfig));
+    mTenantStats.resize(mArbiter.NumTenants());
+    for (size_t t = 0; t < mTenantStats.size(); ++t) {
+        std::string prefix = "tenant_" + std::to_string(t) + "_";
+        std::string tenant = "tenant " + std::to_string(t);
+        TenantStats & stats = mTenantStats[t];
+        stats.requests.reset(new sparta::Counter(getStatisticSet(), prefix + "requests",
+                                                 "Requests completed for " + tenant,
+                                                 sparta::Counter::COUNT_NORMAL));
+        stats.tiles.reset(new sparta::Counter(getStatisticSet(), prefix + "tiles",
+                                              "Tiles granted to " + tenant,
+                                              sparta::Counter::COUNT_NORMAL));
+        stats.latency.reset(new sparta::Counter(getStatisticSet(), prefix + "latency_cycles",
+                                                "Total request latency of " + tenant,
+                                                sparta::Counter::COUNT_NORMAL));
+        stats.max_latency.reset(new sparta::Counter(getStatisticSet(),
+                                                    prefix + "max_latency_cycles",
+                                                    "Longest request latency of " + tenant,
+                                                    sparta::Counter::COUNT_LATEST));
+        stats.avg_latency.reset(new sparta::StatisticDef(
+            getStatisticSet(), prefix + "avg_latency_cycles", getStatisticSet(),
+            "Average request latency of " + tenant,
+            prefix + "latency_cycles / " + prefix + "requests"));
+    }
+
     // Register port handlers
     mPortSet.in_matrix_a.registerConsumerHandler(
         CREATE_SPARTA_HANDLER_WITH_DATA(MatrixMultiplier, HandleMatrixA, MatrixPtr));
@@ -29,21 +176,74 @@ MatrixMultiplier::MatrixMultiplier(sparta::TreeNode* node,
     mPortSet.in_control.registerConsumerHandler(
         CREATE_SPARTA_HANDLER_WITH_DATA(MatrixMultiplier, HandleControl, uint32_t));
     mFromSystolicResults.registerConsumerHandler(
-        CREATE_SPARTA_HANDLER_WITH_DATA(MatrixMultiplier, HandleSystolicResults, MatrixPtr));
+        CREATE_SPARTA_HANDLER_WITH_DATA(MatrixMultiplier, HandleSystolicResults, WaveSumsPtr));
+    mFromAccumulatorDrained.registerConsumerHandler(
+        CREATE_SPARTA_HANDLER_WITH_DATA(MatrixMultiplier, HandleDrained, uint32_t));
 
-    // Create systolic array child
-    sparta::TreeNode* systolicNode = new sparta::TreeNode(node, "systolic_array", "Systolic Array");
+    // Load the schedule to replay, if any
+    if (!std::string(params->schedule_file).empty()) {
+        mReplaySchedule = TileSchedule::LoadFromFile(params->schedule_file);
+    }
+
+    // Create the accumulator, normally placed in the scratchpad clock domain by the simulation
+    {
+        FootprintScope footprint("Accumulator");
+        sparta::TreeNode* accNode = node->getChild("accumulator", false);
+        if (!accNode) {
+            accNode = new sparta::TreeNode(node, "accumulator", "Accumulator");
+        }
+        auto accParams = new AccumulatorParameterSet(accNode);
+        Accumulator::Factory accFactory;
+        Accumulator* accumulator =
+            static_cast<Accumulator*>(accFactory.createResource(accNode, accParams));
+        mAccumulator = accumulator;
+        mAccRegions = accumulator->NumRegions();
+
+        if (accNode->getClock() != node->getClock()) {
+            accumulator->GetPortSet().in_drain.setPortDelay(
+                static_cast<sparta::Clock::Cycle>(params->clock_crossing_cycles));
+            mFromAccumulatorDrained.setPortDelay(
+                static_cast<sparta::Clock::Cycle>(params->clock_crossing_cycles));
+        }
+        mToAccumulatorDrain.bind(accumulator->GetPortSet().in_drain);
+        mFromAccumulatorDrained.bind(accumulator->GetPortSet().out_drained);
+    }
+
+    // Host memory taken by the array unit, its PEs are measured separately
+    FootprintScope footprint("SystolicArray");
+
+    // Create systolic array child unless the simulation placed it in its own clock domain
+    sparta::TreeNode* systolicNode = node->getChild("systolic_array", false);
+    if (!systolicNode) {
+        systolicNode = new sparta::TreeNode(node, "systolic_array", "Systolic Array");
+    }
 
     // Create systolic array parameter set
     auto paramsForSystolic = new SystolicArrayParameterSet(systolicNode);
 
-    // No need to manually set parameters - they have default values
+    // No need to manually set parameters - they have default values, except that int4
+    // weights switch the PEs to nibble MACs
+    if (mMemoryConfig.int4_weights) {
+        paramsForSystolic->weight_width = 4;
+        paramsForSystolic->macs_per_cycle = mMemoryConfig.weights_per_pe;
+    }
 
     // Create systolic array resource
     SystolicArray::Factory systolicFactory;
     SystolicArray* systolicArray = static_cast<SystolicArray*>(
         systolicFactory.createResource(systolicNode, paramsForSystolic));
 
+    // Ports between different clock domains pay the synchronizer latency, counted in
+    // cycles of the receiving side
+    if (systolicNode->getClock() != node->getClock()) {
+        systolicArray->GetPortSet().in_weights.setPortDelay(
+            static_cast<sparta::Clock::Cycle>(params->clock_crossing_cycles));
+        systolicArray->GetPortSet().in_vector.setPortDelay(
+            static_cast<sparta::Clock::Cycle>(params->clock_crossing_cycles));
+        mFromSystolicResults.setPortDelay(
+            static_cast<sparta::Clock::Cycle>(params->clock_crossing_cycles));
+    }
+
     // Connect ports
     mToSystolicWeights.bind(systolicArray->GetPortSet().in_weights);
     mToSystolicVector.bind(systolicArray->GetPortSet().in_vector);
@@ -73,178 +273,944 @@ void MatrixMultiplier::HandleControl(const uint32_t & signal) {
     std::cout << "Received control signal: " << signal << std::endl;
 #endif
 
-    // If it's a start signal, start matrix multiplication
+    // If it's a start signal, queue the multiplication for the default tenant
     if (signal == 1 && mMatrixA && mMatrixB) {
-        StartMultiplication();
+        Multiply(mMatrixA, mMatrixB);
     }
 }
 
-// Multiply two matrices - direct method for simulation
-void MatrixMultiplier::Multiply(const MatrixPtr & a, const MatrixPtr & b) {
-    // Pass matrices to the port handlers
-    HandleMatrixA(a);
-    HandleMatrixB(b);
+// Queue a multiplication - direct method for simulation
+uint64_t MatrixMultiplier::Multiply(const MatrixPtr & a, const MatrixPtr & b,
+                                    const TileSchedulePtr & schedule, uint32_t tenant) {
+    if (tenant >= mQueues.size()) {
+        std::cerr << "Unknown tenant " << tenant << ", " << mQueues.size()
+                  << " tenant(s) are configured" << std::endl;
+        return 0;
+    }
+
+    RequestPtr request = CreateRequest(a, b, schedule, tenant);
+    if (!request) {
+        return 0;
+    }
+    mQueues[tenant].push_back(request);
+    mHosts[tenant].Submit(request->enqueue_cycle);
+
+    // Update statistics
+    mTotalMms++;
 
-    // Start multiplication process
-    StartMultiplication();
+    // An idle multiplier starts right away, a busy one picks the request up at a tile boundary
+    if (!mBusy) {
+        Dispatch();
+    }
+    return request->id;
 }
 
-// Start the matrix multiplication process
-void MatrixMultiplier::StartMultiplication() {
-    if (mBusy) {
-#ifdef DEBUG_MATRIX_MULTIPLIER
-        std::cout << "Matrix multiplier is busy, ignoring new multiplication request" << std::endl;
-#endif
+// Apply a runtime knob, parameters are frozen once the tree is finalized
+bool MatrixMultiplier::SetKnob(const std::string & knob, uint64_t value) {
+    if (knob == "preemption") {
+        mPreemption = value != 0;
+    } else if (knob == "preempt_save_cycles") {
+        mPreemptSaveCycles = static_cast<uint32_t>(value);
+    } else if (knob == "preempt_restore_cycles") {
+        mPreemptRestoreCycles = static_cast<uint32_t>(value);
+    } else if (knob == "dma_bytes_per_cycle") {
+        mMemoryConfig.dma_bytes_per_cycle = std::max<uint32_t>(1, static_cast<uint32_t>(value));
+        if (mDramTrace) {
+            mDramTrace->SetBytesPerCycle(mMemoryConfig.dma_bytes_per_cycle);
+        }
+    } else if (knob == "host_issue_cycles" || knob == "host_queue_depth" ||
+               knob == "host_fence_cycles") {
+        uint32_t setting = static_cast<uint32_t>(value);
+        if (knob == "host_issue_cycles") {
+            mHostConfig.issue_cycles = setting;
+        } else if (knob == "host_queue_depth") {
+            mHostConfig.queue_depth = setting;
+        } else {
+            mHostConfig.fence_cycles = setting;
+        }
+        for (auto & host : mHosts) {
+            host.SetConfig(mHostConfig);
+        }
+    } else {
+        return mAccumulator && mAccumulator->SetKnob(knob, value);
+    }
+    return true;
+}
+
+// The writer thread does not survive fork(), and the parent still owns the trace file. Leave
+// the parent's writer untouched and record the rest of the run to "<file>.<suffix>".
+void MatrixMultiplier::RestartDramTrace(const std::string & suffix) {
+    if (!mDramTrace) {
         return;
     }
+    DramTraceConfig config = mDramTrace->Config();
+    config.path += "." + suffix;
+    (void)mDramTrace.release();
+    mDramTrace.reset(new DramTraceWriter(config));
+    mDramTrace->SetBytesPerCycle(mMemoryConfig.dma_bytes_per_cycle);
+}
+
+void MatrixMultiplier::CloseDramTrace() {
+    if (mDramTrace) {
+        mDramTrace->Close();
+    }
+}
+
+// Plan the request the way CreateRequest would and let the static checker time it
+uint64_t MatrixMultiplier::EstimateCycles(uint32_t m, uint32_t k, uint32_t n) const {
+    TileSchedulePtr schedule =
+        TileSchedule::Plan(m, k, n, mSystolicRows, mSystolicCols, WeightTileRows());
+    return ScheduleChecker(CheckerConfig(), mHostConfig).Check(*schedule).estimated_cycles;
+}
+
+// Size what CreateRequest and the schedule's operations allocate for the request. Host
+// matrices hold int16 elements whatever the operand format; MX and int4 weights add the
+// quantized copies and the block scales instead.
+void MatrixMultiplier::EstimateHostBytes(uint32_t m, uint32_t k, uint32_t n, uint64_t & buffers,
+                                         uint64_t & payloads) const {
+    const MxFormat & format = mMemoryConfig.operand_format;
+    const uint64_t elem = sizeof(int16_t);
+    const uint64_t rows = mSystolicRows;
+    const uint64_t cols = mSystolicCols;
+    const uint64_t kTile = WeightTileRows();
+    TileSchedulePtr schedule = TileSchedule::Plan(m, k, n, mSystolicRows, mSystolicCols, kTile);
+
+    // Scratchpad buffers hold a full A row block or one B tile; accumulator tiles hold the
+    // 32-bit sums, and the FP32 scaled sums too with MX
+    uint64_t spadTile = std::max(rows * k, kTile * cols) * elem;
+    uint64_t accTile = rows * cols * (sizeof(int32_t) + (format.Enabled() ? sizeof(float) : 0));
+    buffers = schedule->NumBuffers() * spadTile + schedule->NumAccBuffers() * accTile;
+
+    // The compute in flight: the preloaded weights, one vector per A row and MX pass, and the
+    // sums they return
+    uint64_t passes = format.Enabled() ? std::min<uint64_t>(kTile, format.Blocks(kTile) + 1) : 1;
+    uint64_t lanes = (kTile + mMemoryConfig.weights_per_pe - 1) / mMemoryConfig.weights_per_pe;
+    buffers += kTile * cols * elem + passes * rows * (lanes * elem + cols * sizeof(int32_t));
+
+    // A; the request's row-major copy of B and its tile-major replacement, both left in the
+    // job arena; the result padded to the array width
+    uint64_t tiledK = (k + kTile - 1) / kTile * kTile;
+    uint64_t tiledN = (n + cols - 1) / cols * cols;
+    payloads = (uint64_t(m) * k + uint64_t(k) * n + tiledK * tiledN + m * tiledN) * elem;
+    if (format.Enabled() || mMemoryConfig.int4_weights) {
+        // Quantized A, with one scale per MX block of every row of A and column of B
+        payloads += uint64_t(m) * k * elem;
+        if (format.Enabled()) {
+            payloads += (uint64_t(m) + n) * format.Blocks(k) * sizeof(int32_t);
+        }
+    }
 
+    // DRAM image pages for A, the B tiles and the 32-bit results
+    if (mDram) {
+        uint64_t page = mDram->PageBytes();
+        for (uint64_t bytes : {uint64_t(m) * k * elem, tiledK * tiledN * elem,
+                               uint64_t(m) * n * sizeof(int32_t)}) {
+            payloads += (bytes + page - 1) / page * page;
+        }
+    }
+}
+
+// Check the operands and pick the schedule for a new request
+MatrixMultiplier::RequestPtr MatrixMultiplier::CreateRequest(const MatrixPtr & a,
+                                                             const MatrixPtr & b,
+                                                             const TileSchedulePtr & schedule,
+                                                             uint32_t tenant) {
     // Check compatibility of matrices
-    if (mMatrixA->Cols() != mMatrixB->Rows()) {
-        std::cerr << "Matrix dimensions incompatible for multiplication: " << mMatrixA->Rows()
-                  << "x" << mMatrixA->Cols() << " * " << mMatrixB->Rows() << "x" << mMatrixB->Cols()
-                  << std::endl;
+    if (a->Cols() != b->Rows()) {
+        std::cerr << "Matrix dimensions incompatible for multiplication: " << a->Rows() << "x"
+                  << a->Cols() << " * " << b->Rows() << "x" << b->Cols() << std::endl;
+        return nullptr;
+    }
+
+    // Replay a given schedule when there is one, plan a new one otherwise
+    TileSchedulePtr chosen = schedule ? schedule : mReplaySchedule;
+    if (chosen && !chosen->Matches(a->Rows(), a->Cols(), b->Cols(), mSystolicRows,
+                                   mSystolicCols, WeightTileRows())) {
+        std::cerr << "Tile schedule for " << chosen->M() << "x" << chosen->K() << "x"
+                  << chosen->N() << " on " << chosen->TileRows() << "x" << chosen->TileCols()
+                  << " does not match the requested multiplication" << std::endl;
+        return nullptr;
+    }
+    if (chosen && mCheckSchedules) {
+        // Reject bad external schedules before spending simulation time on them
+        ScheduleReport report = ScheduleChecker(CheckerConfig(), mHostConfig).Check(*chosen);
+        if (!report.ok) {
+            std::cerr << "Tile schedule rejected by static check:" << std::endl << report;
+            mRejectedSchedules++;
+            return nullptr;
+        }
+    }
+    if (!chosen) {
+        chosen = TileSchedule::Plan(a->Rows(), a->Cols(), b->Cols(), mSystolicRows,
+                                    mSystolicCols, WeightTileRows());
+        if (!mScheduleDumpFile.empty()) {
+            chosen->SaveToFile(mScheduleDumpFile);
+        }
+    }
+
+    RequestPtr request = std::make_shared<MultiplyRequest>();
+    request->id = mNextRequestId++;
+    request->tenant = tenant;
+    request->a = a;
+    request->b = b;
+    if (mMemoryConfig.operand_format.Enabled() || mMemoryConfig.int4_weights) {
+        QuantizeOperands(*request);
+    }
+
+    // Store B tile-major once at load time so each weight tile is contiguous. The caller's
+    // B keeps its layout; quantization already made a copy the request owns.
+    if (request->b == b) {
+        request->b = CreateMatrixPtr<Matrix>(*b);
+    }
+    request->b->ToTileMajor(WeightTileRows(), mSystolicCols);
+    request->schedule = chosen;
+    request->spad_buffers.assign(chosen->NumBuffers(), nullptr);
+    request->spad_ready.assign(chosen->NumBuffers(), 0);
+    request->acc_buffers.assign(chosen->NumAccBuffers(), nullptr);
+    request->enqueue_cycle = getClock()->currentCycle();
+
+    // Place the operands, the result and room for a saved context in DRAM
+    uint64_t accBytes = request->acc_buffers.size() * mSystolicRows * mSystolicCols *
+                        mMemoryConfig.acc_element_bytes;
+    request->a_address = AllocateDram(uint64_t(a->Rows()) * a->Cols() *
+                                      mMemoryConfig.element_bytes);
+    request->b_address = AllocateDram(uint64_t(b->Rows()) * b->Cols() *
+                                      mMemoryConfig.element_bytes);
+    request->result_address = AllocateDram(uint64_t(a->Rows()) * b->Cols() *
+                                           mMemoryConfig.acc_element_bytes);
+    request->context_address = AllocateDram(accBytes);
+    if (mDram) {
+        WriteOperands(*request);
+    }
+
+    // Initialize result matrix with rows padded to the array width
+    request->result = CreateMatrixPtr<Matrix>(a->Rows(), b->Cols(), mSystolicCols);
+    return request;
+}
+
+// Round A and B to the operand formats. With int4 weights, activations saturate to int8
+// and weights to int4. With an MX format every row of A and column of B is split into
+// blocks of block_size along K, each with its own scale; the mesh gets the elements in fixed
+// point and the accumulator applies the scales to each block's partial sums.
+void MatrixMultiplier::QuantizeOperands(MultiplyRequest & request) const {
+    const MxFormat & format = mMemoryConfig.operand_format;
+    const Matrix & a = *request.a;
+    const Matrix & b = *request.b;
+    uint32_t k = a.Cols();
+
+    if (mMemoryConfig.int4_weights) {
+        uint64_t saturatedActs = 0;
+        MatrixPtr activations = CreateMatrixPtr<Matrix>(a.Rows(), k);
+        for (uint32_t r = 0; r < a.Rows(); ++r) {
+            for (uint32_t i = 0; i < k; ++i) {
+                activations->At(r, i) = SaturateInt(a.At(r, i), 8);
+                saturatedActs += activations->At(r, i) != a.At(r, i);
+            }
+        }
+        uint64_t saturatedWeights = 0;
+        MatrixPtr weights = CreateMatrixPtr<Matrix>(k, b.Cols());
+        for (uint32_t i = 0; i < k; ++i) {
+            for (uint32_t c = 0; c < b.Cols(); ++c) {
+                weights->At(i, c) = SaturateInt(b.At(i, c), 4);
+                saturatedWeights += weights->At(i, c) != b.At(i, c);
+            }
+        }
+        if (saturatedActs > 0 || saturatedWeights > 0) {
+            std::cerr << "Request " << request.id << ": " << saturatedActs
+                      << " activations saturated to int8 and " << saturatedWeights
+                      << " weights saturated to int4" << std::endl;
+        }
+        request.a = activations;
+        request.b = weights;
         return;
     }
+    std::vector<double> values(k);
+    std::vector<int16_t> fixed(k);
+    const uint32_t blocks = format.Blocks(k);
+    request.mx_blocks = blocks;
+
+    MatrixPtr quantizedA = CreateMatrixPtr<Matrix>(a.Rows(), k);
+    request.a_scales.resize(size_t(a.Rows()) * blocks);
+    for (uint32_t r = 0; r < a.Rows(); ++r) {
+        for (uint32_t i = 0; i < k; ++i) {
+            values[i] = a.At(r, i);
+        }
+        for (uint32_t blk = 0; blk < blocks; ++blk) {
+            uint32_t begin = blk * format.block_size;
+            request.a_scales[size_t(r) * blocks + blk] =
+                format.QuantizeBlock(values.data() + begin, std::min(format.block_size, k - begin),
+                                     quantizedA->RowData(r) + begin);
+        }
+    }
+
+    MatrixPtr quantizedB = CreateMatrixPtr<Matrix>(k, b.Cols());
+    request.b_scales.resize(size_t(blocks) * b.Cols());
+    for (uint32_t c = 0; c < b.Cols(); ++c) {
+        for (uint32_t i = 0; i < k; ++i) {
+            values[i] = b.At(i, c);
+        }
+        for (uint32_t blk = 0; blk < blocks; ++blk) {
+            uint32_t begin = blk * format.block_size;
+            request.b_scales[size_t(blk) * b.Cols() + c] =
+                format.QuantizeBlock(values.data() + begin, std::min(format.block_size, k - begin),
+                                     fixed.data() + begin);
+        }
+        for (uint32_t i = 0; i < k; ++i) {
+            quantizedB->At(i, c) = fixed[i];
+        }
+    }
+
+    request.a = quantizedA;
+    request.b = quantizedB;
+}
+
+// Grant the array to the next tenant for one tile, or go idle when no work is queued.
+// Switching away from an unfinished request saves its state and resuming it restores it;
+// both cost cycles before the next tile can start.
+void MatrixMultiplier::Dispatch() {
+    RequestPtr next = mActive;
+    if (!next || mPreemption) {
+        std::vector<bool> ready(mQueues.size());
+        for (size_t t = 0; t < mQueues.size(); ++t) {
+            ready[t] = !mQueues[t].empty();
+        }
+
+        int tenant = mArbiter.Grant(ready);
+        if (tenant < 0) {
+            mBusy = false;
+            mActive.reset();
+            return;
+        }
+        next = mQueues[tenant].front();
+    }
+
+    uint64_t switchCycles = 0;
+    if (mActive && next != mActive) {
+        // Save the tile iterator, control state and live accumulator contents
+        uint64_t cycles = ContextCycles(*mActive, mPreemptSaveCycles, {});
+        RecordContext(*mActive, true);
+        mActive->preempted = true;
+        mPreemptions++;
+        mSaveCycles += cycles;
+        switchCycles += cycles;
+    }
+    if (next->preempted) {
+        // Other requests reused the scratchpad, so the buffers the request still reads
+        // are reloaded along with its accumulator contents
+        std::vector<TileOp> reloads = next->schedule->LiveLoads(next->next_op);
+        uint64_t cycles = ContextCycles(*next, mPreemptRestoreCycles, reloads);
+        RecordContext(*next, false);
+        for (const auto & load : reloads) {
+            uint64_t address, bytes;
+            LoadExtent(*next, load, address, bytes);
+            next->spad_ready[load.buffer] = RecordDram(address, bytes, false);
+        }
+        next->preempted = false;
+        mRestoreCycles += cycles;
+        switchCycles += cycles;
+    }
+
+    mBusy = true;
+    mActive = next;
+    (*mTenantStats[mActive->tenant].tiles)++;
 
 #ifdef DEBUG_MATRIX_MULTIPLIER
-    std::cout << "Starting matrix multiplication: " << mMatrixA->Rows() << "x" << mMatrixA->Cols()
-              << " * " << mMatrixB->Rows() << "x" << mMatrixB->Cols() << std::endl;
+    std::cout << "Granting tile to tenant " << mActive->tenant << " (request " << mActive->id
+              << ") after " << switchCycles << " switch cycles" << std::endl;
 #endif
 
-    // Set busy flag
-    mBusy = true;
+    // Run the request until its next tile waits on the systolic array
+    if (switchCycles > 0) {
+        mResumeEvent.schedule(switchCycles);
+    } else {
+        ExecuteSchedule();
+    }
+}
+
+// Cycles to move a request's unstored accumulator results and the given scratchpad loads
+// through the DMA, plus a fixed cost
+uint64_t MatrixMultiplier::ContextCycles(const MultiplyRequest & request, uint32_t fixedCycles,
+                                         const std::vector<TileOp> & reloads) const {
+    uint64_t bytes = 0;
+    for (const auto & buffer : request.acc_buffers) {
+        if (buffer) {
+            bytes += uint64_t(buffer->rows) * buffer->cols * mMemoryConfig.acc_element_bytes;
+        }
+    }
+    for (const auto & load : reloads) {
+        uint64_t address, loadBytes;
+        LoadExtent(request, load, address, loadBytes);
+        bytes += loadBytes;
+    }
+    uint64_t bandwidth = DmaBytesPerCommandCycle();
+    return fixedCycles + (bytes + bandwidth - 1) / bandwidth;
+}
+
+// Bump-allocate a page-aligned DRAM region; addresses are only used to label the trace
+uint64_t MatrixMultiplier::AllocateDram(uint64_t bytes) {
+    uint64_t address = mNextDramAddress;
+    mNextDramAddress += (std::max<uint64_t>(bytes, 1) + 4095) / 4096 * 4096;
+    return address;
+}
 
-    // Reset block counters
-    mCurrentRowBlock = 0;
-    mCurrentColBlock = 0;
+// Count a DMA transfer, queue it on the DMA channel and add it to the trace. The channel
+// runs on the DRAM clock and serves transfers in order at dma_bytes_per_cycle per DRAM
+// cycle; the command side sees a transfer clock_crossing_cycles after the channel finishes
+// it. Returns the scheduler tick the transfer has landed at.
+uint64_t MatrixMultiplier::RecordDram(uint64_t address, uint64_t bytes, bool write) {
+    if (write) {
+        mDramWriteBytes += bytes;
+    } else {
+        mDramReadBytes += bytes;
+    }
+    const sparta::Clock* dramClock = mDramClock ? mDramClock : getClock();
+    uint64_t bandwidth = std::max(1u, mMemoryConfig.dma_bytes_per_cycle);
+    uint64_t now = getClock()->getScheduler()->getCurrentTick();
+    uint64_t start = std::max(now, mDmaFreeTick);
+    mDmaFreeTick = start + (bytes + bandwidth - 1) / bandwidth * dramClock->getPeriod();
+    if (mDramTrace) {
+        mDramTrace->Record(dramClock->getCycle(start), address, static_cast<uint32_t>(bytes),
+                           write);
+    }
+    uint64_t crossing = 0;
+    if (dramClock != getClock()) {
+        crossing = uint64_t(mClockCrossingCycles) * getClock()->getPeriod();
+    }
+    return mDmaFreeTick + crossing;
+}
 
-    // Calculate number of blocks needed
-    mTotalRowBlocks = (mMatrixA->Rows() + mSystolicRows - 1) / mSystolicRows;
-    mTotalColBlocks = (mMatrixB->Cols() + mSystolicCols - 1) / mSystolicCols;
+// DMA bandwidth in bytes per command clock cycle, for costs counted on the command clock
+uint32_t MatrixMultiplier::DmaBytesPerCommandCycle() const {
+    uint64_t bandwidth = std::max(1u, mMemoryConfig.dma_bytes_per_cycle);
+    if (!mDramClock) {
+        return static_cast<uint32_t>(bandwidth);
+    }
+    uint64_t dramPeriod = std::max<uint64_t>(1, mDramClock->getPeriod());
+    return static_cast<uint32_t>(
+        std::max<uint64_t>(1, bandwidth * getClock()->getPeriod() / dramPeriod));
+}
 
-    // Initialize result matrix
-    mResultMatrix = CreateMatrixPtr<Matrix>(mMatrixA->Rows(), mMatrixB->Cols());
+// Memory configuration for the static checker, which counts command clock cycles
+MemoryConfig MatrixMultiplier::CheckerConfig() const {
+    MemoryConfig config = mMemoryConfig;
+    config.dma_bytes_per_cycle = DmaBytesPerCommandCycle();
+    return config;
+}
 
-    // Start processing the first block
-    ProcessNextBlock();
+void MatrixMultiplier::SetDramClock(const sparta::Clock* clock) {
+    mDramClock = clock;
+}
 
-    // Update statistics
-    mTotalMms++;
+// DRAM address and size of the data a load moves into the scratchpad
+void MatrixMultiplier::LoadExtent(const MultiplyRequest & request, const TileOp & op,
+                                  uint64_t & address, uint64_t & bytes) const {
+    if (op.operand == TileOperand::A) {
+        uint32_t rowOffset = op.row_block * mSystolicRows;
+        uint32_t rows = std::min<uint32_t>(mSystolicRows, request.a->Rows() - rowOffset);
+        uint64_t rowBytes = mMemoryConfig.ActivationBytes(request.a->Cols());
+        address = request.a_address + rowOffset * rowBytes;
+        bytes = rows * rowBytes;
+        return;
+    }
+
+    // B tiles are contiguous because B is stored tile-major at load time
+    uint32_t weightRows = WeightTileRows();
+    uint32_t colTiles = (request.b->Cols() + mSystolicCols - 1) / mSystolicCols;
+    uint64_t tileIndex = uint64_t(op.k_block) * colTiles + op.col_block;
+    Matrix::TileView bTile =
+        request.b->Tile(op.k_block, op.col_block, weightRows, mSystolicCols);
+    uint64_t tileBytes = uint64_t(mSystolicCols) * mMemoryConfig.WeightBytes(weightRows);
+    address = request.b_address + tileIndex * tileBytes;
+    bytes = uint64_t(bTile.Cols()) * mMemoryConfig.WeightBytes(bTile.Rows());
+}
+
+// Save or restore the live accumulator buffers of a preempted request
+void MatrixMultiplier::RecordContext(const MultiplyRequest & request, bool write) {
+    uint64_t offset = 0;
+    for (const auto & buffer : request.acc_buffers) {
+        if (buffer) {
+            uint64_t bytes = uint64_t(buffer->rows) * buffer->cols *
+                             mMemoryConfig.acc_element_bytes;
+            RecordDram(request.context_address + offset, bytes, write);
+            offset += bytes;
+        }
+    }
 }
 
-// Process next block in the matrix multiplication
-void MatrixMultiplier::ProcessNextBlock() {
-    // Calculate block dimensions and offsets
-    uint32_t rowOffset = mCurrentRowBlock * mSystolicRows;
-    uint32_t colOffset = mCurrentColBlock * mSystolicCols;
+// Place A row-major and B in its tile-major order in the DRAM image
+void MatrixMultiplier::WriteOperands(const MultiplyRequest & request) {
+    const Matrix & a = *request.a;
+    uint64_t rowBytes = uint64_t(a.Cols()) * sizeof(int16_t);
+    std::vector<int16_t> row(a.Cols());
+    for (uint32_t r = 0; r < a.Rows(); ++r) {
+        a.CopyRow(r, row.data());
+        mDram->Write(request.a_address + r * rowBytes, row.data(), rowBytes);
+    }
 
-    uint32_t blockRows = std::min(mSystolicRows, mMatrixA->Rows() - rowOffset);
-    uint32_t blockCols = std::min(mSystolicCols, mMatrixB->Cols() - colOffset);
+    const Matrix & b = *request.b;
+    uint32_t weightRows = WeightTileRows();
+    uint32_t tileRows = (b.Rows() + weightRows - 1) / weightRows;
+    uint32_t tileCols = (b.Cols() + mSystolicCols - 1) / mSystolicCols;
+    uint64_t tileBytes = uint64_t(weightRows) * mSystolicCols * sizeof(int16_t);
+    for (uint32_t tr = 0; tr < tileRows; ++tr) {
+        for (uint32_t tc = 0; tc < tileCols; ++tc) {
+            Matrix::TileView tile = b.Tile(tr, tc, weightRows, mSystolicCols);
+            mDram->Write(request.b_address + (tr * tileCols + tc) * tileBytes, tile.Data(),
+                         tileBytes);
+        }
+    }
+}
+
+// Execute schedule operations of the active request until one has to wait for the array
+void MatrixMultiplier::ExecuteSchedule() {
+    MultiplyRequest & request = *mActive;
+    while (request.next_op < request.schedule->Size()) {
+        if (WaitForHost(request)) {
+            return;
+        }
+        const TileOp & op = (*request.schedule)[request.next_op++];
 
 #ifdef DEBUG_MATRIX_MULTIPLIER
-    std::cout << "Processing block [" << mCurrentRowBlock << "," << mCurrentColBlock
-              << "]: " << blockRows << "x" << blockCols << std::endl;
+        std::cout << "Executing " << op << std::endl;
 #endif
 
-    // Create weight matrix for this block (transposed portion of B)
-    MatrixPtr weights = CreateMatrixPtr<Matrix>(mSystolicRows, mSystolicCols);
-
-    // Fill weight matrix with transposed values from B
-    for (uint32_t r = 0; r < blockRows; ++r) {
-        for (uint32_t c = 0; c < blockCols; ++c) {
-            if (rowOffset + r < mMatrixA->Rows() && c < mMatrixB->Rows()) {
-                // Transpose during load
-                weights->At(r, c) = mMatrixB->At(c, colOffset + r);
+        bool ok = true;
+        switch (op.type) {
+        case TileOpType::Load:
+            ok = ExecuteLoad(op);
+            break;
+        case TileOpType::Preload:
+            // The weights have to be in the scratchpad before they shift into the array
+            if (WaitForDma(request.spad_ready[op.buffer])) {
+                --request.next_op;
+                return;
+            }
+            ok = ExecutePreload(op);
+            break;
+        case TileOpType::Compute:
+            // The tile needs an output region that is not still draining and its A rows
+            // in the scratchpad
+            if (mDrainsInFlight >= mAccRegions) {
+                --request.next_op;
+                WaitForDrain();
+                return;
+            }
+            if (WaitForDma(request.spad_ready[op.buffer])) {
+                --request.next_op;
+                return;
             }
+            ok = ExecuteCompute(op);
+            if (ok) {
+                // Continue once the array returns the results, which retires the command
+                return;
+            }
+            break;
+        case TileOpType::Store:
+            ok = ExecuteStore(op);
+            break;
+        }
+        mHosts[request.tenant].Retire(getClock()->currentCycle());
+
+        if (!ok) {
+            std::cerr << "Tile schedule operation " << request.next_op - 1 << " (" << op
+                      << ") reads an empty buffer, aborting multiplication" << std::endl;
+            DropActiveRequest();
+            Dispatch();
+            return;
         }
     }
 
-    // Send weights to systolic array
-    mToSystolicWeights.send(weights);
+    // All operations executed, the request is done once its results are out and the host's
+    // fence has seen them
+    if (mDrainsInFlight > 0) {
+        WaitForDrain();
+        return;
+    }
+    if (WaitForDma(request.stores_done)) {
+        return;
+    }
+    if (!request.fenced) {
+        request.fenced = true;
+        uint64_t now = getClock()->currentCycle();
+        uint64_t resume = mHosts[request.tenant].Fence(now);
+        if (resume > now) {
+            mHostFenceCycles += resume - now;
+            mResumeEvent.schedule(resume - now);
+            return;
+        }
+    }
+    RequestDone();
+}
 
-    // Create input vectors for this block (from A)
-    std::vector<VectorPtr> inputVectors;
+// Issue the request's next operation from its host; returns true when the schedule has to
+// wait for it to arrive and will resume then
+bool MatrixMultiplier::WaitForHost(MultiplyRequest & request) {
+    HostInterface & host = mHosts[request.tenant];
+    if (request.issued_ops <= request.next_op) {
+        uint64_t queueFull = host.QueueFullCycles();
+        request.issue_cycle = host.Issue();
+        request.issued_ops = request.next_op + 1;
+        mHostCommands++;
+        mHostQueueFullCycles += host.QueueFullCycles() - queueFull;
+    }
+    uint64_t now = getClock()->currentCycle();
+    if (request.issue_cycle <= now) {
+        return false;
+    }
+    mHostWaitCycles += request.issue_cycle - now;
+    mResumeEvent.schedule(request.issue_cycle - now);
+    return true;
+}
 
-    // For each row in the block from A
-    for (uint32_t r = 0; r < blockRows; ++r) {
-        VectorPtr rowVector = CreateMatrixPtr<Vector>(mMatrixA->Cols());
+// Stall the schedule until a DMA transfer has landed; returns true when the schedule will
+// resume then
+bool MatrixMultiplier::WaitForDma(uint64_t readyTick) {
+    uint64_t now = getClock()->getScheduler()->getCurrentTick();
+    if (readyTick <= now) {
+        return false;
+    }
+    uint64_t period = std::max<uint64_t>(1, getClock()->getPeriod());
+    uint64_t cycles = (readyTick - now + period - 1) / period;
+    mDmaWaitCycles += cycles;
+    mResumeEvent.schedule(cycles);
+    return true;
+}
 
-        // Fill vector with values from A
-        for (uint32_t c = 0; c < mMatrixA->Cols(); ++c) {
-            if (rowOffset + r < mMatrixA->Rows()) {
-                (*rowVector)[c] = mMatrixA->At(rowOffset + r, c);
+// Move a tile of A (a full row block) or B into a scratchpad buffer
+bool MatrixMultiplier::ExecuteLoad(const TileOp & op) {
+    MultiplyRequest & request = *mActive;
+    if (op.operand == TileOperand::A) {
+        uint32_t rowOffset = op.row_block * mSystolicRows;
+        MatrixPtr tile = CreateTransientPtr<Matrix>(BlockRows(op.row_block), request.a->Cols());
+        for (uint32_t r = 0; r < tile->Rows(); ++r) {
+            if (mDram) {
+                uint64_t imageRowBytes = uint64_t(tile->Cols()) * sizeof(int16_t);
+                mDram->Read(request.a_address + (rowOffset + r) * imageRowBytes,
+                            tile->RowData(r), imageRowBytes);
+            } else {
+                request.a->CopyRow(rowOffset + r, tile->RowData(r));
             }
         }
+        request.spad_buffers[op.buffer] = tile;
+        uint64_t address, bytes;
+        LoadExtent(request, op, address, bytes);
+        request.spad_ready[op.buffer] = RecordDram(address, bytes, false);
+        return true;
+    }
 
-        inputVectors.push_back(rowVector);
+    // B tiles are contiguous because B is stored tile-major at load time
+    uint32_t weightRows = WeightTileRows();
+    uint32_t colTiles = (request.b->Cols() + mSystolicCols - 1) / mSystolicCols;
+    uint64_t tileIndex = uint64_t(op.k_block) * colTiles + op.col_block;
+    Matrix::TileView bTile =
+        request.b->Tile(op.k_block, op.col_block, weightRows, mSystolicCols);
+    MatrixPtr tile = CreateTransientPtr<Matrix>(bTile.Rows(), bTile.Cols());
+    std::vector<int16_t> image;
+    if (mDram) {
+        image.resize(size_t(weightRows) * mSystolicCols);
+        mDram->Read(request.b_address + tileIndex * image.size() * sizeof(int16_t),
+                    image.data(), image.size() * sizeof(int16_t));
+    }
+    for (uint32_t r = 0; r < bTile.Rows(); ++r) {
+        for (uint32_t c = 0; c < bTile.Cols(); ++c) {
+            tile->At(r, c) = mDram ? image[r * mSystolicCols + c] : bTile.At(r, c);
+        }
     }
+    request.spad_buffers[op.buffer] = tile;
+    uint64_t address, bytes;
+    LoadExtent(request, op, address, bytes);
+    request.spad_ready[op.buffer] = RecordDram(address, bytes, false);
+    return true;
+}
 
-    // Process each input vector
-    for (const auto & vector : inputVectors) {
-        // Send vector to systolic array
-        mToSystolicVector.send(vector);
+// Load weights from a scratchpad buffer into the systolic array
+bool MatrixMultiplier::ExecutePreload(const TileOp & op) {
+    const MatrixPtr & bTile = mActive->spad_buffers[op.buffer];
+    if (!bTile) {
+        return false;
     }
 
-    // Update statistics
-    mTotalBlocks++;
+    // Create weight matrix for this tile (transposed portion of B)
+    MatrixPtr weights = CreateTransientPtr<Matrix>(mSystolicRows, mSystolicCols, mSystolicCols);
+
+    // Fill weight matrix with transposed values from the B tile: weight row r holds output
+    // column r of the tile and weight column c its K slot c, so the bounds come from the
+    // tile alone and not from the result block being computed. int4 weights are packed as
+    // nibbles, weights_per_pe consecutive K elements per PE.
+    uint32_t perPe = mMemoryConfig.weights_per_pe;
+    uint32_t kSlots = (bTile->Rows() + perPe - 1) / perPe;
+    for (uint32_t r = 0; r < std::min<uint32_t>(mSystolicRows, bTile->Cols()); ++r) {
+        for (uint32_t c = 0; c < std::min<uint32_t>(mSystolicCols, kSlots); ++c) {
+            // Transpose during load
+            if (!mMemoryConfig.int4_weights) {
+                weights->At(r, c) = bTile->At(c, r);
+                continue;
+            }
+            uint32_t k = c * perPe;
+            int16_t second = perPe == 2 && k + 1 < bTile->Rows() ? bTile->At(k + 1, r) : 0;
+            weights->At(r, c) = PackInt4(bTile->At(k, r), second);
+        }
+    }
+
+    // Send weights to systolic array
+    mToSystolicWeights.send(weights);
+    mActive->weights = weights;
+    mWeightsOwner = mActive->id;
+    return true;
 }
 
-// Handle results from systolic array
-void MatrixMultiplier::HandleSystolicResults(const MatrixPtr & results) {
-    if (!mBusy) {
-#ifdef DEBUG_MATRIX_MULTIPLIER
-        std::cout << "Received results when not busy, ignoring" << std::endl;
-#endif
-        return;
+// Stream the rows of an A buffer through the systolic array
+bool MatrixMultiplier::ExecuteCompute(const TileOp & op) {
+    const MatrixPtr & aTile = mActive->spad_buffers[op.buffer];
+    if (!aTile) {
+        return false;
+    }
+
+    // Another tenant used the array since this request's preload, restore its weights
+    if (mWeightsOwner != mActive->id && mActive->weights) {
+        mToSystolicWeights.send(mActive->weights);
+        mWeightsOwner = mActive->id;
     }
 
 #ifdef DEBUG_MATRIX_MULTIPLIER
-    std::cout << "Received results for block [" << mCurrentRowBlock << "," << mCurrentColBlock
-              << "]" << std::endl;
+    std::cout << "Processing block [" << op.row_block << "," << op.col_block
+              << "]: " << BlockRows(op.row_block) << "x" << BlockCols(op.col_block) << std::endl;
 #endif
 
-    // Copy block results to the appropriate position in the final result matrix
-    uint32_t rowOffset = mCurrentRowBlock * mSystolicRows;
-    uint32_t colOffset = mCurrentColBlock * mSystolicCols;
+    // Send the K tile of every A row of the block as one vector; the array pipelines them
+    // and returns one result per row in order. With int4 weights the activations are int8,
+    // packed in pairs when every PE holds two weights.
+    uint32_t perPe = mMemoryConfig.weights_per_pe;
+    uint32_t kBegin = std::min(aTile->Cols(), op.k_block * WeightTileRows());
+    uint32_t kRows = std::min(WeightTileRows(), aTile->Cols() - kBegin);
+    uint32_t lanes = (kRows + perPe - 1) / perPe;
+
+    // Each MX block's sums are scaled on their own, so a K tile that spans several blocks
+    // is streamed once per block with the other blocks' elements zeroed
+    const MxFormat & format = mMemoryConfig.operand_format;
+    mComputeBlocks.clear();
+    if (format.Enabled() && kRows > 0) {
+        for (uint32_t blk = kBegin / format.block_size;
+             blk * format.block_size < kBegin + kRows; ++blk) {
+            mComputeBlocks.push_back(blk);
+        }
+    } else {
+        mComputeBlocks.push_back(0);
+    }
+    mComputeRows = aTile->Rows();
+    mComputeSums.assign(mComputeBlocks.size() * mComputeRows * mSystolicCols, 0);
+    mResultRowsReceived = 0;
+    for (uint32_t blk : mComputeBlocks) {
+        uint32_t lo = 0;
+        uint32_t hi = kRows;
+        if (format.Enabled()) {
+            lo = std::max(kBegin, blk * format.block_size) - kBegin;
+            hi = std::min(kBegin + kRows, (blk + 1) * format.block_size) - kBegin;
+        }
+        for (uint32_t r = 0; r < aTile->Rows(); ++r) {
+            VectorPtr rowVector = CreateTransientPtr<Vector>(lanes);
+            const int16_t* row = aTile->RowData(r) + kBegin;
+            for (uint32_t i = 0; i < lanes; ++i) {
+                if (!mMemoryConfig.int4_weights) {
+                    (*rowVector)[i] = i >= lo && i < hi ? row[i] : 0;
+                    continue;
+                }
+                uint32_t k = i * perPe;
+                int16_t second = perPe == 2 && k + 1 < kRows ? row[k + 1] : 0;
+                (*rowVector)[i] = PackInt8(row[k], second);
+            }
+            mToSystolicVector.send(rowVector);
+        }
+    }
+
+    // Results land in, or add to, this accumulator buffer
+    mActive->compute_acc_buffer = op.acc_buffer;
+    mActive->compute_k_block = op.k_block;
+    mActive->compute_row_block = op.row_block;
+    mActive->compute_col_block = op.col_block;
+    mAwaitingResults = true;
 
-    uint32_t blockRows = std::min(mSystolicRows, mMatrixA->Rows() - rowOffset);
-    uint32_t blockCols = std::min(mSystolicCols, mMatrixB->Cols() - colOffset);
+    // Update statistics
+    mTotalBlocks++;
+    return true;
+}
 
-    // Copy results
+// Copy an accumulator buffer into the result matrix
+bool MatrixMultiplier::ExecuteStore(const TileOp & op) {
+    const AccTilePtr & results = mActive->acc_buffers[op.acc_buffer];
+    if (!results) {
+        return false;
+    }
+
+    uint32_t rowOffset = op.row_block * mSystolicRows;
+    uint32_t colOffset = op.col_block * mSystolicCols;
+    uint32_t blockRows = std::min(BlockRows(op.row_block), results->rows);
+    uint32_t blockCols = std::min(BlockCols(op.col_block), results->cols);
+
+    // Sums leave at accumulator width; MX sums were scaled as they were accumulated and are
+    // rounded here. The 16-bit result matrix saturates them.
+    const bool mx = !mActive->a_scales.empty();
+    auto full = [&](uint32_t r, uint32_t c) -> int32_t {
+        if (!mx) {
+            return results->At(r, c);
+        }
+        double real = std::nearbyint(results->Scaled(r, c));
+        return static_cast<int32_t>(std::clamp<double>(real, INT32_MIN, INT32_MAX));
+    };
+
+    // Copy results, one DRAM transfer per row of the block
+    uint64_t elementBytes = mMemoryConfig.acc_element_bytes;
+    std::vector<int32_t> row(blockCols);
     for (uint32_t r = 0; r < blockRows; ++r) {
         for (uint32_t c = 0; c < blockCols; ++c) {
-            mResultMatrix->At(rowOffset + r, colOffset + c) = results->At(r, c);
+            row[c] = full(r, c);
+            mActive->result->At(rowOffset + r, colOffset + c) =
+                static_cast<int16_t>(std::clamp<int32_t>(row[c], INT16_MIN, INT16_MAX));
+        }
+        uint64_t element = uint64_t(rowOffset + r) * mActive->b->Cols() + colOffset;
+        uint64_t landed = RecordDram(mActive->result_address + element * elementBytes,
+                                     blockCols * elementBytes, true);
+        mActive->stores_done = std::max(mActive->stores_done, landed);
+
+        // The image holds results at accumulator width
+        if (mDram) {
+            mDram->Write(mActive->result_address + element * sizeof(int32_t), row.data(),
+                         row.size() * sizeof(int32_t));
         }
     }
 
-    // Move to next block
-    mCurrentColBlock++;
-    if (mCurrentColBlock >= mTotalColBlocks) {
-        mCurrentColBlock = 0;
-        mCurrentRowBlock++;
+    // The region drains in the background; the buffer holds no live state once stored,
+    // so a context switch need not save it
+    mToAccumulatorDrain.send(uint64_t(blockRows) * blockCols * elementBytes);
+    ++mDrainsInFlight;
+    mActive->acc_buffers[op.acc_buffer].reset();
+    return true;
+}
 
-        if (mCurrentRowBlock >= mTotalRowBlocks) {
-            // All blocks processed
-            MultiplierDone();
-            return;
+// Stall the schedule until the accumulator reports a finished drain
+void MatrixMultiplier::WaitForDrain() {
+    mAwaitingDrain = true;
+    mDrainWaitStart = getClock()->currentCycle();
+    mDrainStalls++;
+}
+
+// Accumulator regions finished draining, resume a schedule waiting on them
+void MatrixMultiplier::HandleDrained(const uint32_t & count) {
+    mDrainsInFlight -= std::min(count, mDrainsInFlight);
+    if (!mAwaitingDrain) {
+        return;
+    }
+    mAwaitingDrain = false;
+    mExposedDrainCycles += getClock()->currentCycle() - mDrainWaitStart;
+    ExecuteSchedule();
+}
+
+// Handle results from systolic array
+void MatrixMultiplier::HandleSystolicResults(const WaveSumsPtr & results) {
+    if (!mActive || !mAwaitingResults) {
+#ifdef DEBUG_MATRIX_MULTIPLIER
+        std::cout << "Received results when not waiting for them, ignoring" << std::endl;
+#endif
+        return;
+    }
+
+    // Gather one result row per streamed vector
+    uint32_t row = mResultRowsReceived++;
+    int32_t* dst = &mComputeSums[size_t(row) * mSystolicCols];
+    std::copy_n(results->begin(), std::min<size_t>(results->size(), mSystolicCols), dst);
+    if (mResultRowsReceived * mSystolicCols < mComputeSums.size()) {
+        return;
+    }
+
+    // Results are held in the accumulator buffer until a store moves them out; the first K
+    // tile of a block starts its partial sums and later ones add to them. MX passes are
+    // scaled by the block scales of their row of A and column of B first.
+    mHosts[mActive->tenant].Retire(getClock()->currentCycle());
+    const bool mx = !mActive->a_scales.empty();
+    AccTilePtr & sums = mActive->acc_buffers[mActive->compute_acc_buffer];
+    if (!sums || mActive->compute_k_block == 0) {
+        sums = std::make_shared<AccTile>(mComputeRows, mSystolicCols, mx);
+    }
+    const MxFormat & format = mMemoryConfig.operand_format;
+    const uint32_t blocks = mActive->mx_blocks;
+    const uint32_t rowOffset = mActive->compute_row_block * mSystolicRows;
+    const uint32_t colOffset = mActive->compute_col_block * mSystolicCols;
+    for (size_t pass = 0; pass < mComputeBlocks.size(); ++pass) {
+        const int32_t* passSums = &mComputeSums[pass * mComputeRows * mSystolicCols];
+        uint32_t blk = mComputeBlocks[pass];
+        for (uint32_t r = 0; r < sums->rows; ++r) {
+            for (uint32_t c = 0; c < sums->cols; ++c) {
+                int32_t sum = passSums[size_t(r) * mSystolicCols + c];
+                if (!mx) {
+                    int64_t total = int64_t(sums->At(r, c)) + sum;
+                    sums->At(r, c) =
+                        static_cast<int32_t>(std::clamp<int64_t>(total, INT32_MIN, INT32_MAX));
+                    continue;
+                }
+                uint32_t aRow = rowOffset + r;
+                uint32_t bCol = colOffset + c;
+                if (aRow >= mActive->a->Rows() || bCol >= mActive->b->Cols()) {
+                    continue;
+                }
+                sums->Scaled(r, c) += static_cast<float>(
+                    format.ScaleSum(sum, mActive->a_scales[size_t(aRow) * blocks + blk],
+                                    mActive->b_scales[size_t(blk) * mActive->b->Cols() + bCol]));
+            }
         }
     }
+    mComputeSums.clear();
+    mAwaitingResults = false;
+
+    // The tile is done, arbitrate for the next one
+    Dispatch();
+}
+
+// Rows and columns of a result block, edge blocks can be smaller than the array
+uint32_t MatrixMultiplier::BlockRows(uint32_t rowBlock) const {
+    return std::min<uint32_t>(mSystolicRows, mActive->a->Rows() - rowBlock * mSystolicRows);
+}
 
-    // Process next block
-    ProcessNextBlock();
+uint32_t MatrixMultiplier::BlockCols(uint32_t colBlock) const {
+    return std::min<uint32_t>(mSystolicCols, mActive->b->Cols() - colBlock * mSystolicCols);
 }
 
-// Called when all blocks have been processed
-void MatrixMultiplier::MultiplierDone() {
+// Rows of B (elements along K) in one weight tile
+uint32_t MatrixMultiplier::WeightTileRows() const {
+    return mSystolicRows * mMemoryConfig.weights_per_pe;
+}
+
+// Called when all operations of the active request have executed
+void MatrixMultiplier::RequestDone() {
 #ifdef DEBUG_MATRIX_MULTIPLIER
-    std::cout << "Matrix multiplication complete" << std::endl;
+    std::cout << "Matrix multiplication " << mActive->id << " complete" << std::endl;
 #endif
 
+    // Latency from queueing to completion, in command clock cycles
+    TenantStats & stats = mTenantStats[mActive->tenant];
+    uint64_t latency = getClock()->currentCycle() - mActive->enqueue_cycle;
+    (*stats.requests)++;
+    (*stats.latency) += latency;
+    if (latency > stats.max_latency->get()) {
+        stats.max_latency->set(latency);
+    }
+
     // Send result to output port
+    mResultMatrix = mActive->result;
+    mResultTick = getClock()->getScheduler()->getCurrentTick();
     mPortSet.out_result.send(mResultMatrix);
 
-    // Reset busy flag
-    mBusy = false;
+    DropActiveRequest();
+    Dispatch();
+}
+
+// Remove the active request from its tenant's queue
+void MatrixMultiplier::DropActiveRequest() {
+    std::deque<RequestPtr> & queue = mQueues[mActive->tenant];
+    auto it = std::find(queue.begin(), queue.end(), mActive);
+    if (it != queue.end()) {
+        queue.erase(it);
+    }
+    mActive.reset();
 }
 
-} // namespace gemmini
\ No newline at end of file
+} // namespace gemmini
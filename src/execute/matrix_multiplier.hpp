@@ -2,23 +2,36 @@
 #pragma once
 
 #include <cstdint>
+#include <deque>
 #include <vector>
 #include <memory>
+#include <string>
 
 #include "sparta/ports/PortSet.hpp"
 #include "sparta/ports/SignalPort.hpp"
 #include "sparta/ports/DataPort.hpp"
 #include "sparta/events/EventSet.hpp"
+#include "sparta/events/UniqueEvent.hpp"
 #include "sparta/simulation/Unit.hpp"
 #include "sparta/simulation/ParameterSet.hpp"
 #include "sparta/simulation/TreeNode.hpp"
 #include "sparta/simulation/ResourceFactory.hpp"
 #include "sparta/statistics/Counter.hpp"
+#include "sparta/statistics/StatisticDef.hpp"
 #include "sparta/log/MessageSource.hpp"
 
 #include "utils/common.hpp"
+#include "utils/dram_trace.hpp"
+#include "utils/profile.hpp"
+#include "utils/sparse_memory.hpp"
+#include "execute/accumulator.hpp"
+#include "execute/host_interface.hpp"
 #include "execute/matrix.hpp"
+#include "execute/packed_int.hpp"
 #include "execute/systolic_array.hpp"
+#include "execute/tile_schedule.hpp"
+#include "execute/schedule_checker.hpp"
+#include "execute/tenant_arbiter.hpp"
 
 BEGIN_NS(gemmini)
 
@@ -35,6 +48,44 @@ public:
     // Parameters
     PARAMETER(uint32_t, systolic_rows, 4, "Number of rows in systolic array")
     PARAMETER(uint32_t, systolic_cols, 4, "Number of columns in systolic array")
+    PARAMETER(std::string, schedule_file, "", "Tile schedule to replay instead of planning one")
+    PARAMETER(std::string, schedule_dump_file, "", "Write each planned tile schedule to this file")
+    PARAMETER(bool, check_schedules, true, "Statically check replayed schedules before running")
+    PARAMETER(uint32_t, scratchpad_kb, 256, "Scratchpad capacity in KiB")
+    PARAMETER(uint32_t, scratchpad_banks, 4, "Number of scratchpad banks")
+    PARAMETER(uint32_t, accumulator_kb, 64, "Accumulator capacity in KiB")
+    PARAMETER(uint32_t, dma_bytes_per_cycle, 16, "DMA bandwidth in bytes per DRAM clock cycle")
+    PARAMETER(uint32_t, clock_crossing_cycles, 2,
+              "Synchronizer latency added to ports that cross clock domains")
+    PARAMETER(std::vector<uint32_t>, tenant_priorities, std::vector<uint32_t>(1, 0),
+              "Priority of each tenant request stream, lower values are served first")
+    PARAMETER(std::vector<uint32_t>, tenant_weights, std::vector<uint32_t>(1, 1),
+              "Weighted-fair share of each tenant among tenants of equal priority")
+    PARAMETER(bool, preemption, true,
+              "Allow switching to another request at tile boundaries before a GEMM finishes")
+    PARAMETER(uint32_t, preempt_save_cycles, 16,
+              "Fixed cycles to save a preempted GEMM's tile iterator and control state")
+    PARAMETER(uint32_t, preempt_restore_cycles, 16,
+              "Fixed cycles to restore a preempted GEMM before it resumes")
+    PARAMETER(std::string, dram_trace_file, "", "Write every DRAM transfer to this trace file")
+    PARAMETER(std::string, dram_trace_format, "dramsim3",
+              "DRAM trace format: dramsim3 or ramulator")
+    PARAMETER(uint32_t, dram_burst_bytes, 64, "DRAM burst size the trace is split into")
+    PARAMETER(bool, dram_image, false,
+              "Keep operands and results in a sparse DRAM image that loads and stores go through")
+    PARAMETER(uint32_t, dram_page_kb, 4, "Page size of the DRAM image, 4 or 2048 KiB")
+    PARAMETER(uint32_t, host_issue_cycles, 0, "Cycles the host takes to issue one command")
+    PARAMETER(uint32_t, host_queue_depth, 0,
+              "Commands the host can have issued but not retired, 0 for unlimited")
+    PARAMETER(uint32_t, host_fence_cycles, 0,
+              "Cycles of the fence the host waits on at the end of every multiplication")
+    PARAMETER(std::string, operand_format, "int16",
+              "Input element format: int16, mxint8, mxfp8 or mxfp4")
+    PARAMETER(uint32_t, mx_block_size, 32, "Elements along K sharing one MX scale, 16 or 32")
+    PARAMETER(bool, int4_weights, false,
+              "Store weights as packed int4, two per byte, and activations as int8")
+    PARAMETER(bool, int4_dual_mac, false,
+              "With int4 weights, every PE holds two weights and does two MACs per cycle")
 };
 
 // Port Set for MatrixMultiplier
@@ -83,10 +134,45 @@ public:
                                       MatrixMultiplierParameterSet>::ResourceFactory;
     };
 
-    // Direct access method for simulation
-    void Multiply(const MatrixPtr & a, const MatrixPtr & b);
+    // Queue a multiplication for a tenant; runs the given schedule if there is one.
+    // Returns the request id, or 0 if the request was rejected.
+    uint64_t Multiply(const MatrixPtr & a, const MatrixPtr & b,
+                      const TileSchedulePtr & schedule = nullptr, uint32_t tenant = 0);
 
+    // Result of the most recently completed request and the scheduler tick it was sent at
     MatrixPtr GetResult() const { return mResultMatrix; }
+    uint64_t GetResultTick() const { return mResultTick; }
+
+    // True when every queued request has completed or been dropped
+    bool Idle() const { return !mBusy; }
+
+    // Static-checker estimate of an MxK * KxN request on its own, in command clock cycles
+    uint64_t EstimateCycles(uint32_t m, uint32_t k, uint32_t n) const;
+
+    // Host memory the same request takes while it runs: scratchpad and accumulator buffers
+    // with the payloads of the compute in flight, and the matrices the request keeps
+    void EstimateHostBytes(uint32_t m, uint32_t k, uint32_t n, uint64_t & buffers,
+                           uint64_t & payloads) const;
+
+    uint32_t NumTenants() const { return static_cast<uint32_t>(mQueues.size()); }
+
+    // Change a setting that may differ between runs forked from one warmed-up simulation:
+    // preemption, preempt_save_cycles, preempt_restore_cycles, dma_bytes_per_cycle,
+    // host_issue_cycles, host_queue_depth, host_fence_cycles, or the accumulator's
+    // drain_bytes_per_cycle and drain_latency. Returns false for an unknown knob.
+    bool SetKnob(const std::string & knob, uint64_t value);
+
+    // In a forked child: continue the DRAM trace in its own file, and write it out before
+    // the child exits
+    void RestartDramTrace(const std::string & suffix);
+    void CloseDramTrace();
+
+    // Contents of simulated DRAM, nullptr unless dram_image is set
+    SparseMemory* GetDram() { return mDram.get(); }
+
+    // Clock the DMA channel runs on and the DRAM trace is stamped in; the command clock
+    // until one is set
+    void SetDramClock(const sparta::Clock* clock);
 
 private:
     // Port set
@@ -95,7 +181,11 @@ private:
     // Ports to/from Systolic Array
     sparta::DataOutPort<MatrixPtr> mToSystolicWeights;
     sparta::DataOutPort<VectorPtr> mToSystolicVector;
-    sparta::DataInPort<MatrixPtr> mFromSystolicResults;
+    sparta::DataInPort<WaveSumsPtr> mFromSystolicResults;
+
+    // Ports to/from the Accumulator's drain pipeline
+    sparta::DataOutPort<uint64_t> mToAccumulatorDrain;
+    sparta::DataInPort<uint32_t> mFromAccumulatorDrained;
 
     // Event set for scheduling
     sparta::EventSet mUnitEventSet;
@@ -103,33 +193,175 @@ private:
     // Logger
     sparta::log::MessageSource mLogger;
 
-    // Configuration
-    const uint32_t mSystolicRows;
-    const uint32_t mSystolicCols;
+    // Configuration, array dimensions are constants in a profile build
+    const ProfileParam<Profile::kRows> mSystolicRows;
+    const ProfileParam<Profile::kCols> mSystolicCols;
+
+    const std::string mScheduleDumpFile;
+    const bool mCheckSchedules;
+    const uint32_t mClockCrossingCycles;
+
+    // Runtime knobs, see SetKnob
+    bool mPreemption;
+    uint32_t mPreemptSaveCycles;
+    uint32_t mPreemptRestoreCycles;
+    MemoryConfig mMemoryConfig;
+    HostConfig mHostConfig;
+
+    // Schedule to run instead of planning, loaded from a file
+    TileSchedulePtr mReplaySchedule;
+
+    // Partial sums of one result block at accumulator width; K tiles add into it. MX sums
+    // carry different block scales, so they are scaled and added up in FP32 instead.
+    struct AccTile {
+        AccTile(uint32_t r, uint32_t c, bool mx = false)
+            : rows(r), cols(c), sums(size_t(r) * c, 0), scaled(mx ? size_t(r) * c : 0, 0.0f) {}
+        int32_t & At(uint32_t row, uint32_t col) { return sums[size_t(row) * cols + col]; }
+        int32_t At(uint32_t row, uint32_t col) const { return sums[size_t(row) * cols + col]; }
+        float & Scaled(uint32_t row, uint32_t col) { return scaled[size_t(row) * cols + col]; }
+        float Scaled(uint32_t row, uint32_t col) const {
+            return scaled[size_t(row) * cols + col];
+        }
+
+        uint32_t rows;
+        uint32_t cols;
+        std::vector<int32_t> sums;
+        std::vector<float> scaled;
+    };
+    using AccTilePtr = std::shared_ptr<AccTile>;
+
+    // One queued or running multiplication and its schedule execution state
+    struct MultiplyRequest {
+        uint64_t id = 0;
+        uint32_t tenant = 0;
+        MatrixPtr a;
+        MatrixPtr b;
+        MatrixPtr result;
+        TileSchedulePtr schedule;
+        size_t next_op = 0;                 // Next operation to execute
+        uint8_t compute_acc_buffer = 0;     // Accumulator buffer of the in-flight compute
+        uint32_t compute_k_block = 0;       // K tile of the in-flight compute
+        uint32_t compute_row_block = 0;     // Result block of the in-flight compute
+        uint32_t compute_col_block = 0;
+        std::vector<MatrixPtr> spad_buffers; // Scratchpad buffer contents
+        std::vector<uint64_t> spad_ready;   // Tick the last load of each buffer lands
+        uint64_t stores_done = 0;           // Tick the last result store lands in DRAM
+        std::vector<AccTilePtr> acc_buffers; // Accumulator buffer contents
+        MatrixPtr weights;                  // Weights last preloaded for this request
+        bool preempted = false;             // State was saved and must be restored
+        size_t issued_ops = 0;              // Operations the host has issued
+        uint64_t issue_cycle = 0;           // Cycle the last issued operation arrived
+        bool fenced = false;                // The closing fence has been paid for
+        uint32_t mx_blocks = 0;             // MX blocks along K
+        std::vector<int32_t> a_scales;      // MX scales of A, mx_blocks per row
+        std::vector<int32_t> b_scales;      // MX scales of B, one row of columns per block
+        uint64_t enqueue_cycle = 0;
+        uint64_t a_address = 0;             // DRAM placement of A
+        uint64_t b_address = 0;             // DRAM placement of B
+        uint64_t result_address = 0;        // DRAM placement of the result
+        uint64_t context_address = 0;       // Where a preempted context is saved
+    };
+    using RequestPtr = std::shared_ptr<MultiplyRequest>;
+
+    // Per-tenant statistics
+    struct TenantStats {
+        std::unique_ptr<sparta::Counter> requests;    // Completed requests
+        std::unique_ptr<sparta::Counter> tiles;       // Tiles granted on the array
+        std::unique_ptr<sparta::Counter> latency;     // Sum of request latencies in cycles
+        std::unique_ptr<sparta::Counter> max_latency; // Longest request latency in cycles
+        std::unique_ptr<sparta::StatisticDef> avg_latency;
+    };
+
+    // Command queue: one FIFO per tenant, arbitrated once per tile. Each tenant is fed by
+    // its own host thread.
+    std::vector<std::deque<RequestPtr>> mQueues;
+    std::vector<HostInterface> mHosts;
+    TenantArbiter mArbiter;
+    uint64_t mNextRequestId = 1;
 
     // Current state
     bool mBusy = false;
-    uint32_t mCurrentRowBlock = 0;
-    uint32_t mCurrentColBlock = 0;
-    uint32_t mTotalRowBlocks = 0;
-    uint32_t mTotalColBlocks = 0;
+    RequestPtr mActive;              // Request holding the array, kept until it finishes or
+                                     // is preempted
+    uint64_t mWeightsOwner = 0;      // Request whose weights the array holds
+    bool mAwaitingResults = false;   // A compute is in flight in the array
+    std::vector<int32_t> mComputeSums;    // Sums of the in-flight compute, a row per vector
+    std::vector<uint32_t> mComputeBlocks; // MX block of each pass of the in-flight compute
+    uint32_t mComputeRows = 0;            // Vectors streamed per pass
+    uint32_t mResultRowsReceived = 0;
+    uint32_t mAccRegions = 2;        // Accumulator output regions
+    uint32_t mDrainsInFlight = 0;    // Stored regions still draining to DRAM
+    bool mAwaitingDrain = false;     // The schedule waits for a region to drain
+    uint64_t mDrainWaitStart = 0;
     MatrixPtr mMatrixA;
     MatrixPtr mMatrixB;
     MatrixPtr mResultMatrix;
+    uint64_t mResultTick = 0;
 
     // Statistics
     sparta::Counter mTotalMms;    // Count of matrix multiplications
     sparta::Counter mTotalBlocks; // Count of block operations
+    sparta::Counter mRejectedSchedules; // Count of schedules rejected by the static checker
+    sparta::Counter mPreemptions;       // Count of requests preempted at a tile boundary
+    sparta::Counter mSaveCycles;        // Cycles spent saving preempted requests
+    sparta::Counter mRestoreCycles;     // Cycles spent restoring preempted requests
+    sparta::Counter mDramReadBytes;     // Bytes read from DRAM by the DMA
+    sparta::Counter mDramWriteBytes;    // Bytes written to DRAM by the DMA
+    sparta::Counter mDrainStalls;       // Times the schedule waited on an accumulator drain
+    sparta::Counter mExposedDrainCycles; // Cycles the schedule waited on accumulator drains
+    sparta::Counter mHostCommands;      // Commands issued by the host
+    sparta::Counter mHostWaitCycles;    // Cycles the schedule waited for the host to issue
+    sparta::Counter mHostQueueFullCycles; // Cycles the host waited on a full command queue
+    sparta::Counter mHostFenceCycles;   // Cycles spent in end-of-multiplication fences
+    sparta::Counter mDmaWaitCycles;     // Cycles the schedule waited on DMA transfers
+
+    // DRAM address map, and the DMA channel in scheduler ticks
+    uint64_t mNextDramAddress = 0;
+    uint64_t mDmaFreeTick = 0;
+    const sparta::Clock* mDramClock = nullptr;
+    Accumulator* mAccumulator = nullptr;
+    std::unique_ptr<DramTraceWriter> mDramTrace;
+    std::unique_ptr<SparseMemory> mDram;
+
+    // Resumes schedule execution once a context switch has been paid for
+    sparta::UniqueEvent<> mResumeEvent;
+    std::vector<TenantStats> mTenantStats;
 
     // Internal methods
     void HandleMatrixA(const MatrixPtr & a);
     void HandleMatrixB(const MatrixPtr & b);
     void HandleControl(const uint32_t & signal);
-    void HandleSystolicResults(const MatrixPtr & results);
+    void HandleSystolicResults(const WaveSumsPtr & results);
+    void HandleDrained(const uint32_t & count);
+
+    RequestPtr CreateRequest(const MatrixPtr & a, const MatrixPtr & b,
+                             const TileSchedulePtr & schedule, uint32_t tenant);
+    void QuantizeOperands(MultiplyRequest & request) const;
+    void Dispatch();
+    void ExecuteSchedule();
+    bool ExecuteLoad(const TileOp & op);
+    bool ExecutePreload(const TileOp & op);
+    bool ExecuteCompute(const TileOp & op);
+    bool ExecuteStore(const TileOp & op);
+    void WaitForDrain();
+    bool WaitForHost(MultiplyRequest & request);
+    bool WaitForDma(uint64_t readyTick);
+    uint64_t ContextCycles(const MultiplyRequest & request, uint32_t fixedCycles,
+                           const std::vector<TileOp> & reloads) const;
+    void LoadExtent(const MultiplyRequest & request, const TileOp & op, uint64_t & address,
+                    uint64_t & bytes) const;
+    uint64_t AllocateDram(uint64_t bytes);
+    uint64_t RecordDram(uint64_t address, uint64_t bytes, bool write);
+    uint32_t DmaBytesPerCommandCycle() const;
+    MemoryConfig CheckerConfig() const;
+    void RecordContext(const MultiplyRequest & request, bool write);
+    void WriteOperands(const MultiplyRequest & request);
+    void RequestDone();
+    void DropActiveRequest();
 
-    void StartMultiplication();
-    void ProcessNextBlock();
-    void MultiplierDone();
+    uint32_t BlockRows(uint32_t rowBlock) const;
+    uint32_t BlockCols(uint32_t colBlock) const;
+    uint32_t WeightTileRows() const;
 };
 
 END_NS(gemmini)
\ No newline at end of file
@@ -0,0 +1,49 @@
+// mesh_stats.hpp - Dense per-PE statistics for a systolic array
+#pragma once
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// MeshStats - per-PE event counts for a whole array kept in one dense row-major table.
+// PEs increment their slot directly; row, column and array totals are only computed
+// when they are read.
+class MeshStats {
+public:
+    MeshStats(uint32_t rows, uint32_t cols) : mRows(rows), mCols(cols), mMacs(rows * cols, 0) {}
+
+    // Slot a PE counts its MACs into
+    uint64_t* MacSlot(uint32_t row, uint32_t col) { return &mMacs[row * mCols + col]; }
+
+    // Per-PE and aggregate MAC counts
+    uint64_t Macs(uint32_t row, uint32_t col) const { return mMacs[row * mCols + col]; }
+
+    uint64_t RowMacs(uint32_t row) const {
+        auto begin = mMacs.begin() + row * mCols;
+        return std::accumulate(begin, begin + mCols, uint64_t(0));
+    }
+
+    uint64_t ColMacs(uint32_t col) const {
+        uint64_t sum = 0;
+        for (uint32_t r = 0; r < mRows; ++r) {
+            sum += mMacs[r * mCols + col];
+        }
+        return sum;
+    }
+
+    uint64_t TotalMacs() const { return std::accumulate(mMacs.begin(), mMacs.end(), uint64_t(0)); }
+
+    uint32_t Rows() const { return mRows; }
+    uint32_t Cols() const { return mCols; }
+
+private:
+    const uint32_t mRows;
+    const uint32_t mCols;
+    std::vector<uint64_t> mMacs;
+};
+
+END_NS(gemmini)
@@ -0,0 +1,175 @@
+// mx_format.cpp - Implementation of the microscaling block formats
+#include "execute/mx_format.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gemmini {
+
+namespace {
+
+// Exponent of the largest power of two an element can represent (emax in the MX spec)
+int32_t ElementEmax(MxElement element) {
+    switch (element) {
+    case MxElement::Int8:
+        return 0;
+    case MxElement::Fp8E4M3:
+        return 8;
+    case MxElement::Fp4E2M1:
+        return 2;
+    case MxElement::None:
+        break;
+    }
+    return 0;
+}
+
+// Round a magnitude to a minifloat with the given mantissa bits and minimum normal exponent,
+// saturating at max
+double RoundMinifloat(double magnitude, uint32_t mantissaBits, int32_t minExp, double max) {
+    if (magnitude == 0.0) {
+        return 0.0;
+    }
+    int32_t exp = std::max(minExp, static_cast<int32_t>(std::floor(std::log2(magnitude))));
+    double step = std::ldexp(1.0, exp - static_cast<int32_t>(mantissaBits));
+    return std::min(max, std::nearbyint(magnitude / step) * step);
+}
+
+} // namespace
+
+const char* MxElementName(MxElement element) {
+    switch (element) {
+    case MxElement::None:
+        return "int16";
+    case MxElement::Int8:
+        return "mxint8";
+    case MxElement::Fp8E4M3:
+        return "mxfp8";
+    case MxElement::Fp4E2M1:
+        return "mxfp4";
+    }
+    return "unknown";
+}
+
+bool ParseMxElement(const std::string & name, MxElement & element) {
+    if (name == "int16" || name == "none") {
+        element = MxElement::None;
+    } else if (name == "mxint8") {
+        element = MxElement::Int8;
+    } else if (name == "mxfp8" || name == "mxfp8_e4m3") {
+        element = MxElement::Fp8E4M3;
+    } else if (name == "mxfp4" || name == "mxfp4_e2m1") {
+        element = MxElement::Fp4E2M1;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+uint32_t MxFormat::ElementBits() const {
+    switch (element) {
+    case MxElement::Int8:
+    case MxElement::Fp8E4M3:
+        return 8;
+    case MxElement::Fp4E2M1:
+        return 4;
+    case MxElement::None:
+        break;
+    }
+    return 16;
+}
+
+uint32_t MxFormat::FractionBits() const {
+    switch (element) {
+    case MxElement::Int8:
+        return 6;
+    case MxElement::Fp8E4M3:
+        return 2;
+    case MxElement::Fp4E2M1:
+        return 1;
+    case MxElement::None:
+        break;
+    }
+    return 0;
+}
+
+uint64_t MxFormat::Bytes(uint64_t count) const {
+    uint64_t elementBytes = (count * ElementBits() + 7) / 8;
+    if (!Enabled()) {
+        return elementBytes;
+    }
+    uint64_t block = std::max(1u, block_size);
+    return elementBytes + (count + block - 1) / block;
+}
+
+uint32_t MxFormat::Blocks(uint32_t count) const {
+    uint32_t block = std::max(1u, block_size);
+    return (count + block - 1) / block;
+}
+
+double MxFormat::MaxElement() const {
+    switch (element) {
+    case MxElement::Int8:
+        return 127.0 / 64.0;
+    case MxElement::Fp8E4M3:
+        return 448.0;
+    case MxElement::Fp4E2M1:
+        return 6.0;
+    case MxElement::None:
+        break;
+    }
+    return 32767.0;
+}
+
+int32_t MxFormat::BlockScale(double maxAbs) const {
+    if (!Enabled() || maxAbs == 0.0) {
+        return 0;
+    }
+    // E8M0 covers 2^-127 .. 2^127
+    int32_t scale = static_cast<int32_t>(std::floor(std::log2(maxAbs))) - ElementEmax(element);
+    return std::max(-127, std::min(127, scale));
+}
+
+int16_t MxFormat::Quantize(double value, int32_t scale) const {
+    double scaled = std::ldexp(value, -scale);
+    double magnitude = std::fabs(scaled);
+    double rounded = 0.0;
+    switch (element) {
+    case MxElement::None:
+        rounded = std::min(MaxElement(), std::nearbyint(magnitude));
+        break;
+    case MxElement::Int8:
+        rounded = std::min(MaxElement(), std::nearbyint(magnitude * 64.0) / 64.0);
+        break;
+    case MxElement::Fp8E4M3:
+        rounded = RoundMinifloat(magnitude, 3, -6, MaxElement());
+        break;
+    case MxElement::Fp4E2M1:
+        rounded = RoundMinifloat(magnitude, 1, 0, MaxElement());
+        break;
+    }
+    double fixed = std::nearbyint(std::ldexp(rounded, FractionBits()));
+    return static_cast<int16_t>(scaled < 0 ? -fixed : fixed);
+}
+
+double MxFormat::Dequantize(int32_t fixed, int32_t scale) const {
+    return std::ldexp(static_cast<double>(fixed), scale - static_cast<int32_t>(FractionBits()));
+}
+
+int32_t MxFormat::QuantizeBlock(const double* values, size_t count, int16_t* fixed) const {
+    double maxAbs = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        maxAbs = std::max(maxAbs, std::fabs(values[i]));
+    }
+    int32_t scale = BlockScale(maxAbs);
+    for (size_t i = 0; i < count; ++i) {
+        fixed[i] = Quantize(values[i], scale);
+    }
+    return scale;
+}
+
+double MxFormat::ScaleSum(int64_t sum, int32_t scaleA, int32_t scaleB) const {
+    return std::ldexp(static_cast<double>(sum),
+                      scaleA + scaleB - 2 * static_cast<int32_t>(FractionBits()));
+}
+
+} // namespace gemmini
@@ -0,0 +1,67 @@
+// mx_format.hpp - Microscaling (MX) block formats for operands
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// Element type of an MX block; None keeps plain 16-bit operands
+enum class MxElement : uint8_t {
+    None = 0,
+    Int8 = 1,    // MXINT8: 8-bit two's complement, value = code * 2^-6
+    Fp8E4M3 = 2, // MXFP8: 1 sign, 4 exponent, 3 mantissa bits, max 448
+    Fp4E2M1 = 3, // MXFP4: 1 sign, 2 exponent, 1 mantissa bit, max 6
+};
+
+const char* MxElementName(MxElement element);
+bool ParseMxElement(const std::string & name, MxElement & element);
+
+// MxFormat - blocks of block_size elements along K share one 8-bit power-of-two scale
+// (E8M0). Inside the mesh an element travels as a 16-bit fixed-point value with
+// FractionBits() fractional bits, so PEs keep their integer MACs; each block's partial sums
+// are scaled before they are added up in the accumulator.
+struct MxFormat {
+    MxElement element = MxElement::None;
+    uint32_t block_size = 32;
+
+    bool Enabled() const { return element != MxElement::None; }
+
+    // Bits of one element in memory
+    uint32_t ElementBits() const;
+
+    // Fractional bits of an element's fixed-point value in the mesh. Exact for MXINT8 and
+    // MXFP4; MXFP8 rounds to a quarter of its block's scale, below fp8's own resolution at
+    // the block maximum, so that products of up to 512 elements fit the 32-bit accumulators.
+    uint32_t FractionBits() const;
+
+    // Bytes of count consecutive elements along K, including a scale byte per started block
+    uint64_t Bytes(uint64_t count) const;
+
+    // Blocks covering count consecutive elements along K
+    uint32_t Blocks(uint32_t count) const;
+
+    // Largest magnitude an element can hold
+    double MaxElement() const;
+
+    // Shared exponent for a block whose largest magnitude is maxAbs
+    int32_t BlockScale(double maxAbs) const;
+
+    // Round value / 2^scale to the element format and return it in mesh fixed point
+    int16_t Quantize(double value, int32_t scale) const;
+
+    // Real value of a mesh fixed-point element in a block with the given scale
+    double Dequantize(int32_t fixed, int32_t scale) const;
+
+    // Quantize count values (at most one block) into fixed, returns the block's scale
+    int32_t QuantizeBlock(const double* values, size_t count, int16_t* fixed) const;
+
+    // Real value of a sum of fixed-point products of a block of A with scale scaleA and a
+    // block of B with scale scaleB
+    double ScaleSum(int64_t sum, int32_t scaleA, int32_t scaleB) const;
+};
+
+END_NS(gemmini)
@@ -0,0 +1,60 @@
+// packed_int.hpp - Packed int4 weights and int8 activations in 16-bit mesh registers
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// Saturate a value to a signed integer of the given width
+inline int16_t SaturateInt(int32_t value, uint32_t bits) {
+    const int32_t max = (1 << (bits - 1)) - 1;
+    return static_cast<int16_t>(std::clamp(value, -max - 1, max));
+}
+
+// Two int4 weights in the low byte of a register, lane 0 in the low nibble
+inline int16_t PackInt4(int32_t lane0, int32_t lane1) {
+    return static_cast<int16_t>((SaturateInt(lane0, 4) & 0xF) |
+                                ((SaturateInt(lane1, 4) & 0xF) << 4));
+}
+
+// Sign-extended int4 weight of a lane
+inline int32_t UnpackInt4(int16_t packed, uint32_t lane) {
+    int32_t nibble = (packed >> (4 * lane)) & 0xF;
+    return nibble >= 8 ? nibble - 16 : nibble;
+}
+
+// Two int8 activations in a register, lane 0 in the low byte
+inline int16_t PackInt8(int32_t lane0, int32_t lane1) {
+    return static_cast<int16_t>((SaturateInt(lane0, 8) & 0xFF) |
+                                ((SaturateInt(lane1, 8) & 0xFF) << 8));
+}
+
+// Sign-extended int8 activation of a lane
+inline int32_t UnpackInt8(int16_t packed, uint32_t lane) {
+    return static_cast<int8_t>((packed >> (8 * lane)) & 0xFF);
+}
+
+// MACs a PE does per cycle; only packed int4 weights have a second lane
+inline uint32_t PackedMacs(uint32_t weightBits, uint32_t macs) {
+    return weightBits > 4 ? 1 : std::min<uint32_t>(2, std::max<uint32_t>(1, macs));
+}
+
+// Products one PE adds in a cycle. 4-bit weights are int4 nibbles MACed against int8
+// activations, one lane per MAC the PE does per cycle; wider weights multiply the
+// registers as they are.
+inline int32_t PackedProduct(int16_t weight, int16_t act, uint32_t weightBits,
+                             uint32_t macs) {
+    if (weightBits > 4) {
+        return static_cast<int32_t>(weight) * static_cast<int32_t>(act);
+    }
+    int32_t sum = 0;
+    for (uint32_t lane = 0; lane < macs; ++lane) {
+        sum += UnpackInt4(weight, lane) * UnpackInt8(act, lane);
+    }
+    return sum;
+}
+
+END_NS(gemmini)
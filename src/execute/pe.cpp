@@ -1,5 +1,6 @@
 // pe.cpp - Implementation of Processing Element for Gemmini Systolic Array using SPARTA
 #include "gemmini/pe.hpp"
+#include "utils/memory_footprint.hpp"
 #include "sparta/events/StartupEvent.hpp"
 #include "sparta/kernel/Scheduler.hpp"
 #include "sparta/kernel/SpartaHandler.hpp"
@@ -11,22 +12,26 @@ const char PE::name[] = "pe";
 
 // PE Constructor
 PE::PE(sparta::TreeNode* node, const PEParameterSet* params)
-    : sparta::Unit(node), mPortSet(node), mUnitEventSet(node),
-      mLogger(node, "pe", "Processing Element Log"), 
-      mComputeCycles(params->compute_cycles),
-      mActWidth(params->act_width), 
-      mWeightWidth(params->weight_width),
-      mDelayCycles(params->delay_cycles),
+    : sparta::Unit(node), mPortSet(node),
+      mComputeCycles(params->compute_cycles, "compute_cycles"),
+      mActWidth(params->act_width, "act_width"),
+      mWeightWidth(params->weight_width, "weight_width"),
+      mDelayCycles(params->delay_cycles, "delay_cycles"),
+      mMacsPerCycle(PackedMacs(mWeightWidth, params->macs_per_cycle)),
       mDebugFifo(params->debug_fifo),
-      mTotalMacs(getStatisticSet(), "total_macs", "Count of MAC operations",
-                 sparta::Counter::COUNT_NORMAL),
-      mTickEvent(&mUnitEventSet, "tick_event", CREATE_SPARTA_HANDLER(PE, Tick)) {
-    // Initialize output state
-    mOutput.act = 0;
-    mOutput.psum = 0;
-    mOutput.act_valid = false;
-    mOutput.psum_valid = false;
-    
+      mTickEvent(&getEventSet(), "tick_event", CREATE_SPARTA_HANDLER(PE, Tick)) {
+    // Per-PE statistics read whichever slot is bound at report time
+    if (params->per_pe_stats) {
+        mTotalMacs.reset(new LazyCounter(getStatisticSet(), "total_macs",
+                                         "Count of MAC operations",
+                                         [this]() { return *mMacSlot; }));
+    }
+
+    // Log sources are tree nodes too, so large meshes only pay for them on request
+    if (params->enable_logging) {
+        mLogger.reset(new sparta::log::MessageSource(node, "pe", "Processing Element Log"));
+    }
+
     // Register port handlers
     mPortSet.inputs.weight.registerConsumerHandler(
         CREATE_SPARTA_HANDLER_WITH_DATA(PE, HandleWeight, int16_t));
@@ -35,38 +40,50 @@ PE::PE(sparta::TreeNode* node, const PEParameterSet* params)
     mPortSet.inputs.partialSum.registerConsumerHandler(
         CREATE_SPARTA_HANDLER_WITH_DATA(PE, HandlePartialSum, int32_t));
 
-    // Create delay FIFOs for activation and partial sum
+    // Create delay FIFOs for activation and partial sum, each measured as its own unit
     // Create activation delay FIFO
-    std::string act_fifo_name = "act_delay_fifo";
-    sparta::TreeNode* act_fifo_node = new sparta::TreeNode(node, act_fifo_name, "Activation Delay FIFO");
-    DelayFifoParameterSet<int16_t>* act_fifo_params = new DelayFifoParameterSet<int16_t>(act_fifo_node);
-    act_fifo_params->depth = mDelayCycles;
-    act_fifo_params->debug_mode = mDebugFifo;
-    
-    // Create and initialize the activation delay FIFO
-    DelayFifo<int16_t>::Factory act_fifo_factory;
-    DelayFifo<int16_t>* act_fifo = static_cast<DelayFifo<int16_t>*>(
-        act_fifo_factory.createResource(act_fifo_node, act_fifo_params));
-    mActDelayFifo.reset(act_fifo);
-    
-    // Connect FIFO output to PE activation output port
-    mActDelayFifo->GetPortSet().out.bind(&mPortSet.outputs.act);
-    
+    {
+        FootprintScope footprint("DelayFifo");
+        std::string act_fifo_name = "act_delay_fifo";
+        sparta::TreeNode* act_fifo_node =
+            new sparta::TreeNode(node, act_fifo_name, "Activation Delay FIFO");
+        DelayFifoParameterSet<int16_t>* act_fifo_params =
+            new DelayFifoParameterSet<int16_t>(act_fifo_node);
+        act_fifo_params->depth = mDelayCycles;
+        act_fifo_params->debug_mode = mDebugFifo;
+        act_fifo_params->enable_logging = params->enable_logging;
+
+        // Create and initialize the activation delay FIFO
+        DelayFifo<int16_t>::Factory act_fifo_factory;
+        DelayFifo<int16_t>* act_fifo = static_cast<DelayFifo<int16_t>*>(
+            act_fifo_factory.createResource(act_fifo_node, act_fifo_params));
+        mActDelayFifo.reset(act_fifo);
+
+        // Connect FIFO output to PE activation output port
+        mActDelayFifo->GetPortSet().out.bind(&mPortSet.outputs.act);
+    }
+
     // Create partial sum delay FIFO
-    std::string psum_fifo_name = "psum_delay_fifo";
-    sparta::TreeNode* psum_fifo_node = new sparta::TreeNode(node, psum_fifo_name, "Partial Sum Delay FIFO");
-    DelayFifoParameterSet<int32_t>* psum_fifo_params = new DelayFifoParameterSet<int32_t>(psum_fifo_node);
-    psum_fifo_params->depth = mDelayCycles;
-    psum_fifo_params->debug_mode = mDebugFifo;
-    
-    // Create and initialize the partial sum delay FIFO
-    DelayFifo<int32_t>::Factory psum_fifo_factory;
-    DelayFifo<int32_t>* psum_fifo = static_cast<DelayFifo<int32_t>*>(
-        psum_fifo_factory.createResource(psum_fifo_node, psum_fifo_params));
-    mPsumDelayFifo.reset(psum_fifo);
-    
-    // Connect FIFO output to PE partial sum output port
-    mPsumDelayFifo->GetPortSet().out.bind(&mPortSet.outputs.partialSum);
+    {
+        FootprintScope footprint("DelayFifo");
+        std::string psum_fifo_name = "psum_delay_fifo";
+        sparta::TreeNode* psum_fifo_node =
+            new sparta::TreeNode(node, psum_fifo_name, "Partial Sum Delay FIFO");
+        DelayFifoParameterSet<int32_t>* psum_fifo_params =
+            new DelayFifoParameterSet<int32_t>(psum_fifo_node);
+        psum_fifo_params->depth = mDelayCycles;
+        psum_fifo_params->debug_mode = mDebugFifo;
+        psum_fifo_params->enable_logging = params->enable_logging;
+
+        // Create and initialize the partial sum delay FIFO
+        DelayFifo<int32_t>::Factory psum_fifo_factory;
+        DelayFifo<int32_t>* psum_fifo = static_cast<DelayFifo<int32_t>*>(
+            psum_fifo_factory.createResource(psum_fifo_node, psum_fifo_params));
+        mPsumDelayFifo.reset(psum_fifo);
+
+        // Connect FIFO output to PE partial sum output port
+        mPsumDelayFifo->GetPortSet().out.bind(&mPortSet.outputs.partialSum);
+    }
 
     // Create and register tick event
     sparta::StartupEvent(node, CREATE_SPARTA_HANDLER(PE, Tick));
@@ -88,21 +105,21 @@ void PE::HandleWeight(const int16_t & weight) {
 #ifdef DEBUG_PE
     std::cout << "PE: Weight set: " << weight << std::endl;
 #endif
-    mWeightReg = weight;
+    mState->weight = weight;
 }
 
 // Handle activation input from west
 void PE::HandleActivation(const int16_t & act) {
     // Store activation input
-    mInput.act = act;
-    mInput.act_valid = true;
+    mState->input.act = act;
+    mState->input.act_valid = true;
     
     // Set activation output
-    mOutput.act = act;
-    mOutput.act_valid = true;
+    mState->output.act = act;
+    mState->output.act_valid = true;
     
     // Push activation to the delay FIFO for propagation to the next PE
-    mActDelayFifo->Push(mOutput.act);
+    mActDelayFifo->Push(mState->output.act);
 
 #ifdef DEBUG_PE
     std::cout << "PE: Received activation: " << act << std::endl;
@@ -117,12 +134,12 @@ void PE::HandleActivation(const int16_t & act) {
 // Handle partial sum from north
 void PE::HandlePartialSum(const int32_t & partialSum) {
     // Store partial sum input
-    mInput.psum = partialSum;
-    mInput.psum_valid = true;
+    mState->input.psum = partialSum;
+    mState->input.psum_valid = true;
     
     // Initialize output partial sum (will be updated in ComputeMAC)
-    mOutput.psum = partialSum;
-    mOutput.psum_valid = false;
+    mState->output.psum = partialSum;
+    mState->output.psum_valid = false;
     
 #ifdef DEBUG_PE
     std::cout << "PE: Received partial sum: " << partialSum << std::endl;
@@ -137,64 +154,57 @@ void PE::HandlePartialSum(const int32_t & partialSum) {
 // Compute MAC - multiply activation with weight and accumulate with partial sum
 void PE::ComputeMAC() {
     // Perform MAC operation (multiply-accumulate)
-    int32_t product = static_cast<int32_t>(mWeightReg) * static_cast<int32_t>(mInput.act);
+    PEHotState & state = *mState;
+    int32_t product = PackedProduct(state.weight, state.input.act, mWeightWidth, mMacsPerCycle);
     
     // Initialize result with incoming partial sum
-    mPartialSumReg = mInput.psum;
+    state.partial_sum = state.input.psum;
     
     // Add product to the partial sum
-    mPartialSumReg += product;
+    state.partial_sum += product;
     
     // Set output values
-    mOutput.psum = mPartialSumReg;
-    mOutput.psum_valid = true;
-    mOutput.act = mInput.act;
-    mOutput.act_valid = true;
+    state.output.psum = state.partial_sum;
+    state.output.psum_valid = true;
+    state.output.act = state.input.act;
+    state.output.act_valid = true;
     
     // Reset input valid flags for next computation
-    mInput.act_valid = false;
-    mInput.psum_valid = false;
+    state.input.act_valid = false;
+    state.input.psum_valid = false;
     
-    // Count operation for statistics
-    mTotalMacs++;
+    // Count operations for statistics
+    *mMacSlot += mMacsPerCycle;
     
 #ifdef DEBUG_PE
-    std::cout << "PE: MAC - act: " << mInput.act << ", weight: " << mWeightReg 
-              << ", incoming psum: " << mInput.psum 
+    std::cout << "PE: MAC - act: " << state.input.act << ", weight: " << state.weight 
+              << ", incoming psum: " << state.input.psum 
               << ", product: " << product 
-              << ", result: " << mPartialSumReg << std::endl;
+              << ", result: " << state.partial_sum << std::endl;
 #endif
 
     // If compute time > 0, set busy status for delayed computation
     if (mComputeCycles > 0) {
-        mBusy = true;
-        mCycleCounter = mComputeCycles;
+        state.busy = true;
+        state.cycle_counter = mComputeCycles;
     } else {
         // Push the result to the delay FIFO for immediate propagation
-        mPsumDelayFifo->Push(mOutput.psum);
+        mPsumDelayFifo->Push(state.output.psum);
     }
 }
 
-// Tick method - process one cycle (called every clock cycle)
+// Tick method - process one cycle (called every clock cycle) unless the array steps the PE
 void PE::Tick() {
-    if (mBusy) {
-        if (mCycleCounter > 0) {
-            --mCycleCounter;
-#ifdef DEBUG_PE
-            std::cout << "PE: Cycle counter: " << mCycleCounter << std::endl;
-#endif
-        }
-
-        if (mCycleCounter == 0) {
-            // Computation complete, push result to delay FIFO
-            mPsumDelayFifo->Push(mOutput.psum);
-            
-            mBusy = false;
+    if (mSteppedByOwner) {
+        return;
+    }
+    if (StepCompute(*mState)) {
+        // Computation complete, push result to delay FIFO
+        ReleaseResult();
 #ifdef DEBUG_PE
-            std::cout << "PE: Processing complete, partial sum: " << mOutput.psum 
-                      << " pushed to delay FIFO" << std::endl;
+        std::cout << "PE: Processing complete, partial sum: " << mState->output.psum
+                  << " pushed to delay FIFO" << std::endl;
 #endif
-        }
     }
 
     // Schedule next tick using UniqueEvent
@@ -3,8 +3,8 @@
 
 #include <cstdint>
 #include <iostream>
+#include <memory>
 
-#include "sparta/events/EventSet.hpp"
 #include "sparta/events/UniqueEvent.hpp"
 #include "sparta/log/MessageSource.hpp"
 #include "sparta/ports/DataPort.hpp"
@@ -16,7 +16,11 @@
 #include "sparta/simulation/Unit.hpp"
 #include "sparta/statistics/Counter.hpp"
 #include "gemmini/common.hpp"
+#include "execute/packed_int.hpp"
+#include "execute/pe_state.hpp"
 #include "utils/fifo.hpp"
+#include "utils/lazy_counter.hpp"
+#include "utils/profile.hpp"
 
 BEGIN_NS(gemmini)
 
@@ -33,9 +37,14 @@ public:
     // Parameters
     PARAMETER(uint32_t, compute_cycles, 0, "Cycles required for MAC operation")
     PARAMETER(uint32_t, act_width, 16, "Activation data width in bits")
-    PARAMETER(uint32_t, weight_width, 16, "Weight data width in bits")
+    PARAMETER(uint32_t, weight_width, 16,
+              "Weight data width in bits, 4 unpacks int4 nibbles against int8 activations")
+    PARAMETER(uint32_t, macs_per_cycle, 1,
+              "MACs per cycle with 4-bit weights, 2 holds two weights and two activations")
     PARAMETER(uint32_t, delay_cycles, 1, "Cycles of delay between connected PEs")
     PARAMETER(bool, debug_fifo, false, "Enable debug output for delay FIFOs")
+    PARAMETER(bool, per_pe_stats, true, "Create this PE's own statistics counters")
+    PARAMETER(bool, enable_logging, false, "Create log sources for this PE and its delay FIFOs")
 };
 
 // Port Set for PE
@@ -79,21 +88,9 @@ public:
 // Processing Element class - basic compute unit for the systolic array
 class PE : public sparta::Unit {
 public:
-    // Input data structure for PE
-    struct PEInput {
-        int16_t act = 0;      // Activation input
-        int32_t psum = 0;     // Partial sum input
-        bool act_valid = false;  // Is activation data valid
-        bool psum_valid = false; // Is partial sum data valid
-    };
-
-    // Output data structure for PE
-    struct PEOutput {
-        int16_t act = 0;      // Activation output (to east)
-        int32_t psum = 0;     // Partial sum output (to south)
-        bool act_valid = false;  // Is activation data valid
-        bool psum_valid = false; // Is partial sum data valid
-    };
+    // Input and output data, kept in the PE's hot state
+    using PEInput = ::gemmini::PEInput;
+    using PEOutput = ::gemmini::PEOutput;
 
     // Static name for this resource
     static const char name[];
@@ -119,35 +116,47 @@ public:
     void ReceiveActivation(int16_t act);
     void ReceivePartialSum(int32_t partialSum);
 
+    // Count MACs into an external slot (e.g. the array's dense statistics table)
+    void BindMacSlot(uint64_t* slot) { mMacSlot = slot; }
+    uint64_t GetTotalMacs() const { return *mMacSlot; }
+
+    // Keep the per-cycle state in an external slot (e.g. the array's PEStateTable); the
+    // current state moves into the slot. The owner of the table then steps the PE's MAC
+    // countdown and calls ReleaseResult, and the PE stops ticking itself.
+    void BindHotState(PEHotState* slot) {
+        *slot = *mState;
+        mState = slot;
+        mSteppedByOwner = true;
+    }
+    const PEHotState & GetHotState() const { return *mState; }
+
+    // Send the result of a finished multi-cycle MAC to the PE below
+    void ReleaseResult() { mPsumDelayFifo->Push(mState->output.psum); }
+
 private:
     // Port set
     PEPortSet mPortSet;
 
-    // Event set for scheduling
-    sparta::EventSet mUnitEventSet;
+    // Logger, only created when logging is enabled for this PE
+    std::unique_ptr<sparta::log::MessageSource> mLogger;
 
-    // Logger
-    sparta::log::MessageSource mLogger;
+    // Weights, registers, inputs and outputs, in mLocalState unless bound to a table
+    PEHotState mLocalState;
+    PEHotState* mState = &mLocalState;
+    bool mSteppedByOwner = false;
 
-    // Input and output state
-    PEInput mInput;           // Current input data
-    PEOutput mOutput;         // Current output data
-    
-    // Processing state
-    int16_t mWeightReg = 0;       // Weight stored in PE
-    int32_t mPartialSumReg = 0;   // Partial sum register (result)
-    bool mBusy = false;           // Busy status
-    uint32_t mCycleCounter = 0;   // Cycles remaining for computation
-    
-    // Configuration from parameters
-    const uint32_t mComputeCycles;
-    const uint32_t mActWidth;
-    const uint32_t mWeightWidth;
-    const uint32_t mDelayCycles;
+    // Configuration from parameters, constants in a profile build
+    const ProfileParam<Profile::kComputeCycles> mComputeCycles;
+    const ProfileParam<Profile::kActWidth> mActWidth;
+    const ProfileParam<Profile::kWeightWidth> mWeightWidth;
+    const ProfileParam<Profile::kDelayCycles> mDelayCycles;
+    const uint32_t mMacsPerCycle;
     const bool mDebugFifo;
 
-    // Statistics
-    sparta::Counter mTotalMacs; // Count of MAC operations
+    // Statistics - MACs are counted into mMacSlot, the counter is only created on request
+    uint64_t mLocalMacs = 0;                  // Slot used when no external slot is bound
+    uint64_t* mMacSlot = &mLocalMacs;         // Where MACs are counted
+    std::unique_ptr<LazyCounter> mTotalMacs;  // Count of MAC operations
 
     // Tick event for cycle-level computation
     sparta::UniqueEvent<> mTickEvent;
@@ -165,7 +174,7 @@ private:
     
     // Check if we can perform computation
     bool CanCompute() const {
-        return mInput.act_valid && mInput.psum_valid && !mBusy;
+        return mState->input.act_valid && mState->input.psum_valid && !mState->busy;
     }
 };
 
@@ -0,0 +1,84 @@
+// pe_state.hpp - Per-cycle PE state kept in a dense table for the whole array
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// Input data latched by a PE
+struct PEInput {
+    int32_t psum = 0;        // Partial sum input (from north)
+    int16_t act = 0;         // Activation input (from west)
+    bool act_valid = false;  // Is activation data valid
+    bool psum_valid = false; // Is partial sum data valid
+};
+
+// Output data a PE forwards
+struct PEOutput {
+    int32_t psum = 0;        // Partial sum output (to south)
+    int16_t act = 0;         // Activation output (to east)
+    bool act_valid = false;  // Is activation data valid
+    bool psum_valid = false; // Is partial sum data valid
+};
+
+// State a PE touches every cycle. The rest of a PE (ports, events, FIFOs, statistics) is
+// only used for wiring and reporting, so the array keeps this part of every PE packed in
+// one table where neighbouring PEs share cache lines.
+struct alignas(32) PEHotState {
+    PEInput input;               // Current input data
+    PEOutput output;             // Current output data
+    int32_t partial_sum = 0;     // Partial sum register (result)
+    uint32_t cycle_counter = 0;  // Cycles remaining for computation
+    int16_t weight = 0;          // Weight stored in the PE
+    bool busy = false;           // A MAC with compute_cycles > 0 is in progress
+};
+
+static_assert(sizeof(PEHotState) == 32, "Two PEs' hot state should share a cache line");
+
+// Count down a MAC in progress, returns true on the cycle its result is ready
+inline bool StepCompute(PEHotState & state) {
+    if (!state.busy) {
+        return false;
+    }
+    if (state.cycle_counter > 0) {
+        --state.cycle_counter;
+    }
+    if (state.cycle_counter > 0) {
+        return false;
+    }
+    state.busy = false;
+    return true;
+}
+
+// PEStateTable - hot state of all PEs of an array in one dense row-major table. The table
+// is sized once, so slots handed to PEs stay valid.
+class PEStateTable {
+public:
+    PEStateTable(uint32_t rows, uint32_t cols) : mCols(cols), mStates(rows * cols) {}
+
+    // Slot a PE keeps its hot state in
+    PEHotState* Slot(uint32_t row, uint32_t col) { return &mStates[row * mCols + col]; }
+    const PEHotState & At(uint32_t row, uint32_t col) const { return mStates[row * mCols + col]; }
+
+    size_t Size() const { return mStates.size(); }
+
+    // Advance every PE's MAC countdown by one cycle in table order, calling done(index) for
+    // each PE whose result is ready
+    template <typename Done>
+    void Step(Done && done) {
+        for (size_t i = 0; i < mStates.size(); ++i) {
+            if (StepCompute(mStates[i])) {
+                done(i);
+            }
+        }
+    }
+
+private:
+    const uint32_t mCols;
+    std::vector<PEHotState> mStates;
+};
+
+END_NS(gemmini)
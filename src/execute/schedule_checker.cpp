@@ -0,0 +1,299 @@
+// schedule_checker.cpp - Implementation of the static tile schedule checker
+#include "execute/schedule_checker.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace gemmini {
+
+// Errors beyond this count are summarized instead of listed
+static const size_t kMaxListedErrors = 16;
+
+// State of one scratchpad buffer during the pass
+struct SpadBufferState {
+    bool loaded = false;
+    TileOperand operand = TileOperand::A;
+    uint64_t bytes = 0;
+    uint64_t ready_at = 0;      // Cycle the last load completes
+    uint64_t last_read_end = 0; // Cycle the last array read completes
+};
+
+// State of one accumulator buffer during the pass
+struct AccBufferState {
+    bool has_results = false;
+    uint64_t bytes = 0;
+    uint64_t ready_at = 0; // Cycle the last compute completes
+    uint32_t row_block = 0;
+    uint32_t col_block = 0;
+    uint32_t k_blocks = 0; // K tiles summed so far
+};
+
+static uint64_t CeilDiv(uint64_t a, uint64_t b) { return (a + b - 1) / b; }
+
+ScheduleReport ScheduleChecker::Check(const TileSchedule & schedule) const {
+    ScheduleReport report;
+    size_t suppressedErrors = 0;
+    auto error = [&](size_t idx, const TileOp & op, const std::string & msg) {
+        report.ok = false;
+        if (report.errors.size() >= kMaxListedErrors) {
+            ++suppressedErrors;
+            return;
+        }
+        std::stringstream ss;
+        ss << "op " << idx << " (" << op << "): " << msg;
+        report.errors.push_back(ss.str());
+    };
+
+    const uint32_t tileRows = schedule.TileRows();
+    const uint32_t tileCols = schedule.TileCols();
+    const uint32_t banks = std::max(1u, mConfig.scratchpad_banks);
+    const uint64_t bandwidth = std::max(1u, mConfig.dma_bytes_per_cycle);
+
+    auto blockRows = [&](uint32_t rb) {
+        return std::min<uint64_t>(tileRows, schedule.M() - uint64_t(rb) * tileRows);
+    };
+    auto blockCols = [&](uint32_t cb) {
+        return std::min<uint64_t>(tileCols, schedule.N() - uint64_t(cb) * tileCols);
+    };
+
+    std::vector<SpadBufferState> spad(schedule.NumBuffers());
+    std::vector<AccBufferState> acc(schedule.NumAccBuffers());
+    std::vector<uint64_t> bankArrayBusy(banks, 0);
+    std::vector<uint64_t> bankDmaBusy(banks, 0);
+    std::vector<bool> stored(uint64_t(schedule.RowBlocks()) * schedule.ColBlocks(), false);
+
+    uint64_t spadUsed = 0;
+    uint64_t accUsed = 0;
+    uint64_t dmaFree = 0;
+    uint64_t arrayFree = 0;
+    uint64_t weightsReadyAt = 0;
+    bool weightsLoaded = false;
+    uint64_t end = 0;
+
+    // Operations cannot start before the host has issued them
+    HostInterface host(mHost);
+    auto waitForHost = [&](uint64_t start, uint64_t issued) {
+        if (issued > start) {
+            report.host_stall_cycles += issued - start;
+        }
+        return std::max(start, issued);
+    };
+
+    for (size_t i = 0; i < schedule.Size(); ++i) {
+        const TileOp & op = schedule[i];
+        const uint64_t issued = host.Issue();
+        uint64_t retired = issued;
+
+        switch (op.type) {
+        case TileOpType::Load: {
+            // A row blocks span all of K, B tiles one K tile
+            SpadBufferState & buf = spad[op.buffer];
+            uint64_t weightRows = schedule.KTileRows(op.k_block);
+            uint64_t bytes = op.operand == TileOperand::A
+                                 ? blockRows(op.row_block) * mConfig.ActivationBytes(schedule.K())
+                                 : blockCols(op.col_block) * mConfig.WeightBytes(weightRows);
+
+            // Capacity: the buffer keeps its space until it is reloaded
+            spadUsed = spadUsed - buf.bytes + bytes;
+            report.peak_scratchpad_bytes = std::max(report.peak_scratchpad_bytes, spadUsed);
+            if (spadUsed > mConfig.scratchpad_bytes) {
+                error(i, op, "scratchpad overflow (" + std::to_string(spadUsed) + " of " +
+                                 std::to_string(mConfig.scratchpad_bytes) + " bytes)");
+            }
+
+            // A load may not overwrite data the array is still reading
+            uint64_t start = waitForHost(std::max(dmaFree, buf.last_read_end), issued);
+            uint32_t bank = op.buffer % banks;
+            if (start < bankArrayBusy[bank]) {
+                report.bank_conflicts++;
+                report.bank_conflict_cycles += bankArrayBusy[bank] - start;
+                start = bankArrayBusy[bank];
+            }
+            uint64_t transfer = CeilDiv(bytes, bandwidth);
+            dmaFree = start + transfer;
+            buf.ready_at = dmaFree + mConfig.dma_latency;
+            bankDmaBusy[bank] = std::max(bankDmaBusy[bank], buf.ready_at);
+            buf.loaded = true;
+            buf.operand = op.operand;
+            buf.bytes = bytes;
+            end = std::max(end, buf.ready_at);
+            retired = buf.ready_at;
+            break;
+        }
+
+        case TileOpType::Preload:
+        case TileOpType::Compute: {
+            SpadBufferState & buf = spad[op.buffer];
+            TileOperand expected =
+                op.type == TileOpType::Preload ? TileOperand::B : TileOperand::A;
+            if (!buf.loaded) {
+                error(i, op, "reads scratchpad buffer " + std::to_string(op.buffer) +
+                                 " before it is loaded");
+                break;
+            }
+            if (buf.operand != expected) {
+                error(i, op, std::string("reads an ") +
+                                 (buf.operand == TileOperand::A ? "A" : "B") + " buffer");
+            }
+
+            uint64_t ready = buf.ready_at;
+            if (op.type == TileOpType::Compute) {
+                if (!weightsLoaded) {
+                    error(i, op, "computes before any weights are preloaded");
+                }
+                AccBufferState & out = acc[op.acc_buffer];
+                if (op.k_block == 0 && out.has_results) {
+                    error(i, op, "overwrites unstored results of block [" +
+                                     std::to_string(out.row_block) + "," +
+                                     std::to_string(out.col_block) + "]");
+                    accUsed -= out.bytes;
+                    out.has_results = false;
+                }
+                if (op.k_block > 0 &&
+                    (!out.has_results || out.row_block != op.row_block ||
+                     out.col_block != op.col_block || out.k_blocks != op.k_block)) {
+                    error(i, op, "adds K tile " + std::to_string(op.k_block) +
+                                     " to partial sums that do not hold K tiles 0.." +
+                                     std::to_string(op.k_block - 1) + " of its block");
+                }
+                ready = std::max(ready, weightsReadyAt);
+            }
+
+            // Dependency stall: the array idles until the operands arrive
+            uint64_t start = std::max(arrayFree, ready);
+            if (ready > arrayFree) {
+                report.dependency_stall_cycles += ready - arrayFree;
+            }
+            start = waitForHost(start, issued);
+
+            // Bank conflict with an in-flight DMA write to another buffer of the same bank
+            uint32_t bank = op.buffer % banks;
+            if (start < bankDmaBusy[bank]) {
+                report.bank_conflicts++;
+                report.bank_conflict_cycles += bankDmaBusy[bank] - start;
+                start = bankDmaBusy[bank];
+            }
+
+            uint64_t duration;
+            if (op.type == TileOpType::Preload) {
+                // Weights shift in one row per cycle
+                duration = tileRows;
+                weightsReadyAt = start + duration;
+                weightsLoaded = true;
+            } else {
+                // One pass per K tile: rows stream back to back, plus fill and drain of the
+                // array. Later K tiles accumulate in place and take no new space. With MX
+                // operands the rows stream once per block the K tile overlaps.
+                uint64_t passes = 1;
+                const MxFormat & format = mConfig.operand_format;
+                uint32_t kRows = schedule.KTileRows(op.k_block);
+                if (format.Enabled() && kRows > 0) {
+                    uint64_t kBegin = uint64_t(op.k_block) * schedule.KTile();
+                    passes = (kBegin + kRows - 1) / format.block_size -
+                             kBegin / format.block_size + 1;
+                }
+                duration = passes * blockRows(op.row_block) + tileRows + tileCols - 1 +
+                           mConfig.compute_cycles;
+                AccBufferState & out = acc[op.acc_buffer];
+                out.ready_at = start + duration;
+                if (!out.has_results) {
+                    out.bytes = blockRows(op.row_block) * blockCols(op.col_block) *
+                                mConfig.acc_element_bytes;
+                    out.has_results = true;
+                    out.row_block = op.row_block;
+                    out.col_block = op.col_block;
+                    out.k_blocks = 0;
+                    accUsed += out.bytes;
+                }
+                out.k_blocks++;
+                report.peak_accumulator_bytes = std::max(report.peak_accumulator_bytes, accUsed);
+                if (accUsed > mConfig.accumulator_bytes) {
+                    error(i, op, "accumulator overflow (" + std::to_string(accUsed) + " of " +
+                                     std::to_string(mConfig.accumulator_bytes) + " bytes)");
+                }
+            }
+            arrayFree = start + duration;
+            buf.last_read_end = std::max(buf.last_read_end, arrayFree);
+            bankArrayBusy[bank] = std::max(bankArrayBusy[bank], arrayFree);
+            end = std::max(end, arrayFree);
+            retired = arrayFree;
+            break;
+        }
+
+        case TileOpType::Store: {
+            AccBufferState & out = acc[op.acc_buffer];
+            if (!out.has_results) {
+                error(i, op, "stores accumulator buffer " + std::to_string(op.acc_buffer) +
+                                 " which holds no results");
+                break;
+            }
+            if (out.row_block != op.row_block || out.col_block != op.col_block) {
+                error(i, op, "stores results of block [" + std::to_string(out.row_block) + "," +
+                                 std::to_string(out.col_block) + "]");
+            }
+            if (out.k_blocks < schedule.KBlocks()) {
+                error(i, op, "stores partial sums of " + std::to_string(out.k_blocks) + " of " +
+                                 std::to_string(schedule.KBlocks()) + " K tiles");
+            }
+
+            uint64_t start = waitForHost(std::max(dmaFree, out.ready_at), issued);
+            dmaFree = start + CeilDiv(out.bytes, bandwidth);
+            end = std::max(end, dmaFree + mConfig.dma_latency);
+            retired = dmaFree + mConfig.dma_latency;
+            accUsed -= out.bytes;
+            out.has_results = false;
+            stored[uint64_t(op.row_block) * schedule.ColBlocks() + op.col_block] = true;
+            break;
+        }
+        }
+        host.Retire(retired);
+    }
+
+    // The host fences once everything has retired
+    end = host.Fence(end);
+
+    // Every result block has to be written out
+    uint32_t missing = std::count(stored.begin(), stored.end(), false);
+    if (missing > 0) {
+        report.ok = false;
+        report.errors.push_back(std::to_string(missing) + " result block(s) are never stored");
+    }
+    if (suppressedErrors > 0) {
+        report.errors.push_back("... " + std::to_string(suppressedErrors) + " more error(s)");
+    }
+
+    if (report.bank_conflicts > 0) {
+        report.warnings.push_back(std::to_string(report.bank_conflicts) +
+                                  " scratchpad bank conflict(s) cost " +
+                                  std::to_string(report.bank_conflict_cycles) + " cycles");
+    }
+    if (end > 0 && report.dependency_stall_cycles * 2 > end) {
+        report.warnings.push_back("array waits on loads for more than half of the run");
+    }
+    if (end > 0 && report.host_stall_cycles * 2 > end) {
+        report.warnings.push_back("operations wait on host command issue for more than half "
+                                  "of the run");
+    }
+
+    report.estimated_cycles = end;
+    return report;
+}
+
+std::ostream & operator<<(std::ostream & os, const ScheduleReport & report) {
+    os << "Schedule " << (report.ok ? "OK" : "REJECTED") << std::endl;
+    os << "  estimated cycles:       " << report.estimated_cycles << std::endl;
+    os << "  dependency stalls:      " << report.dependency_stall_cycles << std::endl;
+    os << "  bank conflicts:         " << report.bank_conflicts << " ("
+       << report.bank_conflict_cycles << " cycles)" << std::endl;
+    os << "  host stalls:            " << report.host_stall_cycles << std::endl;
+    os << "  peak scratchpad bytes:  " << report.peak_scratchpad_bytes << std::endl;
+    os << "  peak accumulator bytes: " << report.peak_accumulator_bytes << std::endl;
+    for (const auto & msg : report.errors) {
+        os << "  error: " << msg << std::endl;
+    }
+    for (const auto & msg : report.warnings) {
+        os << "  warning: " << msg << std::endl;
+    }
+    return os;
+}
+
+} // namespace gemmini
@@ -0,0 +1,79 @@
+// schedule_checker.hpp - Static checker for Gemmini tile schedules
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gemmini/common.hpp"
+#include "execute/host_interface.hpp"
+#include "execute/mx_format.hpp"
+#include "execute/tile_schedule.hpp"
+
+BEGIN_NS(gemmini)
+
+// Memory system parameters the checker models
+struct MemoryConfig {
+    uint64_t scratchpad_bytes = 256 * 1024;  // Scratchpad capacity
+    uint32_t scratchpad_banks = 4;           // Scratchpad banks, buffer b maps to bank b % banks
+    uint64_t accumulator_bytes = 64 * 1024;  // Accumulator capacity
+    uint32_t element_bytes = 2;              // Input element size
+    uint32_t acc_element_bytes = 4;          // Accumulator element size
+    uint32_t dma_bytes_per_cycle = 16;       // DMA bandwidth
+    uint32_t dma_latency = 20;               // Fixed DMA latency per transfer
+    uint32_t compute_cycles = 0;             // PE MAC latency
+    MxFormat operand_format;                 // MX block format of the inputs, if any
+    bool int4_weights = false;               // Weights packed two per byte, activations int8
+    uint32_t weights_per_pe = 1;             // K elements a PE covers, 2 with dual int4 MACs
+
+    // Bytes of an operand vector of count elements along K; MX formats replace
+    // element_bytes with their packed elements plus block scales
+    uint64_t OperandBytes(uint64_t count) const {
+        return operand_format.Enabled() ? operand_format.Bytes(count) : count * element_bytes;
+    }
+
+    // Bytes of count activations (A) and count weights (B) along K
+    uint64_t ActivationBytes(uint64_t count) const {
+        return int4_weights ? count : OperandBytes(count);
+    }
+    uint64_t WeightBytes(uint64_t count) const {
+        return int4_weights ? (count + 1) / 2 : OperandBytes(count);
+    }
+};
+
+// Result of checking one schedule
+struct ScheduleReport {
+    bool ok = true;                        // No errors found
+    std::vector<std::string> errors;       // Problems that make the schedule invalid
+    std::vector<std::string> warnings;     // Problems that only cost performance
+    uint64_t estimated_cycles = 0;         // Predicted end-to-end cycles
+    uint64_t dependency_stall_cycles = 0;  // Array cycles spent waiting on loads
+    uint64_t bank_conflict_cycles = 0;     // Cycles lost to scratchpad bank conflicts
+    uint64_t host_stall_cycles = 0;        // Cycles operations waited for the host to issue them
+    uint32_t bank_conflicts = 0;           // Number of bank conflicts
+    uint64_t peak_scratchpad_bytes = 0;    // Peak scratchpad occupancy
+    uint64_t peak_accumulator_bytes = 0;   // Peak accumulator occupancy
+};
+
+// ScheduleChecker - single-pass analysis of a tile schedule against a memory configuration.
+// It checks buffer dependencies and capacities and runs a coarse DMA/array timeline to
+// predict stalls, bank conflicts and the total cycle count, without simulating the array.
+// Every operation is one host command; the estimate includes issuing them and the closing
+// fence under the given host configuration.
+class ScheduleChecker {
+public:
+    explicit ScheduleChecker(const MemoryConfig & config, const HostConfig & host = HostConfig())
+        : mConfig(config), mHost(host) {}
+
+    ScheduleReport Check(const TileSchedule & schedule) const;
+
+private:
+    const MemoryConfig mConfig;
+    const HostConfig mHost;
+};
+
+// Print a report in readable form
+std::ostream & operator<<(std::ostream & os, const ScheduleReport & report);
+
+END_NS(gemmini)
@@ -1,8 +1,10 @@
 // systolic_array.cpp - Implementation of Systolic Array for Gemmini using SPARTA
 #include "gemmini/systolic_array.hpp"
+#include "utils/memory_footprint.hpp"
 #include "sparta/events/StartupEvent.hpp"
 #include "sparta/kernel/Scheduler.hpp"
 #include "sparta/kernel/SpartaHandler.hpp"
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -12,12 +14,22 @@ const char SystolicArray::name[] = "systolic_array";
 
 // Constructor
 SystolicArray::SystolicArray(sparta::TreeNode* node, const SystolicArrayParameterSet* params)
-    : sparta::Unit(node), mPortSet(node), mUnitEventSet(node),
+    : sparta::Unit(node), mPortSet(node),
       mLogger(node, "systolic_array", "Processing Element Log"),
-      mRows(params->rows), mCols(params->cols), mComputeCycles(params->compute_cycles),
+      mRows(params->rows, "rows"), mCols(params->cols, "cols"),
+      mComputeCycles(params->compute_cycles, "compute_cycles"),
+      mWeightWidth(params->weight_width, "weight_width"),
+      mMacsPerCycle(PackedMacs(mWeightWidth, params->macs_per_cycle)),
+      mPEState(mRows, mCols), mWaveQueue(mRows, params->overlap_waves),
       mTotalMatrixOps(getStatisticSet(), "total_matrix_ops", "Count of matrix operations",
                       sparta::Counter::COUNT_NORMAL),
-      mTickEvent(&mUnitEventSet, "tick_event", CREATE_SPARTA_HANDLER(SystolicArray, Tick)) {
+      mOverlappedWaves(getStatisticSet(), "overlapped_waves",
+                       "Vectors that entered the mesh while an earlier vector was in flight",
+                       sparta::Counter::COUNT_NORMAL),
+      mMeshStats(mRows, mCols),
+      mTotalMacs(getStatisticSet(), "total_macs", "Count of MAC operations in the array",
+                 [this]() { return mMeshStats.TotalMacs(); }),
+      mTickEvent(&getEventSet(), "tick_event", CREATE_SPARTA_HANDLER(SystolicArray, Tick)) {
     // Register port handlers
     mPortSet.in_weights.registerConsumerHandler(
         CREATE_SPARTA_HANDLER_WITH_DATA(SystolicArray, HandleWeights, MatrixPtr));
@@ -26,9 +38,24 @@ SystolicArray::SystolicArray(sparta::TreeNode* node, const SystolicArrayParamete
     mPortSet.in_control.registerConsumerHandler(
         CREATE_SPARTA_HANDLER_WITH_DATA(SystolicArray, HandleControl, uint32_t));
 
+    // Row and column aggregates of the dense MAC table
+    for (uint32_t r = 0; r < mRows; ++r) {
+        mRowMacs.emplace_back(new LazyCounter(
+            getStatisticSet(), "row_" + std::to_string(r) + "_macs",
+            "Count of MAC operations in row " + std::to_string(r),
+            [this, r]() { return mMeshStats.RowMacs(r); }));
+    }
+    for (uint32_t c = 0; c < mCols; ++c) {
+        mColMacs.emplace_back(new LazyCounter(
+            getStatisticSet(), "col_" + std::to_string(c) + "_macs",
+            "Count of MAC operations in column " + std::to_string(c),
+            [this, c]() { return mMeshStats.ColMacs(c); }));
+    }
+
     // Create Processing Elements
     for (uint32_t r = 0; r < mRows; ++r) {
         for (uint32_t c = 0; c < mCols; ++c) {
+            FootprintScope footprint("PE");
             std::string pe_name = GetPEName(r, c);
             std::string pe_desc = "Processing Element at (" + std::to_string(r) + "," + std::to_string(c) + ")";
             sparta::TreeNode* pe_node = node->getChild(pe_name.c_str());
@@ -41,10 +68,17 @@ SystolicArray::SystolicArray(sparta::TreeNode* node, const SystolicArrayParamete
             // Create PE factory and parameters
             PEParameterSet* pe_params = new PEParameterSet(pe_node);
             pe_params->compute_cycles = mComputeCycles;
+            pe_params->per_pe_stats = params->per_pe_stats;
+            pe_params->enable_logging = params->pe_logging;
+            pe_params->weight_width = mWeightWidth;
+            pe_params->act_width = mWeightWidth <= 4 ? 8 : 16;
+            pe_params->macs_per_cycle = mMacsPerCycle;
             
             // Create PE using factory
             PE::Factory pe_factory;
             PE* pe = static_cast<PE*>(pe_factory.createResource(pe_node, pe_params));
+            pe->BindMacSlot(mMeshStats.MacSlot(r, c));
+            pe->BindHotState(mPEState.Slot(r, c));
             mPEs.push_back(pe);
             
             // Connect PE ports to neighbors
@@ -87,67 +121,59 @@ void SystolicArray::HandleWeights(const MatrixPtr & weights) {
         return;
     }
 
-    // Load weights into PEs
+    // Load weights into PEs; waves already in flight keep the weights they entered with
     for (uint32_t r = 0; r < mRows; ++r) {
         for (uint32_t c = 0; c < mCols; ++c) {
             GetPE(r, c)->SetWeight(weights->get(r, c));
         }
     }
-    
+    mWaveQueue.Preload(weights);
+
+#ifdef DEBUG_SYSTOLIC_ARRAY
     std::cout << "Weights preloaded into systolic array" << std::endl;
+#endif
 }
 
 // Handle input vector (activations)
 void SystolicArray::HandleVector(const VectorPtr & input) {
-    // Save input for processing
-    mCurrentInput = input;
-    
-    // Initialize result matrix if needed
-    if (!mResultMatrix || mResultMatrix->rows != mRows || mResultMatrix->cols != 1) {
-        mResultMatrix = std::make_shared<Matrix>(mRows, 1);
-    }
-    
-    // Clear result matrix
-    mResultMatrix->fillZero();
-    
-    // Start processing
-    mProcessing = true;
-    mCurrentCycle = 0;
-    
     // Calculate total cycles needed - must account for:
     // 1. Time for data to flow diagonally through array (rows + cols - 1 cycles)
     // 2. PE computation time (mComputeCycles)
     // 3. One cycle for each PE-to-PE data transfer (rows - 1 + cols - 1 = rows + cols - 2 cycles)
     // 4. Additional cycles for final results to propagate out of the array
     mTotalCyclesNeeded = (mRows + mCols - 1) + mComputeCycles + (mRows + mCols - 2) + mRows;
-    
-    std::cout << "Input received, starting matrix-vector multiplication, will take "
-              << mTotalCyclesNeeded << " cycles" << std::endl;
+
+    // The vector enters at the left edge once the wave ahead of it has cleared the feed
+    mWaveQueue.Push(input);
     mTotalMatrixOps++;
 }
 
 // Handle control signals
 void SystolicArray::HandleControl(const uint32_t & signal) {
     // Control signals can be implemented as needed
+#ifdef DEBUG_SYSTOLIC_ARRAY
     std::cout << "Control signal received: " << signal << std::endl;
+#else
+    (void)signal;
+#endif
 }
 
-// Process one cycle of computation
-void SystolicArray::ProcessOneCycle() {
+// Process one cycle of computation for one wave
+void SystolicArray::ProcessOneCycle(WaveQueue::Wave & wave) {
     // If we're in the initial feeding phase
-    if (mCurrentCycle < mRows + mCols - 1) { // Diagonal wave front with skewed scheduling
+    if (wave.cycle < mRows + mCols - 1) { // Diagonal wave front with skewed scheduling
         // Feed activations from the left edge with proper skewing to account for propagation delays
         for (uint32_t r = 0; r < mRows; ++r) {
             // Calculate which column to feed based on skewed scheduling
             // This ensures data enters PEs in the correct cycle accounting for propagation
-            int32_t col = mCurrentCycle - r;
+            int32_t col = wave.cycle - r;
             
             // Only feed if the calculated column is valid and within input size
             if (col >= 0 && col < static_cast<int32_t>(mCols) && 
-                r < mCurrentInput->size()) {
+                r < wave.input->size()) {
                 
                 // Get activation value from input vector
-                int16_t input_val = mCurrentInput->get(r);
+                int16_t input_val = wave.input->get(r);
                 
                 // Feed activation to the appropriate PE
                 if (col == 0) { // Only feed at the left edge of the array
@@ -159,63 +185,55 @@ void SystolicArray::ProcessOneCycle() {
     
     // Feed zero partial sums to the top row PEs
     // We do this every cycle to maintain the flow of partial sums through the array
-    if (mCurrentCycle < mRows + mCols + mComputeCycles) {
+    if (wave.cycle < mRows + mCols + mComputeCycles) {
         for (uint32_t c = 0; c < mCols; ++c) {
             // Calculate which column to feed based on skewed scheduling
-            if (c <= mCurrentCycle && mCurrentCycle - c < mRows) {
+            if (c <= wave.cycle && wave.cycle - c < mRows) {
                 GetPE(0, c)->ReceivePartialSum(0);
             }
         }
     }
     
-    // Check if computation is complete
-    if (mCurrentCycle >= mTotalCyclesNeeded) {
-        ComputationComplete();
-    }
-    
     // Increment cycle counter
-    mCurrentCycle++;
+    wave.cycle++;
 }
 
-// Called when matrix-vector multiplication is complete
-void SystolicArray::ComputationComplete() {
-    // Get results from the bottom row PEs
-    for (uint32_t c = 0; c < mCols; ++c) {
-        // The final results come out from the bottom of each column
-        if (c < mResultMatrix->cols) {
-            // Read partial sum from bottom PE of this column
-            PE* bottom_pe = GetPE(mRows - 1, c);
-            
-            // In a real implementation, we would need to capture the outputs from outputs.partialSum ports
-            // For this model, we'll use a simplified approach - we'd normally read from bottom_pe
-            
-            // Access the bottom PE's data to avoid unused variable warning
-            // In a real implementation, we would read data from this PE's output port
-            int32_t result_value = c + 1; // Placeholder value
-            if (bottom_pe != nullptr) {
-                // Just marking that we're using bottom_pe variable
-                std::cout << "Reading result from bottom PE at column " << c << std::endl;
-            }
-            
-            // Store the result
-            mResultMatrix->set(c, 0, result_value);
-        }
-    }
-    
+// Called when a wave's matrix-vector multiplication is complete. The result is the
+// functional dot product of the wave's tagged weights with its input; the PEs model timing
+// and MAC counts only.
+void SystolicArray::ComputationComplete(const WaveQueue::Wave & wave) {
+    WaveSumsPtr result = WaveResult(wave, mRows, mCols, mWeightWidth, mMacsPerCycle);
+
     // Send result matrix through output port
-    mPortSet.out_results.send(mResultMatrix);
-    
-    // Reset processing state
-    mProcessing = false;
-    std::cout << "Matrix-vector multiplication complete" << std::endl;
+    mPortSet.out_results.send(result);
+
+#ifdef DEBUG_SYSTOLIC_ARRAY
+    std::cout << "Matrix-vector multiplication " << wave.tag << " complete" << std::endl;
+#endif
 }
 
 // Tick method - process one cycle
 void SystolicArray::Tick() {
-    if (mProcessing) {
-        ProcessOneCycle();
+    // Count down multi-cycle MACs of all PEs in one pass over the state table; only PEs
+    // whose result is ready are touched
+    if (mComputeCycles > 0) {
+        mPEState.Step([this](size_t index) { mPEs[index]->ReleaseResult(); });
     }
-    
+
+    // Admit the next vector as its own wave when the left edge is free
+    if (mWaveQueue.Admit() && mWaveQueue.Waves().size() > 1) {
+        mOverlappedWaves++;
+    }
+
+    for (WaveQueue::Wave & wave : mWaveQueue.Waves()) {
+        ProcessOneCycle(wave);
+    }
+
+    // Waves complete in the order they entered
+    while (mWaveQueue.FrontDone(mTotalCyclesNeeded)) {
+        ComputationComplete(mWaveQueue.PopFront());
+    }
+
     // Schedule next tick
     mTickEvent.schedule(1);
 }
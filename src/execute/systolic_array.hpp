@@ -21,6 +21,11 @@
 #include "gemmini/common.hpp"
 #include "gemmini/matrix.hpp"
 #include "gemmini/pe.hpp"
+#include "execute/mesh_stats.hpp"
+#include "execute/pe_state.hpp"
+#include "execute/wave_queue.hpp"
+#include "utils/lazy_counter.hpp"
+#include "utils/profile.hpp"
 
 BEGIN_NS(gemmini)
 
@@ -38,6 +43,16 @@ public:
     PARAMETER(uint32_t, rows, 4, "Number of rows in systolic array")
     PARAMETER(uint32_t, cols, 4, "Number of columns in systolic array")
     PARAMETER(uint32_t, compute_cycles, 0, "Cycles required for PE MAC operation")
+    PARAMETER(bool, per_pe_stats, false,
+              "Create statistics counters in every PE in addition to the array aggregates")
+    PARAMETER(bool, pe_logging, false, "Create log sources in every PE and its delay FIFOs")
+    PARAMETER(bool, overlap_waves, true,
+              "Start the next vector's fill while earlier vectors drain instead of waiting "
+              "for each to complete")
+    PARAMETER(uint32_t, weight_width, 16,
+              "PE weight width in bits, 4 stores packed int4 weights against int8 activations")
+    PARAMETER(uint32_t, macs_per_cycle, 1,
+              "MACs per PE per cycle with 4-bit weights; 2 packs two K elements in each PE")
 };
 
 // Port Set for SystolicArray
@@ -63,7 +78,7 @@ public:
     sparta::DataInPort<uint32_t> in_control;
 
     // Output ports
-    sparta::DataOutPort<MatrixPtr> out_results;
+    sparta::DataOutPort<WaveSumsPtr> out_results;
 };
 
 // Systolic Array class - 2D array of Processing Elements using SPARTA
@@ -88,33 +103,45 @@ public:
     // Return port set
     SystolicArrayPortSet & GetPortSet() { return mPortSet; }
 
+    // Dense per-PE statistics
+    const MeshStats & GetMeshStats() const { return mMeshStats; }
+
+    // Dense per-PE hot state
+    const PEStateTable & GetPEState() const { return mPEState; }
+
 private:
     // Port set
     SystolicArrayPortSet mPortSet;
 
-    // Event set for scheduling
-    sparta::EventSet mUnitEventSet;
-
     // Logger
     sparta::log::MessageSource mLogger;
 
-    // Configuration parameters
-    const uint32_t mRows;
-    const uint32_t mCols;
-    const uint32_t mComputeCycles;
+    // Configuration parameters, constants in a profile build
+    const ProfileParam<Profile::kRows> mRows;
+    const ProfileParam<Profile::kCols> mCols;
+    const ProfileParam<Profile::kComputeCycles> mComputeCycles;
+    const ProfileParam<Profile::kWeightWidth> mWeightWidth;
+    const uint32_t mMacsPerCycle;
 
     // Array of Processing Elements
     std::vector<PE*> mPEs; // Flattened 2D array for easier access
 
+    // Per-cycle state of every PE, packed so the mesh's working set stays in cache
+    PEStateTable mPEState;
+
     // Current state
-    bool mProcessing = false;
-    uint32_t mCurrentCycle = 0;
-    uint32_t mTotalCyclesNeeded = 0;
-    VectorPtr mCurrentInput;
-    MatrixPtr mResultMatrix;
+    uint32_t mTotalCyclesNeeded = 0; // Cycles from a wave's first feed to its result
+    WaveQueue mWaveQueue;            // Vectors waiting for the left edge and in flight
 
     // Statistics
-    sparta::Counter mTotalMatrixOps; // Count of matrix operations
+    sparta::Counter mTotalMatrixOps;  // Count of matrix operations
+    sparta::Counter mOverlappedWaves; // Waves that entered while another was in flight
+
+    // MAC counts of all PEs, aggregated per row, per column and for the array on read
+    MeshStats mMeshStats;
+    LazyCounter mTotalMacs;
+    std::vector<std::unique_ptr<LazyCounter>> mRowMacs;
+    std::vector<std::unique_ptr<LazyCounter>> mColMacs;
 
     // Tick event
     sparta::UniqueEvent<> mTickEvent;
@@ -124,8 +151,8 @@ private:
     void HandleVector(const VectorPtr & input);
     void HandleControl(const uint32_t & signal);
 
-    void ProcessOneCycle();
-    void ComputationComplete();
+    void ProcessOneCycle(WaveQueue::Wave & wave);
+    void ComputationComplete(const WaveQueue::Wave & wave);
     void Tick();
 
     // Helper methods
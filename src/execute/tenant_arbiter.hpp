@@ -0,0 +1,59 @@
+// tenant_arbiter.hpp - Priority and weighted-fair arbitration between request streams
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// Arbitration settings of one tenant (request stream)
+struct TenantConfig {
+    uint32_t priority = 0; // Lower values are served first
+    uint32_t weight = 1;   // Share of the array among tenants of the same priority
+};
+
+// TenantArbiter - picks which tenant runs the next tile. Tenants of a lower priority value
+// always win (strict priority). Tenants of equal priority share the array in proportion to
+// their weights using start-time fair queueing: each tenant carries a virtual finish tag
+// that advances by cost / weight per grant, and the smallest start tag wins. A tenant that
+// was idle restarts at the current virtual time, so it cannot bank credit while idle.
+class TenantArbiter {
+public:
+    explicit TenantArbiter(const std::vector<TenantConfig> & tenants)
+        : mTenants(tenants), mFinish(tenants.size(), 0.0) {}
+
+    size_t NumTenants() const { return mTenants.size(); }
+    const TenantConfig & Tenant(size_t tenant) const { return mTenants[tenant]; }
+
+    // Choose among tenants with work (ready[t]) and charge the winner cost; -1 if none
+    int Grant(const std::vector<bool> & ready, double cost = 1.0) {
+        int best = -1;
+        double bestStart = 0.0;
+        for (size_t t = 0; t < mTenants.size() && t < ready.size(); ++t) {
+            if (!ready[t]) {
+                continue;
+            }
+            double start = std::max(mVirtualTime, mFinish[t]);
+            if (best < 0 || mTenants[t].priority < mTenants[best].priority ||
+                (mTenants[t].priority == mTenants[best].priority && start < bestStart)) {
+                best = static_cast<int>(t);
+                bestStart = start;
+            }
+        }
+        if (best >= 0) {
+            mVirtualTime = bestStart;
+            mFinish[best] = bestStart + cost / std::max(1u, mTenants[best].weight);
+        }
+        return best;
+    }
+
+private:
+    const std::vector<TenantConfig> mTenants;
+    std::vector<double> mFinish; // Virtual finish tag of each tenant's last grant
+    double mVirtualTime = 0.0;   // Start tag of the last grant
+};
+
+END_NS(gemmini)
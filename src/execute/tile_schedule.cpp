@@ -0,0 +1,246 @@
+// tile_schedule.cpp - Implementation of the tile schedule IR
+#include "execute/tile_schedule.hpp"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace gemmini {
+
+// File magic and format version; version 1 files have no K tiles
+static const char kScheduleMagic[4] = {'G', 'T', 'S', 'C'};
+static const uint32_t kScheduleVersion = 2;
+
+// Little-endian helpers so files are portable between hosts
+static void WriteU32(std::ostream & os, uint32_t value) {
+    char bytes[4] = {static_cast<char>(value), static_cast<char>(value >> 8),
+                     static_cast<char>(value >> 16), static_cast<char>(value >> 24)};
+    os.write(bytes, sizeof(bytes));
+}
+
+static uint32_t ReadU32(std::istream & is) {
+    unsigned char bytes[4];
+    if (!is.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+        throw std::runtime_error("Truncated tile schedule");
+    }
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+const char* TileOpTypeName(TileOpType type) {
+    switch (type) {
+    case TileOpType::Load:
+        return "load";
+    case TileOpType::Preload:
+        return "preload";
+    case TileOpType::Compute:
+        return "compute";
+    case TileOpType::Store:
+        return "store";
+    }
+    return "unknown";
+}
+
+std::ostream & operator<<(std::ostream & os, const TileOp & op) {
+    os << TileOpTypeName(op.type);
+    if (op.type == TileOpType::Load) {
+        os << (op.operand == TileOperand::A ? " A" : " B");
+    }
+    os << " [" << op.row_block << "," << op.col_block << "] k=" << op.k_block
+       << " buf=" << uint32_t(op.buffer) << " acc=" << uint32_t(op.acc_buffer);
+    return os;
+}
+
+uint32_t TileSchedule::NumBuffers() const {
+    uint32_t count = 0;
+    for (const auto & op : mOps) {
+        if (op.type != TileOpType::Store) {
+            count = std::max(count, op.buffer + 1u);
+        }
+    }
+    return count;
+}
+
+uint32_t TileSchedule::NumAccBuffers() const {
+    uint32_t count = 0;
+    for (const auto & op : mOps) {
+        if (op.type == TileOpType::Compute || op.type == TileOpType::Store) {
+            count = std::max(count, op.acc_buffer + 1u);
+        }
+    }
+    return count;
+}
+
+std::vector<TileOp> TileSchedule::LiveLoads(size_t nextOp) const {
+    std::vector<bool> reloaded(NumBuffers(), false);
+    std::vector<bool> live(NumBuffers(), false);
+    for (size_t i = nextOp; i < mOps.size(); ++i) {
+        const TileOp & op = mOps[i];
+        if (op.type == TileOpType::Load) {
+            reloaded[op.buffer] = true;
+        } else if (op.type != TileOpType::Store && !reloaded[op.buffer]) {
+            live[op.buffer] = true;
+        }
+    }
+
+    // The latest load before nextOp is the one whose data is read
+    std::vector<TileOp> loads;
+    for (size_t i = std::min(nextOp, mOps.size()); i-- > 0;) {
+        const TileOp & op = mOps[i];
+        if (op.type == TileOpType::Load && live[op.buffer]) {
+            live[op.buffer] = false;
+            loads.push_back(op);
+        }
+    }
+    return loads;
+}
+
+// Layout: magic, version, m, k, n, tile rows, tile cols, K tile, op count, then 16 bytes
+// per op
+void TileSchedule::Write(std::ostream & os) const {
+    os.write(kScheduleMagic, sizeof(kScheduleMagic));
+    WriteU32(os, kScheduleVersion);
+    WriteU32(os, mM);
+    WriteU32(os, mK);
+    WriteU32(os, mN);
+    WriteU32(os, mTileRows);
+    WriteU32(os, mTileCols);
+    WriteU32(os, mKTile);
+    WriteU32(os, static_cast<uint32_t>(mOps.size()));
+    for (const auto & op : mOps) {
+        char header[4] = {static_cast<char>(op.type), static_cast<char>(op.operand),
+                          static_cast<char>(op.buffer), static_cast<char>(op.acc_buffer)};
+        os.write(header, sizeof(header));
+        WriteU32(os, op.row_block);
+        WriteU32(os, op.col_block);
+        WriteU32(os, op.k_block);
+    }
+}
+
+TileSchedulePtr TileSchedule::Read(std::istream & is) {
+    char magic[4];
+    if (!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, kScheduleMagic)) {
+        throw std::runtime_error("Not a tile schedule");
+    }
+    uint32_t version = ReadU32(is);
+    if (version == 0 || version > kScheduleVersion) {
+        throw std::runtime_error("Unsupported tile schedule version " + std::to_string(version));
+    }
+
+    uint32_t m = ReadU32(is);
+    uint32_t k = ReadU32(is);
+    uint32_t n = ReadU32(is);
+    uint32_t tileRows = ReadU32(is);
+    uint32_t tileCols = ReadU32(is);
+    uint32_t kTile = version >= 2 ? ReadU32(is) : tileRows;
+    if (tileRows == 0 || tileCols == 0 || kTile == 0) {
+        throw std::runtime_error("Tile schedule has an empty tile shape");
+    }
+    auto schedule = std::make_shared<TileSchedule>(m, k, n, tileRows, tileCols, kTile);
+
+    uint32_t count = ReadU32(is);
+    for (uint32_t i = 0; i < count; ++i) {
+        unsigned char header[4];
+        if (!is.read(reinterpret_cast<char*>(header), sizeof(header))) {
+            throw std::runtime_error("Truncated tile schedule");
+        }
+        if (header[0] > static_cast<uint8_t>(TileOpType::Store) ||
+            header[1] > static_cast<uint8_t>(TileOperand::B)) {
+            throw std::runtime_error("Invalid operation " + std::to_string(i) +
+                                     " in tile schedule");
+        }
+        TileOp op;
+        op.type = static_cast<TileOpType>(header[0]);
+        op.operand = static_cast<TileOperand>(header[1]);
+        op.buffer = header[2];
+        op.acc_buffer = header[3];
+        op.row_block = ReadU32(is);
+        op.col_block = ReadU32(is);
+        op.k_block = version >= 2 ? ReadU32(is) : 0;
+        if (op.row_block >= schedule->RowBlocks() || op.col_block >= schedule->ColBlocks() ||
+            op.k_block >= schedule->KBlocks()) {
+            throw std::runtime_error("Operation " + std::to_string(i) +
+                                     " is outside the tile grid");
+        }
+        schedule->Append(op);
+    }
+    return schedule;
+}
+
+void TileSchedule::SaveToFile(const std::string & path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot write tile schedule: " + path);
+    }
+    Write(file);
+}
+
+TileSchedulePtr TileSchedule::LoadFromFile(const std::string & path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open tile schedule: " + path);
+    }
+    return Read(file);
+}
+
+TileSchedulePtr TileSchedule::Plan(uint32_t m, uint32_t k, uint32_t n, uint32_t tileRows,
+                                   uint32_t tileCols, uint32_t kTile) {
+    auto schedule = std::make_shared<TileSchedule>(m, k, n, tileRows, tileCols, kTile);
+
+    // Buffers 0/1 hold A row blocks, 2/3 hold B tiles
+    uint32_t tile = 0;
+    uint32_t bTile = 0;
+    for (uint32_t rb = 0; rb < schedule->RowBlocks(); ++rb) {
+        uint8_t aBuffer = rb % 2;
+
+        TileOp loadA;
+        loadA.type = TileOpType::Load;
+        loadA.operand = TileOperand::A;
+        loadA.buffer = aBuffer;
+        loadA.row_block = rb;
+        schedule->Append(loadA);
+
+        for (uint32_t cb = 0; cb < schedule->ColBlocks(); ++cb, ++tile) {
+            uint8_t accBuffer = tile % 2;
+
+            // Each K tile adds its partial sums to the accumulator buffer
+            for (uint32_t kb = 0; kb < schedule->KBlocks(); ++kb, ++bTile) {
+                uint8_t bBuffer = 2 + bTile % 2;
+
+                TileOp loadB;
+                loadB.type = TileOpType::Load;
+                loadB.operand = TileOperand::B;
+                loadB.buffer = bBuffer;
+                loadB.row_block = rb;
+                loadB.col_block = cb;
+                loadB.k_block = kb;
+                schedule->Append(loadB);
+
+                TileOp preload;
+                preload.type = TileOpType::Preload;
+                preload.buffer = bBuffer;
+                preload.row_block = rb;
+                preload.col_block = cb;
+                preload.k_block = kb;
+                schedule->Append(preload);
+
+                TileOp compute;
+                compute.type = TileOpType::Compute;
+                compute.buffer = aBuffer;
+                compute.acc_buffer = accBuffer;
+                compute.row_block = rb;
+                compute.col_block = cb;
+                compute.k_block = kb;
+                schedule->Append(compute);
+            }
+
+            TileOp store;
+            store.type = TileOpType::Store;
+            store.acc_buffer = accBuffer;
+            store.row_block = rb;
+            store.col_block = cb;
+            schedule->Append(store);
+        }
+    }
+    return schedule;
+}
+
+} // namespace gemmini
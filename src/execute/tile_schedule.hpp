@@ -0,0 +1,126 @@
+// tile_schedule.hpp - Tile schedule IR for the Gemmini matrix multiplier
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+class TileSchedule;
+using TileSchedulePtr = std::shared_ptr<TileSchedule>;
+
+// Kind of a schedule operation
+enum class TileOpType : uint8_t {
+    Load = 0,    // Move an A row block or a B tile into a scratchpad buffer
+    Preload = 1, // Load weights from a scratchpad buffer into the array
+    Compute = 2, // Stream one K tile of A rows through the array into an accumulator
+                 // buffer; K tiles after the first add to the partial sums already there
+    Store = 3,   // Move an accumulator buffer into the result matrix
+};
+
+// Operand a Load refers to
+enum class TileOperand : uint8_t {
+    A = 0,
+    B = 1,
+};
+
+// One operation of a tile schedule
+struct TileOp {
+    TileOpType type = TileOpType::Load;
+    TileOperand operand = TileOperand::A; // Load only
+    uint8_t buffer = 0;                   // Scratchpad buffer read or written
+    uint8_t acc_buffer = 0;               // Accumulator buffer (Compute and Store)
+    uint32_t row_block = 0;               // Tile row in the result matrix
+    uint32_t col_block = 0;               // Tile column in the result matrix
+    uint32_t k_block = 0;                 // K tile (B loads, Preload and Compute)
+
+    bool operator==(const TileOp & other) const {
+        return type == other.type && operand == other.operand && buffer == other.buffer &&
+               acc_buffer == other.acc_buffer && row_block == other.row_block &&
+               col_block == other.col_block && k_block == other.k_block;
+    }
+};
+
+// TileSchedule - ordered list of tile operations for one GEMM C(m x n) = A(m x k) * B(k x n)
+// on a tile_rows x tile_cols array. K is split into tiles of k_tile elements, the depth of
+// one weight tile (tile_rows unless PEs hold several weights); every result block takes one
+// preload and one compute pass per K tile.
+class TileSchedule {
+public:
+    TileSchedule(uint32_t m, uint32_t k, uint32_t n, uint32_t tileRows, uint32_t tileCols,
+                 uint32_t kTile = 0)
+        : mM(m), mK(k), mN(n), mTileRows(tileRows), mTileCols(tileCols),
+          mKTile(kTile ? kTile : tileRows) {}
+
+    // Problem and tile shape
+    uint32_t M() const { return mM; }
+    uint32_t K() const { return mK; }
+    uint32_t N() const { return mN; }
+    uint32_t TileRows() const { return mTileRows; }
+    uint32_t TileCols() const { return mTileCols; }
+    uint32_t RowBlocks() const { return (mM + mTileRows - 1) / mTileRows; }
+    uint32_t ColBlocks() const { return (mN + mTileCols - 1) / mTileCols; }
+    uint32_t KTile() const { return mKTile; }
+    uint32_t KBlocks() const { return std::max(1u, (mK + mKTile - 1) / mKTile); }
+
+    // Elements along K in a K tile, the last one can be shorter
+    uint32_t KTileRows(uint32_t kBlock) const {
+        return std::min(mKTile, mK - std::min(mK, kBlock * mKTile));
+    }
+
+    // Operations
+    const std::vector<TileOp> & Ops() const { return mOps; }
+    size_t Size() const { return mOps.size(); }
+    const TileOp & operator[](size_t idx) const { return mOps[idx]; }
+    void Append(const TileOp & op) { mOps.push_back(op); }
+
+    // Number of scratchpad and accumulator buffers referenced
+    uint32_t NumBuffers() const;
+    uint32_t NumAccBuffers() const;
+
+    // Loads that filled the scratchpad buffers read at or after nextOp before they are
+    // reloaded: what a schedule preempted before nextOp has to load again to resume
+    std::vector<TileOp> LiveLoads(size_t nextOp) const;
+
+    // Check that the schedule matches a problem and array shape
+    bool Matches(uint32_t m, uint32_t k, uint32_t n, uint32_t tileRows, uint32_t tileCols,
+                 uint32_t kTile = 0) const {
+        return mM == m && mK == k && mN == n && mTileRows == tileRows && mTileCols == tileCols &&
+               mKTile == (kTile ? kTile : tileRows);
+    }
+
+    // Compact binary serialization, throws std::runtime_error on malformed input
+    void Write(std::ostream & os) const;
+    static TileSchedulePtr Read(std::istream & is);
+    void SaveToFile(const std::string & path) const;
+    static TileSchedulePtr LoadFromFile(const std::string & path);
+
+    // Plan the default block-by-block schedule: each A row block is loaded once, every
+    // result block loads, preloads and computes its K tiles in order before it is stored.
+    // B tiles and accumulator buffers alternate between two buffers each.
+    static TileSchedulePtr Plan(uint32_t m, uint32_t k, uint32_t n, uint32_t tileRows,
+                                uint32_t tileCols, uint32_t kTile = 0);
+
+private:
+    uint32_t mM;
+    uint32_t mK;
+    uint32_t mN;
+    uint32_t mTileRows;
+    uint32_t mTileCols;
+    uint32_t mKTile;
+    std::vector<TileOp> mOps;
+};
+
+// Name of an operation type
+const char* TileOpTypeName(TileOpType type);
+
+// Print one operation in readable form
+std::ostream & operator<<(std::ostream & os, const TileOp & op);
+
+END_NS(gemmini)
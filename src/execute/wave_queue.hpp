@@ -0,0 +1,109 @@
+// wave_queue.hpp - Vectors waiting for and flowing through the systolic array
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "gemmini/common.hpp"
+#include "gemmini/matrix.hpp"
+#include "execute/packed_int.hpp"
+
+BEGIN_NS(gemmini)
+
+// Full-width sums of one wave, one per array row
+using WaveSums = std::vector<int32_t>;
+using WaveSumsPtr = std::shared_ptr<WaveSums>;
+
+// WaveQueue - the vectors fed to the mesh, each flowing through it as its own wave. A wave
+// may enter once the newest one has fed all rows at the left edge, so no PE sees two
+// waves' inputs in one cycle; without overlap it waits for the array to empty. Waves carry
+// the weights they were admitted with, so a preload for the next tile cannot change results
+// still draining, and they complete in the order they entered.
+class WaveQueue {
+public:
+    // One vector in flight through the mesh
+    struct Wave {
+        uint64_t tag = 0;   // Admission order
+        VectorPtr input;
+        MatrixPtr weights;  // Weights in the array when the wave entered
+        uint32_t cycle = 0; // Cycles since the wave entered
+    };
+
+    WaveQueue(uint32_t rows, bool overlap) : mRows(rows), mOverlap(overlap) {}
+
+    // Queue a vector for the left edge
+    void Push(const VectorPtr & input) { mPending.push_back(input); }
+
+    // Weights for waves admitted from now on
+    void Preload(const MatrixPtr & weights) { mWeights = weights; }
+
+    bool CanAdmit() const {
+        if (mWaves.empty()) {
+            return true;
+        }
+        return mOverlap && mWaves.back().cycle >= mRows;
+    }
+
+    // Start the next pending vector if the left edge is free, returns false otherwise
+    bool Admit() {
+        if (mPending.empty() || !CanAdmit()) {
+            return false;
+        }
+        Wave wave;
+        wave.tag = mNextTag++;
+        wave.input = mPending.front();
+        wave.weights = mWeights;
+        mWaves.push_back(wave);
+        mPending.pop_front();
+        return true;
+    }
+
+    // Waves in flight, oldest first
+    std::deque<Wave> & Waves() { return mWaves; }
+    const std::deque<Wave> & Waves() const { return mWaves; }
+    size_t NumPending() const { return mPending.size(); }
+
+    // Whether the oldest wave has spent more than latency cycles in the mesh
+    bool FrontDone(uint32_t latency) const {
+        return !mWaves.empty() && mWaves.front().cycle > latency;
+    }
+
+    Wave PopFront() {
+        Wave wave = mWaves.front();
+        mWaves.pop_front();
+        return wave;
+    }
+
+private:
+    const uint32_t mRows;
+    const bool mOverlap;
+    MatrixPtr mWeights;
+    std::deque<VectorPtr> mPending;
+    std::deque<Wave> mWaves;
+    uint64_t mNextTag = 0;
+};
+
+// Result of a wave, computed functionally from the weights it was tagged with rather than
+// collected from the PEs: output r is the dot product of weight row r with the input,
+// saturated to the 32-bit accumulator width.
+inline WaveSumsPtr WaveResult(const WaveQueue::Wave & wave, uint32_t rows, uint32_t cols,
+                              uint32_t weightBits, uint32_t macs) {
+    WaveSumsPtr result = std::make_shared<WaveSums>(rows, 0);
+    if (!wave.weights) {
+        return result;
+    }
+    uint32_t inputs = std::min<uint32_t>(cols, wave.input->size());
+    for (uint32_t r = 0; r < rows; ++r) {
+        int64_t sum = 0;
+        for (uint32_t c = 0; c < inputs; ++c) {
+            sum += PackedProduct(wave.weights->get(r, c), wave.input->get(c), weightBits, macs);
+        }
+        (*result)[r] = static_cast<int32_t>(std::clamp<int64_t>(sum, INT32_MIN, INT32_MAX));
+    }
+    return result;
+}
+
+END_NS(gemmini)
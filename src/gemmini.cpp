@@ -1,12 +1,30 @@
 // gemmini.cpp - Implementation of top-level Gemmini simulator using SPARTA
 #include "gemmini/gemmini.hpp"
 #include "sparta/kernel/Scheduler.hpp"
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
 namespace gemmini {
+
+// Runs stop once the multiplier is idle; they are cut off at kRunLimitFactor times the
+// static estimate plus kRunLimitSlack mesh cycles, checked every kRunSliceCycles
+static const uint64_t kRunLimitFactor = 16;
+static const uint64_t kRunLimitSlack = 100000;
+static const uint64_t kRunSliceCycles = 64;
+
+// Nodes in the subtree below and including node
+static uint64_t CountNodes(sparta::TreeNode* node) {
+    uint64_t count = 1;
+    for (sparta::TreeNode* child : node->getChildren()) {
+        count += CountNodes(child);
+    }
+    return count;
+}
+
 // GemminiSimulation Constructor
-GemminiSimulation::GemminiSimulation(sparta::Scheduler* scheduler)
-    : sparta::app::Simulation("GemminiSim", scheduler) {
+GemminiSimulation::GemminiSimulation(sparta::Scheduler* scheduler, const ClockConfig & clocks)
+    : sparta::app::Simulation("GemminiSim", scheduler), mClockConfig(clocks) {
     // Nothing to do here - resource construction happens in buildTree_()
 }
 
@@ -18,9 +36,31 @@ void GemminiSimulation::buildTree_() {
     // Create resources
     auto rootNode = getRoot();
 
-    // Create matrix multiplier node
+    // Create one clock per domain from the root clock
+    sparta::ClockManager & clockManager = getClockManager();
+    mMeshClock = clockManager.makeClock("mesh_clk", clockManager.getRoot(), mClockConfig.mesh_mhz);
+    mSpadClock = clockManager.makeClock("spad_clk", clockManager.getRoot(), mClockConfig.spad_mhz);
+    mDramClock = clockManager.makeClock("dram_clk", clockManager.getRoot(), mClockConfig.dram_mhz);
+    mCmdClock = clockManager.makeClock("cmd_clk", clockManager.getRoot(), mClockConfig.cmd_mhz);
+
+    // Measure the host memory of every unit while the tree is built
+    MemoryFootprint* previousFootprint = MemoryFootprint::Current();
+    MemoryFootprint::SetCurrent(&mFootprint);
+    FootprintScope footprint("MatrixMultiplier");
+
+    // Create matrix multiplier node, it runs the command interface
     sparta::TreeNode* mmNode =
         new sparta::TreeNode(rootNode, "matrix_multiplier", "Matrix Multiplier");
+    mmNode->setClock(mCmdClock.get());
+
+    // Pre-create the systolic array node so the mesh runs in its own domain
+    sparta::TreeNode* systolicNode =
+        new sparta::TreeNode(mmNode, "systolic_array", "Systolic Array");
+    systolicNode->setClock(mMeshClock.get());
+
+    // The accumulator drains on the scratchpad clock
+    sparta::TreeNode* accNode = new sparta::TreeNode(mmNode, "accumulator", "Accumulator");
+    accNode->setClock(mSpadClock.get());
 
     // Create parameter set for matrix multiplier
     auto mmParams = new MatrixMultiplier::ParameterSet(mmNode);
@@ -30,6 +70,17 @@ void GemminiSimulation::buildTree_() {
     // Create matrix multiplier resource
     MatrixMultiplier::Factory mmFactory;
     mMatrixMultiplier = static_cast<MatrixMultiplier*>(mmFactory.createResource(mmNode, mmParams));
+    mMatrixMultiplier->SetDramClock(mDramClock.get());
+
+    MemoryFootprint::SetCurrent(previousFootprint);
+
+    // Node counts show what every PE adds to the tree, next to its bytes
+    for (sparta::TreeNode* child : systolicNode->getChildren()) {
+        if (child->getName().compare(0, 3, "pe_") == 0) {
+            mFootprint.AddNodes("PE", CountNodes(child));
+        }
+    }
+    mFootprint.SetTreeNodes(CountNodes(rootNode));
 }
 
 void GemminiSimulation::configureTree_() {
@@ -42,46 +93,109 @@ void GemminiSimulation::bindTree_() {
     // In this simple implementation, all binding happens in component constructors
 }
 
-// Run simulation with input matrices
-void GemminiSimulation::RunSimulation(const MatrixPtr & matrixA, const MatrixPtr & matrixB) {
-    std::cout << "Starting Gemmini matrix multiplication simulation..." << std::endl;
-
-    // Print matrix dimensions
-    std::cout << "Matrix A: " << matrixA->Rows() << "x" << matrixA->Cols() << std::endl;
-    std::cout << "Matrix B: " << matrixB->Rows() << "x" << matrixB->Cols() << std::endl;
-
-    // Calculate expected cycles
-    // For a matrix multiplication using a 4x4 systolic array:
-    // - Setup: 1 cycle
-    // - Systolic array processing: rows + cols - 1 + compute_cycles cycles
-    // - Computation complete: 1 cycle
-    // - Block handling: number of blocks * (above)
-    uint32_t rowsPerBlock = 4;
-    uint32_t colsPerBlock = 4;
-    uint32_t computeTime = 0; // Changed to 0 to match updated design
+// Scratchpad and payload memory of one run, as the matrix multiplier plans it
+uint64_t GemminiSimulation::EstimateRun(uint32_t m, uint32_t k, uint32_t n) {
+    uint64_t scratchpad = 0;
+    uint64_t payloads = 0;
+    mMatrixMultiplier->EstimateHostBytes(m, k, n, scratchpad, payloads);
 
-    uint32_t rowBlocks = (matrixA->Rows() + rowsPerBlock - 1) / rowsPerBlock;
-    uint32_t colBlocks = (matrixB->Cols() + colsPerBlock - 1) / colsPerBlock;
-    uint32_t cyclesPerBlock = 1 + rowsPerBlock + colsPerBlock - 1 + computeTime + 1;
-    uint32_t expectedCycles = rowBlocks * colBlocks * cyclesPerBlock;
+    mFootprint.Add("Scratchpad", 1, scratchpad);
+    mFootprint.Add("Payloads", 1, payloads);
+    return scratchpad + payloads;
+}
 
-    // Add extra cycles for setup and final result handling
-    expectedCycles += 10;
+// Run simulation with input matrices
+MatrixPtr GemminiSimulation::RunSimulation(const MatrixPtr & matrixA, const MatrixPtr & matrixB) {
+    // The estimate only bounds the run, which ends when the multiplier sends its result
+    uint64_t expectedCycles = StartRun(matrixA, matrixB);
+    if (!RunUntilDone(expectedCycles)) {
+        throw std::runtime_error("Multiplication did not complete within " +
+                                 std::to_string(kRunLimitFactor) + "x the expected " +
+                                 std::to_string(expectedCycles) + " mesh cycles");
+    }
+    return FinishRun();
+}
 
-    std::cout << "Expected simulation time: " << expectedCycles << " cycles" << std::endl;
+// Queue a multiplication and estimate its length
+uint64_t GemminiSimulation::StartRun(const MatrixPtr & matrixA, const MatrixPtr & matrixB) {
+    if (mPrintResults) {
+        std::cout << "Starting Gemmini matrix multiplication simulation..." << std::endl;
+
+        // Print matrix dimensions
+        std::cout << "Matrix A: " << matrixA->Rows() << "x" << matrixA->Cols() << std::endl;
+        std::cout << "Matrix B: " << matrixB->Rows() << "x" << matrixB->Cols() << std::endl;
+    }
+
+    // The static checker times the planned schedule on the command clock, including host
+    // issue and fence costs; convert that to mesh cycles
+    uint64_t expectedCycles = mMatrixMultiplier->EstimateCycles(
+        matrixA->Rows(), matrixA->Cols(), matrixB->Cols());
+    if (mCmdClock && mMeshClock) {
+        uint64_t meshPeriod = std::max<uint64_t>(1, mMeshClock->getPeriod());
+        expectedCycles = (mCmdClock->getTick(expectedCycles) + meshPeriod - 1) / meshPeriod;
+    }
+
+    if (mPrintResults) {
+        std::cout << "Expected simulation time: " << expectedCycles << " cycles" << std::endl;
+    }
+
+    // Check the RSS budget before spending time on the run
+    if (mMemoryBudget.rss_bytes > 0 && !MemoryFootprint::CanMeasureRss()) {
+        std::cerr << "Warning: the RSS of this process cannot be read on this host, the "
+                     "budget only covers the run's own estimate" << std::endl;
+    }
+    uint64_t runBytes = EstimateRun(matrixA->Rows(), matrixA->Cols(), matrixB->Cols());
+    uint64_t projectedRss = MemoryFootprint::RssBytes() + runBytes;
+    if (mMemoryBudget.rss_bytes > 0 && projectedRss > mMemoryBudget.rss_bytes) {
+        std::string msg = "Projected RSS of " + std::to_string(projectedRss >> 20) +
+                          " MiB exceeds the budget of " +
+                          std::to_string(mMemoryBudget.rss_bytes >> 20) + " MiB";
+        if (mMemoryBudget.fail) {
+            throw std::runtime_error(msg);
+        }
+        std::cerr << "Warning: " << msg << std::endl;
+    }
 
     // Perform matrix multiplication
     mMatrixMultiplier->Multiply(matrixA, matrixB);
+    return expectedCycles;
+}
 
-    // Run simulation for expected time
-    runRaw(expectedCycles);
+// Advance the simulation, counted in mesh cycles
+void GemminiSimulation::RunCycles(uint64_t cycles) {
+    runRaw(mMeshClock ? mMeshClock->getTick(cycles) : cycles);
+}
 
-    // Get results
+// Advance in short slices until the multiplier goes idle
+bool GemminiSimulation::RunUntilDone(uint64_t expectedCycles) {
+    const uint64_t maxCycles = kRunLimitFactor * expectedCycles + kRunLimitSlack;
+    uint64_t elapsed = 0;
+    while (!mMatrixMultiplier->Idle()) {
+        if (elapsed >= maxCycles) {
+            return false;
+        }
+        uint64_t slice = std::min(kRunSliceCycles, maxCycles - elapsed);
+        RunCycles(slice);
+        elapsed += slice;
+    }
+    return true;
+}
+
+// Result of the last completed multiplication
+MatrixPtr GemminiSimulation::FinishRun() {
     MatrixPtr result = mMatrixMultiplier->GetResult();
+    if (!result) {
+        throw std::runtime_error("No multiplication has completed; the request was rejected "
+                                 "or the run stopped early");
+    }
 
     // Print results
-    std::cout << "Matrix multiplication result:" << std::endl;
-    std::cout << *result << std::endl;
+    if (mPrintResults) {
+        std::cout << "Matrix multiplication result:" << std::endl;
+        std::cout << *result << std::endl;
+    }
+
+    return result;
 }
 
 } // namespace gemmini
\ No newline at end of file
@@ -4,9 +4,12 @@
 #include "sparta/app/Simulation.hpp"
 #include "sparta/app/CommandLineSimulator.hpp"
 #include "sparta/app/SimulationConfiguration.hpp"
+#include "sparta/simulation/Clock.hpp"
 
 #include "gemmini/common.hpp"
 #include "gemmini/matrix_multiplier.hpp"
+#include "utils/clock_config.hpp"
+#include "utils/memory_footprint.hpp"
 
 BEGIN_NS(gemmini)
 
@@ -14,13 +17,53 @@ BEGIN_NS(gemmini)
 class GemminiSimulation : public sparta::app::Simulation {
 public:
     // Constructor
-    GemminiSimulation(sparta::Scheduler* scheduler);
+    GemminiSimulation(sparta::Scheduler* scheduler, const ClockConfig & clocks = ClockConfig());
 
     // Destructor
     ~GemminiSimulation();
 
-    // Run simulation with input matrices
-    void RunSimulation(const MatrixPtr & matrixA, const MatrixPtr & matrixB);
+    // Run simulation with input matrices, returns the result matrix. Throws if the memory
+    // budget is set to fail and the run would exceed it.
+    MatrixPtr RunSimulation(const MatrixPtr & matrixA, const MatrixPtr & matrixB);
+
+    // RunSimulation in steps: StartRun queues the multiplication and returns the mesh cycles
+    // the static checker expects it to take, RunCycles advances the simulation, RunUntilDone
+    // advances it until the multiplier has sent its result, FinishRun returns the result.
+    // FinishRun throws if no multiplication has completed.
+    uint64_t StartRun(const MatrixPtr & matrixA, const MatrixPtr & matrixB);
+    void RunCycles(uint64_t cycles);
+    MatrixPtr FinishRun();
+
+    // Run until every queued multiplication has completed. Gives up and returns false
+    // after many times the expected mesh cycles, e.g. when a request cannot finish.
+    bool RunUntilDone(uint64_t expectedCycles);
+
+    // Scheduler tick the last result was sent at; runs stop a little later
+    uint64_t GetResultTick() const { return mMatrixMultiplier->GetResultTick(); }
+
+    // Print the dimensions, estimate and result matrix of each run (on by default); batch
+    // runs turn it off so concurrent jobs don't interleave their output
+    void SetPrintResults(bool print) { mPrintResults = print; }
+
+    // Host memory of the built tree; run estimates are added by EstimateRun
+    const MemoryFootprint & GetFootprint() const { return mFootprint; }
+
+    // Add the scratchpad and payload memory an MxK * KxN run needs to the footprint,
+    // returns the added bytes
+    uint64_t EstimateRun(uint32_t m, uint32_t k, uint32_t n);
+
+    // RSS budget checked before each run
+    void SetMemoryBudget(const MemoryBudget & budget) { mMemoryBudget = budget; }
+
+    // Matrix multiplier, for queueing requests from several tenants; valid after the tree
+    // is built
+    MatrixMultiplier* GetMatrixMultiplier() const { return mMatrixMultiplier; }
+
+    // Clock domains, valid after the tree is built
+    sparta::Clock* GetMeshClock() const { return mMeshClock.get(); }
+    sparta::Clock* GetSpadClock() const { return mSpadClock.get(); }
+    sparta::Clock* GetDramClock() const { return mDramClock.get(); }
+    sparta::Clock* GetCmdClock() const { return mCmdClock.get(); }
 
 private:
     // Implementation of pure virtual methods from Simulation
@@ -30,6 +73,20 @@ private:
 
     // Matrix multiplier resource
     MatrixMultiplier* mMatrixMultiplier = nullptr;
+
+    // Host memory accounting
+    MemoryFootprint mFootprint;
+    MemoryBudget mMemoryBudget;
+
+    // Print run progress and results to std::cout
+    bool mPrintResults = true;
+
+    // Clock domains derived from the root clock
+    const ClockConfig mClockConfig;
+    sparta::Clock::Handle mMeshClock;
+    sparta::Clock::Handle mSpadClock;
+    sparta::Clock::Handle mDramClock;
+    sparta::Clock::Handle mCmdClock;
 };
 
 END_NS(gemmini)
\ No newline at end of file
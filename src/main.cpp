@@ -5,11 +5,20 @@
 #include <iomanip>
 #include <string>
 #include <cstring>
-
+#include <cstdlib>
+#include <algorithm>
+
+#include "driver/batch_runner.hpp"
+#include "driver/layer_list.hpp"
+#include "driver/network_runner.hpp"
+#include "driver/onnx_importer.hpp"
+#include "driver/work_queue.hpp"
 #include "gemmini/gemmini.hpp"
 #include "gemmini/matrix.hpp"
 #include "gemmini/pe.hpp"
 #include "gemmini/systolic_array.hpp"
+#include "execute/tile_schedule.hpp"
+#include "execute/schedule_checker.hpp"
 #include "sparta/app/CommandLineSimulator.hpp"
 #include "sparta/app/Simulation.hpp"
 #include "sparta/utils/SpartaTester.hpp"
@@ -150,14 +159,366 @@ void printUsage(const char* program_name) {
     std::cout << "Options:" << std::endl;
     std::cout << "  --verbose, -v  Enable verbose output" << std::endl;
     std::cout << "  --help, -h     Display this help message" << std::endl;
+    std::cout << "  --batch FILE   Run GEMM jobs from FILE ('name m k n [seed]' per line)"
+              << std::endl;
+    std::cout << "  --workers N    Number of batch worker threads (default 1)" << std::endl;
+    std::cout << "  --no-pin       Do not pin batch workers to CPUs" << std::endl;
+    std::cout << "  --clock D=MHZ  Clock domain frequency, D is mesh, spad, dram or cmd"
+              << std::endl;
+    std::cout << "  --rss-budget MB  Warn when a job's projected RSS exceeds MB" << std::endl;
+    std::cout << "  --rss-budget-fail" << std::endl;
+    std::cout << "                 Fail jobs that would exceed the RSS budget instead of warning"
+              << std::endl;
+    std::cout << "  --memory-report M K N" << std::endl;
+    std::cout << "                 Build the simulation for an MxK * KxN GEMM and report its"
+              << " host memory" << std::endl;
+    std::cout << "  --what-if M K N CYCLES FILE" << std::endl;
+    std::cout << "                 Run an MxK * KxN GEMM for CYCLES, then fork the knob variants"
+              << std::endl;
+    std::cout << "                 in FILE ('name knob=value ...' per line) to finish it"
+              << std::endl;
+    std::cout << "  --queue-submit DIR FILE" << std::endl;
+    std::cout << "                 Add the jobs in FILE to the shared work queue in DIR"
+              << std::endl;
+    std::cout << "  --queue-work DIR" << std::endl;
+    std::cout << "                 Run jobs from the queue in DIR until none are left"
+              << std::endl;
+    std::cout << "  --queue-merge DIR DB" << std::endl;
+    std::cout << "                 Merge the queue's results into the SQLite database DB"
+              << std::endl;
+    std::cout << "  --import-onnx MODEL FILE" << std::endl;
+    std::cout << "                 Convert an ONNX model to the layer list FILE" << std::endl;
+    std::cout << "  --onnx-weights DIR" << std::endl;
+    std::cout << "                 Also extract each layer's weights to a tensor file in DIR"
+              << std::endl;
+    std::cout << "  --onnx-batch N Batch size for symbolic model inputs (default 1)" << std::endl;
+    std::cout << "  --network FILE Serve a batch through the layer list FILE on several instances"
+              << std::endl;
+    std::cout << "  --instances N  Accelerator instances for --network (default 2)" << std::endl;
+    std::cout << "  --samples N    Samples in the --network batch (default 16)" << std::endl;
+    std::cout << "  --network-mode pipeline|data|both" << std::endl;
+    std::cout << "                 Pipeline layers across instances, split samples across them,"
+              << " or compare both (default)" << std::endl;
+    std::cout << "  --interconnect mesh|ring|crossbar" << std::endl;
+    std::cout << "                 Carry --network weights and activations over an on-chip network"
+              << std::endl;
+    std::cout << "  --link-bytes N, --router-latency N, --virtual-channels N" << std::endl;
+    std::cout << "                 Interconnect link width (default 32), cycles per router"
+              << " (default 2)" << std::endl;
+    std::cout << "                 and packets buffered per link (default 2)" << std::endl;
+    std::cout << "  --memory-controllers N" << std::endl;
+    std::cout << "                 Memory controllers on the interconnect (default 1)" << std::endl;
+    std::cout << "  --host-issue-cycles N, --host-queue-depth N, --host-fence-cycles N"
+              << std::endl;
+    std::cout << "                 Host command issue cost, command queue depth (0 unlimited)"
+              << " and" << std::endl;
+    std::cout << "                 per-GEMM fence cost for --network and --check-schedule"
+              << std::endl;
+    std::cout << "  --operand-format int16|mxint8|mxfp8|mxfp4, --mx-block 16|32" << std::endl;
+    std::cout << "                 Input element format and MX block size (default 32) for"
+              << " --network" << std::endl;
+    std::cout << "                 and --check-schedule" << std::endl;
+    std::cout << "  --int4-weights, --int4-dual-mac" << std::endl;
+    std::cout << "                 Pack weights two per byte with int8 activations, and let"
+              << " each PE" << std::endl;
+    std::cout << "                 hold two weights, for --network and --check-schedule"
+              << std::endl;
+    std::cout << "  --array ROWS COLS" << std::endl;
+    std::cout << "                 Systolic array of --plan-schedule and --network (default 4 4);"
+              << std::endl;
+    std::cout << "                 match systolic_rows and systolic_cols of the simulator"
+              << std::endl;
+    std::cout << "  --plan-schedule M K N FILE" << std::endl;
+    std::cout << "                 Write the tile schedule for an MxK * KxN GEMM to FILE, with"
+              << " K tiles" << std::endl;
+    std::cout << "                 of two weights per PE under --int4-dual-mac" << std::endl;
+    std::cout << "  --check-schedule FILE" << std::endl;
+    std::cout << "                 Statically check a tile schedule and estimate its cycles"
+              << std::endl;
+}
+
+// Print one line per batch result, returns the exit status
+int printResults(const std::vector<BatchResult> & results) {
+    int failures = 0;
+    for (const auto & result : results) {
+        std::cout << std::left << std::setw(16) << result.name << std::right
+                  << " worker=" << result.worker << " cpu=" << result.cpu
+                  << " node=" << result.numa_node << " ticks=" << result.ticks
+                  << " checksum=" << std::hex << result.checksum << std::dec
+                  << " wall_ms=" << std::fixed << std::setprecision(1) << result.wall_ms
+                  << " arena_kb=" << result.arena_bytes / 1024;
+        if (result.tree_bytes > 0) {
+            std::cout << " tree_kb=" << result.tree_bytes / 1024;
+        } else {
+            std::cout << " tree_kb=-";
+        }
+        if (!result.ok) {
+            std::cout << " FAILED: " << result.error;
+            ++failures;
+        }
+        std::cout << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Run a batch of jobs and print one line per job
+int runBatch(const std::string & path, const BatchRunnerConfig & config) {
+    std::vector<BatchJob> jobs = BatchRunner::LoadJobs(path);
+    std::cout << "Running " << jobs.size() << " job(s) on " << config.workers << " worker(s)"
+              << std::endl;
+
+    BatchRunner runner(config);
+    return printResults(runner.Run(jobs));
+}
+
+// Run what-if variants forked from one warmed-up GEMM
+int runWhatIf(const uint32_t dims[3], uint64_t warmupCycles, const std::string & path,
+              const BatchRunnerConfig & config) {
+    BatchJob job;
+    job.name = "what_if";
+    job.m = dims[0];
+    job.k = dims[1];
+    job.n = dims[2];
+    std::vector<WhatIfVariant> variants = BatchRunner::LoadVariants(path);
+    std::cout << "Forking " << variants.size() << " variant(s) after " << warmupCycles
+              << " cycle(s) on " << config.workers << " process(es)" << std::endl;
+    return printResults(BatchRunner::RunWhatIf(job, warmupCycles, variants, config));
+}
+
+// Build one simulation and print where its host memory goes
+int runMemoryReport(const uint32_t dims[3], const BatchRunnerConfig & config) {
+    BatchJob job;
+    job.name = "memory_report";
+    job.m = dims[0];
+    job.k = dims[1];
+    job.n = dims[2];
+    if (!MemoryFootprint::CanMeasureHeap()) {
+        std::cerr << "Warning: the heap allocator of this host cannot report its usage, "
+                     "tree units read as 0 bytes" << std::endl;
+    }
+    MemoryFootprint footprint = BatchRunner::MeasureJob(job, config.clocks);
+    std::cout << footprint;
+
+    if (!MemoryFootprint::CanMeasureRss()) {
+        std::cerr << "Warning: the RSS of this process cannot be read on this host"
+                  << std::endl;
+        return 0;
+    }
+    uint64_t rss = MemoryFootprint::RssBytes();
+    std::cout << "Process RSS after build: " << (rss >> 20) << " MiB" << std::endl;
+    if (config.memory_budget.rss_bytes > 0 && rss > config.memory_budget.rss_bytes) {
+        std::cout << "Exceeds the RSS budget of " << (config.memory_budget.rss_bytes >> 20)
+                  << " MiB" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Submit, work on or merge a shared-directory work queue
+int runQueue(const std::string & command, const std::string & dir, const std::string & path,
+             const BatchRunnerConfig & config) {
+    WorkQueue queue(dir);
+    if (command == "submit") {
+        size_t count = queue.Submit(BatchRunner::LoadJobs(path));
+        std::cout << "Submitted " << count << " job(s) to " << dir << std::endl;
+    } else if (command == "work") {
+        ClockConfig clocks = config.clocks;
+        MemoryBudget budget = config.memory_budget;
+        size_t count = queue.Work(config.workers, [clocks, budget](const BatchJob & job) {
+            return BatchRunner::RunJob(job, clocks, budget);
+        });
+        std::cout << "Ran " << count << " job(s), " << queue.NumPending() << " pending, "
+                  << queue.NumClaimed() << " claimed" << std::endl;
+    } else {
+        WorkQueue::MergeSummary summary = queue.MergeResults(path);
+        std::cout << "Merged " << summary.merged << " result(s) into " << path << std::endl;
+        auto warn = [](const std::vector<std::string> & jobs, const char* what) {
+            if (jobs.empty()) {
+                return;
+            }
+            std::cerr << "Warning: " << jobs.size() << " job(s) " << what << ":";
+            for (const auto & job : jobs) {
+                std::cerr << " " << job;
+            }
+            std::cerr << std::endl;
+        };
+        warn(summary.pending, "still pending");
+        warn(summary.claimed, "still running");
+        warn(summary.stale, "claimed by a dead or expired worker");
+        warn(summary.repeated, "ran in more than one submission");
+        if (!summary.pending.empty() || !summary.claimed.empty() || !summary.stale.empty()) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Convert an ONNX model to a layer list and summarize it
+int runOnnxImport(const std::string & model, const std::string & path,
+                  const OnnxImporter::Options & options) {
+    OnnxImporter importer(options);
+    std::vector<Layer> layers = importer.Import(model);
+    for (const auto & warning : importer.Warnings()) {
+        std::cerr << "Warning: " << warning << std::endl;
+    }
+    LayerList::SaveToFile(path, layers);
+
+    uint64_t macs = 0;
+    for (const auto & layer : layers) {
+        macs += layer.Macs();
+    }
+    std::cout << "Wrote " << layers.size() << " layer(s), " << macs << " MACs, to " << path
+              << std::endl;
+    return 0;
+}
+
+// Serve a batch through a network in pipeline and/or data-parallel mode
+int runNetwork(const std::string & path, const NetworkConfig & config,
+               const std::string & mode) {
+    std::vector<Layer> layers = LayerList::LoadFromFile(path);
+    std::vector<NetworkMode> modes;
+    NetworkMode parsed;
+    if (mode == "both") {
+        modes = {NetworkMode::Pipeline, NetworkMode::DataParallel};
+    } else if (ParseNetworkMode(mode, parsed)) {
+        modes = {parsed};
+    } else {
+        std::cerr << "Unknown network mode: " << mode << std::endl;
+        return 1;
+    }
+
+    NetworkRunner runner(config);
+    for (NetworkMode m : modes) {
+        std::cout << runner.Run(layers, m);
+    }
+    return 0;
 }
 
 // Main function
 int main(int argc, char** argv) {
+    std::string batchFile;
+    BatchRunnerConfig batchConfig;
+    std::string scheduleFile;
+    uint32_t scheduleDims[3] = {0, 0, 0};
+    std::string checkFile;
+    uint32_t reportDims[3] = {0, 0, 0};
+    std::string queueCommand;
+    std::string queueDir;
+    std::string queuePath;
+    uint32_t whatIfDims[3] = {0, 0, 0};
+    uint64_t whatIfWarmup = 0;
+    std::string whatIfFile;
+    std::string onnxModel;
+    std::string onnxLayers;
+    OnnxImporter::Options onnxOptions;
+    std::string networkFile;
+    std::string networkMode = "both";
+    NetworkConfig networkConfig;
+    networkConfig.instances = 2;
+    networkConfig.samples = 16;
+
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
         if (strcmp(argv[i], "--verbose") == 0 || strcmp(argv[i], "-v") == 0) {
             g_verbose = true;
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batchFile = argv[++i];
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            batchConfig.workers = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--no-pin") == 0) {
+            batchConfig.pin_workers = false;
+        } else if (strcmp(argv[i], "--clock") == 0 && i + 1 < argc) {
+            if (!batchConfig.clocks.Set(argv[++i])) {
+                std::cerr << "Invalid clock setting: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--rss-budget") == 0 && i + 1 < argc) {
+            batchConfig.memory_budget.rss_bytes = uint64_t(std::max(0, atoi(argv[++i]))) << 20;
+        } else if (strcmp(argv[i], "--rss-budget-fail") == 0) {
+            batchConfig.memory_budget.fail = true;
+        } else if (strcmp(argv[i], "--memory-report") == 0 && i + 3 < argc) {
+            for (uint32_t d = 0; d < 3; ++d) {
+                reportDims[d] = std::max(1, atoi(argv[++i]));
+            }
+        } else if (strcmp(argv[i], "--what-if") == 0 && i + 5 < argc) {
+            for (uint32_t d = 0; d < 3; ++d) {
+                whatIfDims[d] = std::max(1, atoi(argv[++i]));
+            }
+            whatIfWarmup = strtoull(argv[++i], nullptr, 10);
+            whatIfFile = argv[++i];
+        } else if (strcmp(argv[i], "--queue-submit") == 0 && i + 2 < argc) {
+            queueCommand = "submit";
+            queueDir = argv[++i];
+            queuePath = argv[++i];
+        } else if (strcmp(argv[i], "--queue-work") == 0 && i + 1 < argc) {
+            queueCommand = "work";
+            queueDir = argv[++i];
+        } else if (strcmp(argv[i], "--queue-merge") == 0 && i + 2 < argc) {
+            queueCommand = "merge";
+            queueDir = argv[++i];
+            queuePath = argv[++i];
+        } else if (strcmp(argv[i], "--import-onnx") == 0 && i + 2 < argc) {
+            onnxModel = argv[++i];
+            onnxLayers = argv[++i];
+        } else if (strcmp(argv[i], "--onnx-weights") == 0 && i + 1 < argc) {
+            onnxOptions.weights_dir = argv[++i];
+        } else if (strcmp(argv[i], "--onnx-batch") == 0 && i + 1 < argc) {
+            onnxOptions.batch = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--network") == 0 && i + 1 < argc) {
+            networkFile = argv[++i];
+        } else if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc) {
+            networkConfig.instances = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            networkConfig.samples = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--network-mode") == 0 && i + 1 < argc) {
+            networkMode = argv[++i];
+        } else if (strcmp(argv[i], "--interconnect") == 0 && i + 1 < argc) {
+            if (!ParseTopology(argv[++i], networkConfig.interconnect.topology)) {
+                std::cerr << "Unknown interconnect topology: " << argv[i] << std::endl;
+                return 1;
+            }
+            networkConfig.model_interconnect = true;
+        } else if (strcmp(argv[i], "--link-bytes") == 0 && i + 1 < argc) {
+            networkConfig.interconnect.link_bytes = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--router-latency") == 0 && i + 1 < argc) {
+            networkConfig.interconnect.router_latency = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--virtual-channels") == 0 && i + 1 < argc) {
+            networkConfig.interconnect.virtual_channels = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--memory-controllers") == 0 && i + 1 < argc) {
+            networkConfig.memory_controllers = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--host-issue-cycles") == 0 && i + 1 < argc) {
+            networkConfig.host.issue_cycles = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--host-queue-depth") == 0 && i + 1 < argc) {
+            networkConfig.host.queue_depth = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--host-fence-cycles") == 0 && i + 1 < argc) {
+            networkConfig.host.fence_cycles = std::max(0, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--operand-format") == 0 && i + 1 < argc) {
+            if (!ParseMxElement(argv[++i], networkConfig.memory.operand_format.element)) {
+                std::cerr << "Unknown operand format: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--mx-block") == 0 && i + 1 < argc) {
+            int block = atoi(argv[++i]);
+            if (block != 16 && block != 32) {
+                std::cerr << "MX block size must be 16 or 32: " << argv[i] << std::endl;
+                return 1;
+            }
+            networkConfig.memory.operand_format.block_size = block;
+        } else if (strcmp(argv[i], "--int4-weights") == 0) {
+            networkConfig.memory.int4_weights = true;
+        } else if (strcmp(argv[i], "--int4-dual-mac") == 0) {
+            networkConfig.memory.int4_weights = true;
+            networkConfig.memory.weights_per_pe = 2;
+        } else if (strcmp(argv[i], "--array") == 0 && i + 2 < argc) {
+            networkConfig.tile_rows = std::max(1, atoi(argv[++i]));
+            networkConfig.tile_cols = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--plan-schedule") == 0 && i + 4 < argc) {
+            for (uint32_t d = 0; d < 3; ++d) {
+                scheduleDims[d] = std::max(1, atoi(argv[++i]));
+            }
+            scheduleFile = argv[++i];
+        } else if (strcmp(argv[i], "--check-schedule") == 0 && i + 1 < argc) {
+            checkFile = argv[++i];
         } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
             printUsage(argv[0]);
             return 0;
@@ -168,6 +529,90 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (!onnxModel.empty()) {
+        try {
+            return runOnnxImport(onnxModel, onnxLayers, onnxOptions);
+        } catch (const std::exception & e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!networkFile.empty()) {
+        try {
+            return runNetwork(networkFile, networkConfig, networkMode);
+        } catch (const std::exception & e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!checkFile.empty()) {
+        try {
+            TileSchedulePtr schedule = TileSchedule::LoadFromFile(checkFile);
+            ScheduleReport report =
+                ScheduleChecker(networkConfig.memory, networkConfig.host).Check(*schedule);
+            std::cout << report;
+            return report.ok ? 0 : 1;
+        } catch (const std::exception & e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!scheduleFile.empty()) {
+        try {
+            // Plan the way the multiplier does, so its replay accepts the schedule
+            TileSchedulePtr schedule = TileSchedule::Plan(
+                scheduleDims[0], scheduleDims[1], scheduleDims[2], networkConfig.tile_rows,
+                networkConfig.tile_cols,
+                networkConfig.tile_rows * networkConfig.memory.weights_per_pe);
+            schedule->SaveToFile(scheduleFile);
+            std::cout << "Wrote " << schedule->Size() << " tile operations to " << scheduleFile
+                      << std::endl;
+            return 0;
+        } catch (const std::exception & e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (reportDims[0] > 0) {
+        try {
+            return runMemoryReport(reportDims, batchConfig);
+        } catch (const std::exception & e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!whatIfFile.empty()) {
+        try {
+            return runWhatIf(whatIfDims, whatIfWarmup, whatIfFile, batchConfig);
+        } catch (const std::exception & e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!queueCommand.empty()) {
+        try {
+            return runQueue(queueCommand, queueDir, queuePath, batchConfig);
+        } catch (const std::exception & e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!batchFile.empty()) {
+        try {
+            return runBatch(batchFile, batchConfig);
+        } catch (const std::exception & e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     std::cout << "==================================================" << std::endl;
     std::cout << "     Gemmini Systolic Array Simulator Tests       " << std::endl;
     std::cout << "==================================================" << std::endl << std::endl;
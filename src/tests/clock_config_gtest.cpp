@@ -0,0 +1,44 @@
+// clock_config_gtest.cpp - Google Test framework tests for clock domain settings
+#include <gtest/gtest.h>
+
+#include "utils/clock_config.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Test that each domain takes its frequency in MHz
+TEST(ClockConfigTest, SetsDomains) {
+    ClockConfig clocks;
+    EXPECT_TRUE(clocks.Set("mesh=1200"));
+    EXPECT_TRUE(clocks.Set("spad=500"));
+    EXPECT_TRUE(clocks.Set("dram=800.5"));
+    EXPECT_TRUE(clocks.Set("cmd=250"));
+    EXPECT_DOUBLE_EQ(clocks.mesh_mhz, 1200.0);
+    EXPECT_DOUBLE_EQ(clocks.spad_mhz, 500.0);
+    EXPECT_DOUBLE_EQ(clocks.dram_mhz, 800.5);
+    EXPECT_DOUBLE_EQ(clocks.cmd_mhz, 250.0);
+}
+
+// Test that values with units or trailing text are rejected instead of truncated
+TEST(ClockConfigTest, RejectsMalformedValues) {
+    ClockConfig clocks;
+    EXPECT_FALSE(clocks.Set("mesh=1ghz"));
+    EXPECT_FALSE(clocks.Set("mesh=800MHz"));
+    EXPECT_FALSE(clocks.Set("mesh="));
+    EXPECT_FALSE(clocks.Set("mesh=fast"));
+    EXPECT_FALSE(clocks.Set("mesh=0"));
+    EXPECT_FALSE(clocks.Set("mesh=-100"));
+    EXPECT_FALSE(clocks.Set("mesh=inf"));
+    EXPECT_FALSE(clocks.Set("mesh"));
+    EXPECT_FALSE(clocks.Set("noc=1000"));
+    EXPECT_DOUBLE_EQ(clocks.mesh_mhz, 1000.0);
+}
+
+} // namespace test
+} // namespace gemmini
@@ -0,0 +1,54 @@
+// drain_pipeline_gtest.cpp - Google Test framework tests for the accumulator drain pipeline
+#include <gtest/gtest.h>
+
+#include "execute/drain_pipeline.hpp"
+#include "gemmini/common.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Test that a drain takes its bytes at the pipeline width plus the fixed latency
+TEST(DrainPipelineTest, SingleDrain) {
+    DrainPipeline pipeline(16, 4);
+    EXPECT_EQ(pipeline.Issue(10, 64), 10u + 4u + 4u);
+    EXPECT_EQ(pipeline.FreeCycle(), 14u);
+    EXPECT_EQ(pipeline.BusyCycles(), 4u);
+
+    // Partial beats round up
+    EXPECT_EQ(pipeline.Issue(100, 17), 100u + 2u + 4u);
+}
+
+// Test that back-to-back drains queue behind each other but overlap their latency
+TEST(DrainPipelineTest, BackToBack) {
+    DrainPipeline pipeline(16, 4);
+    uint64_t first = pipeline.Issue(0, 64);
+    uint64_t second = pipeline.Issue(1, 64);
+    EXPECT_EQ(first, 8u);
+    EXPECT_EQ(second, 12u);
+    EXPECT_EQ(pipeline.BusyCycles(), 8u);
+
+    // An idle pipeline starts a new drain right away
+    EXPECT_EQ(pipeline.Issue(50, 32), 56u);
+}
+
+// Test that a rate change applies to later drains only
+TEST(DrainPipelineTest, RateChange) {
+    DrainPipeline pipeline(16, 4);
+    EXPECT_EQ(pipeline.Issue(0, 64), 8u);
+    pipeline.SetRate(8, 10);
+    EXPECT_EQ(pipeline.BytesPerCycle(), 8u);
+    EXPECT_EQ(pipeline.Issue(4, 64), 4u + 8u + 10u);
+
+    // A zero width is clamped like in the constructor
+    pipeline.SetRate(0, 0);
+    EXPECT_EQ(pipeline.BytesPerCycle(), 1u);
+}
+
+} // namespace test
+} // namespace gemmini
@@ -0,0 +1,118 @@
+// dram_trace_gtest.cpp - Google Test framework tests for the DRAM trace writer
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "utils/dram_trace.hpp"
+#include "gemmini/common.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Test fixture for DRAM trace tests
+class DramTraceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char tmpl[] = "/tmp/dram_trace_gtest.XXXXXX";
+        int fd = mkstemp(tmpl);
+        ASSERT_GE(fd, 0);
+        close(fd);
+        path = tmpl;
+    }
+
+    void TearDown() override {
+        unlink(path.c_str());
+    }
+
+    std::vector<std::string> ReadLines() const {
+        std::ifstream file(path);
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(file, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    std::string path;
+};
+
+// Test that transfers are split into aligned bursts spaced by the DMA bandwidth
+TEST_F(DramTraceTest, DRAMSim3Bursts) {
+    DramTraceConfig config;
+    config.path = path;
+    config.burst_bytes = 64;
+    config.bytes_per_cycle = 16;
+    DramTraceWriter writer(config);
+    writer.Record(100, 0x1020, 100, false);
+    writer.Record(200, 0x4000, 64, true);
+    writer.Close();
+
+    std::vector<std::string> lines = ReadLines();
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[0], "0x1000 READ 100");
+    EXPECT_EQ(lines[1], "0x1040 READ 104");
+    EXPECT_EQ(lines[2], "0x1080 READ 108");
+    EXPECT_EQ(lines[3], "0x4000 WRITE 200");
+    EXPECT_EQ(writer.NumTransfers(), 2u);
+    EXPECT_EQ(writer.NumBursts(), 4u);
+}
+
+// Test that a bandwidth change applies to transfers recorded after it
+TEST_F(DramTraceTest, BandwidthChange) {
+    DramTraceConfig config;
+    config.path = path;
+    config.burst_bytes = 64;
+    config.bytes_per_cycle = 16;
+    DramTraceWriter writer(config);
+    writer.Record(0, 0x0, 128, false);
+    writer.SetBytesPerCycle(64);
+    writer.Record(10, 0x1000, 128, false);
+    writer.Close();
+
+    std::vector<std::string> lines = ReadLines();
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[1], "0x40 READ 4");
+    EXPECT_EQ(lines[3], "0x1040 READ 11");
+}
+
+// Test the Ramulator format and that small buffers hand off to the writer in order
+TEST_F(DramTraceTest, RamulatorBufferedInOrder) {
+    DramTraceConfig config;
+    config.path = path;
+    config.format = DramTraceFormat::Ramulator;
+    config.buffer_transfers = 7;
+    {
+        DramTraceWriter writer(config);
+        for (uint64_t i = 0; i < 1000; ++i) {
+            writer.Record(i, i * 64, 64, i % 3 == 0);
+        }
+    }
+
+    std::vector<std::string> lines = ReadLines();
+    ASSERT_EQ(lines.size(), 1000u);
+    for (uint64_t i = 0; i < lines.size(); ++i) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "0x%llx %c", static_cast<unsigned long long>(i * 64),
+                 i % 3 == 0 ? 'W' : 'R');
+        ASSERT_EQ(lines[i], expected);
+    }
+
+    DramTraceFormat format;
+    EXPECT_TRUE(ParseDramTraceFormat("ramulator", format));
+    EXPECT_EQ(format, DramTraceFormat::Ramulator);
+    EXPECT_FALSE(ParseDramTraceFormat("ddr4", format));
+}
+
+} // namespace test
+} // namespace gemmini
@@ -0,0 +1,94 @@
+// host_interface_gtest.cpp - Google Test framework tests for the host command-issue model
+#include <gtest/gtest.h>
+
+#include "execute/host_interface.hpp"
+#include "gemmini/common.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Test that commands arrive one issue time apart, starting when the work is submitted
+TEST(HostInterfaceTest, IssueSpacing) {
+    HostConfig config;
+    config.issue_cycles = 10;
+    HostInterface host(config);
+    host.Submit(100);
+    EXPECT_EQ(host.Issue(), 110u);
+    EXPECT_EQ(host.Issue(), 120u);
+    EXPECT_EQ(host.Commands(), 2u);
+
+    // A free host issues instantly
+    HostInterface instant;
+    EXPECT_EQ(instant.Issue(), 0u);
+}
+
+// Test that a full command queue holds the host until the oldest command retires
+TEST(HostInterfaceTest, QueueDepth) {
+    HostConfig config;
+    config.issue_cycles = 1;
+    config.queue_depth = 2;
+    HostInterface host(config);
+    EXPECT_EQ(host.Issue(), 1u);
+    host.Retire(50);
+    EXPECT_EQ(host.Issue(), 2u);
+    host.Retire(60);
+
+    // The third command needs the first one's slot
+    EXPECT_EQ(host.Issue(), 51u);
+    EXPECT_EQ(host.QueueFullCycles(), 48u);
+
+    // Commands leave in order, an early finish waits for the older command
+    host.Retire(40);
+    EXPECT_EQ(host.Issue(), 61u);
+}
+
+// Test that a fence waits for the last command and then pays its cost
+TEST(HostInterfaceTest, Fence) {
+    HostConfig config;
+    config.issue_cycles = 5;
+    config.fence_cycles = 20;
+    HostInterface host(config);
+    EXPECT_EQ(host.Issue(), 5u);
+    EXPECT_EQ(host.Fence(30), 50u);
+    EXPECT_EQ(host.Issue(), 55u);
+    EXPECT_EQ(host.Fences(), 1u);
+    EXPECT_EQ(host.FenceCycles(), 20u);
+}
+
+// Test that two copies of one host diverge once a what-if knob changes one of them
+TEST(HostInterfaceTest, ForkedVariantsDiverge) {
+    HostConfig config;
+    config.issue_cycles = 2;
+    config.fence_cycles = 10;
+    HostInterface warm(config);
+    for (int i = 0; i < 4; ++i) {
+        warm.Retire(warm.Issue());
+    }
+
+    HostInterface base = warm;
+    HostInterface slow = warm;
+    HostConfig slowConfig = slow.Config();
+    slowConfig.issue_cycles = 20;
+    slowConfig.fence_cycles = 100;
+    slow.SetConfig(slowConfig);
+
+    auto finish = [](HostInterface & host) {
+        uint64_t last = 0;
+        for (int i = 0; i < 4; ++i) {
+            last = host.Issue();
+            host.Retire(last);
+        }
+        return host.Fence(last);
+    };
+    EXPECT_EQ(finish(base), 8u + 4u * 2u + 10u);
+    EXPECT_EQ(finish(slow), 8u + 4u * 20u + 100u);
+}
+
+} // namespace test
+} // namespace gemmini
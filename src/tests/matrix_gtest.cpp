@@ -0,0 +1,180 @@
+// matrix_gtest.cpp - Google Test framework tests for Gemmini Matrix storage
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+#include "gemmini/matrix.hpp"
+#include "gemmini/common.hpp"
+#include "utils/arena.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Test fixture for Matrix tests
+class MatrixTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Create a 6x7 matrix so the 4x4 tiles do not divide it evenly
+        matrix = std::make_shared<Matrix>(6, 7);
+        for (uint32_t r = 0; r < matrix->Rows(); ++r) {
+            for (uint32_t c = 0; c < matrix->Cols(); ++c) {
+                matrix->At(r, c) = static_cast<int16_t>(r * 100 + c);
+            }
+        }
+    }
+
+    void TearDown() override {
+        // No cleanup needed
+    }
+
+    // Common test resources
+    MatrixPtr matrix;
+};
+
+//=============================================================================
+// SECTION 1: Layout Conversion Tests
+//=============================================================================
+
+// Element access is unchanged after converting to tile-major
+TEST_F(MatrixTest, TileMajorPreservesElements) {
+    matrix->ToTileMajor(4, 4);
+
+    ASSERT_EQ(matrix->Layout(), MatrixLayout::TileMajor);
+    EXPECT_TRUE(matrix->IsTileMajor(4, 4));
+    for (uint32_t r = 0; r < matrix->Rows(); ++r) {
+        for (uint32_t c = 0; c < matrix->Cols(); ++c) {
+            EXPECT_EQ(matrix->At(r, c), static_cast<int16_t>(r * 100 + c))
+                << "Mismatch at (" << r << "," << c << ")";
+        }
+    }
+}
+
+// Converting back to row-major restores the original layout
+TEST_F(MatrixTest, RoundTripToRowMajor) {
+    matrix->ToTileMajor(4, 4);
+    matrix->set(5, 6, 42);
+    matrix->ToRowMajor();
+
+    ASSERT_EQ(matrix->Layout(), MatrixLayout::RowMajor);
+    EXPECT_EQ(matrix->get(5, 6), 42);
+    EXPECT_EQ(matrix->get(3, 2), 302);
+}
+
+//=============================================================================
+// SECTION 2: Tile View Tests
+//=============================================================================
+
+// Tiles of a tile-major matrix are contiguous and need no copy
+TEST_F(MatrixTest, TileViewContiguous) {
+    matrix->ToTileMajor(4, 4);
+    Matrix::TileView tile = matrix->Tile(1, 1, 4, 4);
+
+    ASSERT_TRUE(tile.IsContiguous());
+    EXPECT_EQ(tile.Rows(), 2u);
+    EXPECT_EQ(tile.Cols(), 3u);
+    EXPECT_EQ(tile.Data()[0], 404);
+    EXPECT_EQ(tile.At(1, 2), 506);
+}
+
+// Tiles of a row-major matrix fall back to strided access
+TEST_F(MatrixTest, TileViewStrided) {
+    Matrix::TileView tile = matrix->Tile(0, 1, 4, 4);
+
+    EXPECT_FALSE(tile.IsContiguous());
+    EXPECT_EQ(tile.Rows(), 4u);
+    EXPECT_EQ(tile.Cols(), 3u);
+    EXPECT_EQ(tile.At(3, 0), 304);
+}
+
+//=============================================================================
+// SECTION 3: Padded Stride Tests
+//=============================================================================
+
+// Padded rows are aligned to a cache line and a multiple of the array width
+TEST_F(MatrixTest, PaddedStrideAlignment) {
+    Matrix padded(5, 20, 16);
+
+    EXPECT_EQ(padded.Cols(), 20u);
+    EXPECT_EQ(padded.Stride(), 32u);
+    for (uint32_t r = 0; r < padded.Rows(); ++r) {
+        uintptr_t addr = reinterpret_cast<uintptr_t>(padded.RowData(r));
+        EXPECT_EQ(addr % kCacheLineBytes, 0u) << "Row " << r << " is not 64-byte aligned";
+    }
+}
+
+// Unpadded matrices keep stride equal to the column count
+TEST_F(MatrixTest, DefaultStrideIsCols) {
+    EXPECT_EQ(matrix->Stride(), matrix->Cols());
+}
+
+// Row copies and tile conversion respect the padded stride
+TEST_F(MatrixTest, PaddedRowCopyAndTiling) {
+    Matrix padded(3, 5, 4);
+    for (uint32_t r = 0; r < padded.Rows(); ++r) {
+        for (uint32_t c = 0; c < padded.Cols(); ++c) {
+            padded.At(r, c) = static_cast<int16_t>(r * 10 + c);
+        }
+    }
+
+    std::vector<int16_t> row(padded.Cols());
+    padded.CopyRow(2, row.data());
+    EXPECT_EQ(row[4], 24);
+
+    padded.ToTileMajor(4, 4);
+    padded.CopyRow(1, row.data());
+    EXPECT_EQ(row[3], 13);
+
+    padded.ToRowMajor();
+    EXPECT_EQ(padded.Stride(), 32u);
+    EXPECT_EQ(padded.get(2, 4), 24);
+}
+
+//=============================================================================
+// SECTION 4: Arena Allocation Tests
+//=============================================================================
+
+// Matrices created while an arena is current are served from that arena
+TEST_F(MatrixTest, ArenaBackedMatrix) {
+    Arena arena(1 << 16);
+    {
+        ArenaScope scope(&arena);
+        MatrixPtr local = CreateMatrixPtr<Matrix>(8, 8, 16);
+        local->At(7, 7) = 5;
+        local->ToTileMajor(4, 4);
+
+        EXPECT_EQ(local->At(7, 7), 5);
+        EXPECT_GT(arena.BytesAllocated(), 8u * 32u * sizeof(int16_t));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(local->Tile(0, 0, 4, 4).Data()) % kCacheLineBytes,
+                  0u);
+    }
+    EXPECT_EQ(Arena::Current(), nullptr);
+    EXPECT_EQ(arena.BytesLive(), 0u);
+
+    // Allocations outside the scope use the global heap
+    size_t before = arena.BytesAllocated();
+    Matrix heap(4, 4);
+    EXPECT_EQ(arena.BytesAllocated(), before);
+}
+
+// Transient payloads bypass the current arena and are freed with their last reference
+TEST_F(MatrixTest, TransientPayloadsUseHeap) {
+    Arena arena(1 << 16);
+    ArenaScope scope(&arena);
+    MatrixPtr tile = CreateTransientPtr<Matrix>(4, 4);
+    VectorPtr vec = CreateTransientPtr<Vector>(16);
+    tile->ToTileMajor(2, 2);
+    EXPECT_EQ(arena.BytesAllocated(), 0u);
+    EXPECT_EQ(Arena::Current(), &arena);
+
+    MatrixPtr operand = CreateMatrixPtr<Matrix>(4, 4);
+    EXPECT_GT(arena.BytesAllocated(), 0u);
+}
+
+} // namespace test
+} // namespace gemmini
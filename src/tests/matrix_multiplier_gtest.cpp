@@ -0,0 +1,142 @@
+// matrix_multiplier_gtest.cpp - Google Test framework tests for whole Gemmini multiplications
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+
+#include "gemmini/gemmini.hpp"
+#include "gemmini/matrix.hpp"
+#include "sparta/kernel/Scheduler.hpp"
+#include "sparta/app/SimulationConfiguration.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+namespace {
+
+MatrixPtr RandomMatrix(uint32_t rows, uint32_t cols, std::mt19937 & gen) {
+    MatrixPtr matrix = CreateMatrixPtr<Matrix>(rows, cols);
+    std::uniform_int_distribution<int> dist(-8, 8);
+    for (uint32_t r = 0; r < rows; ++r) {
+        for (uint32_t c = 0; c < cols; ++c) {
+            matrix->At(r, c) = static_cast<int16_t>(dist(gen));
+        }
+    }
+    return matrix;
+}
+
+// Reference product, saturated to the 16-bit result matrix like the accelerator's
+MatrixPtr Reference(const Matrix & a, const Matrix & b) {
+    MatrixPtr c = CreateMatrixPtr<Matrix>(a.Rows(), b.Cols());
+    for (uint32_t r = 0; r < a.Rows(); ++r) {
+        for (uint32_t n = 0; n < b.Cols(); ++n) {
+            int64_t sum = 0;
+            for (uint32_t k = 0; k < a.Cols(); ++k) {
+                sum += int32_t(a.At(r, k)) * b.At(k, n);
+            }
+            c->At(r, n) = static_cast<int16_t>(std::clamp<int64_t>(sum, INT16_MIN, INT16_MAX));
+        }
+    }
+    return c;
+}
+
+} // namespace
+
+// Simulation tree built and finalized for one test
+struct TestSimulation {
+    explicit TestSimulation(const ClockConfig & clocks = ClockConfig()) {
+        char progName[] = "matrix_multiplier_gtest";
+        char* argv[] = {progName, nullptr};
+        sim.reset(new GemminiSimulation(&scheduler, clocks));
+        sim->configure(1, argv, &config);
+        sim->buildTree();
+        sim->configureTree();
+        sim->finalizeTree();
+        sim->finalizeFramework();
+        sim->SetPrintResults(false);
+    }
+
+    ~TestSimulation() { sim.reset(); }
+
+    sparta::Scheduler scheduler;
+    sparta::app::SimulationConfiguration config;
+    std::unique_ptr<GemminiSimulation> sim;
+};
+
+// Test fixture running multiplications on the default 4x4 simulator
+class MatrixMultiplierTest : public ::testing::Test {
+protected:
+    // Multiply MxK by KxN random matrices and compare every element with the reference
+    void CheckProduct(uint32_t m, uint32_t k, uint32_t n) {
+        std::mt19937 gen(m * 10007 + k * 101 + n);
+        MatrixPtr a = RandomMatrix(m, k, gen);
+        MatrixPtr b = RandomMatrix(k, n, gen);
+        MatrixPtr expected = Reference(*a, *b);
+
+        TestSimulation test;
+        MatrixPtr result = test.sim->RunSimulation(a, b);
+        ASSERT_TRUE(result);
+        ASSERT_EQ(result->Rows(), m);
+        ASSERT_EQ(result->Cols(), n);
+        for (uint32_t r = 0; r < m; ++r) {
+            for (uint32_t c = 0; c < n; ++c) {
+                EXPECT_EQ(result->At(r, c), expected->At(r, c)) << "at (" << r << "," << c << ")";
+            }
+        }
+
+        // The caller's B keeps its layout
+        EXPECT_EQ(b->Layout(), MatrixLayout::RowMajor);
+    }
+};
+
+// Test a product that fills whole array tiles
+TEST_F(MatrixMultiplierTest, WholeTiles) {
+    CheckProduct(8, 8, 8);
+}
+
+// Test an M edge block: the last row block has a single row
+TEST_F(MatrixMultiplierTest, PartialRowBlock) {
+    CheckProduct(5, 4, 4);
+}
+
+// Test M and N edges together with K spanning several tiles, the last one partial
+TEST_F(MatrixMultiplierTest, EdgeBlocksWithKTiles) {
+    CheckProduct(6, 10, 7);
+}
+
+// Test a narrow N edge block with wide K tiles
+TEST_F(MatrixMultiplierTest, NarrowColumnBlock) {
+    CheckProduct(3, 12, 5);
+}
+
+// Test that DMA transfers take DRAM clock time: a slower DRAM clock delays the result
+TEST_F(MatrixMultiplierTest, SlowDramStretchesRun) {
+    std::mt19937 gen(7);
+    MatrixPtr a = RandomMatrix(16, 64, gen);
+    MatrixPtr b = RandomMatrix(64, 16, gen);
+
+    TestSimulation fast;
+    MatrixPtr fastResult = fast.sim->RunSimulation(a, b);
+
+    ClockConfig clocks;
+    clocks.dram_mhz = 100.0;
+    TestSimulation slow(clocks);
+    MatrixPtr slowResult = slow.sim->RunSimulation(a, b);
+
+    ASSERT_TRUE(fastResult && slowResult);
+    EXPECT_GT(slow.sim->GetResultTick(), fast.sim->GetResultTick());
+    for (uint32_t r = 0; r < a->Rows(); ++r) {
+        for (uint32_t c = 0; c < b->Cols(); ++c) {
+            EXPECT_EQ(slowResult->At(r, c), fastResult->At(r, c));
+        }
+    }
+}
+
+} // namespace test
+} // namespace gemmini
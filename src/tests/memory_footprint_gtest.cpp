@@ -0,0 +1,102 @@
+// memory_footprint_gtest.cpp - Google Test framework tests for host memory accounting
+#include <gtest/gtest.h>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "gemmini/common.hpp"
+#include "utils/memory_footprint.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Test fixture for memory footprint tests
+class MemoryFootprintTest : public ::testing::Test {
+protected:
+    void SetUp() override { MemoryFootprint::SetCurrent(&footprint); }
+
+    void TearDown() override { MemoryFootprint::SetCurrent(nullptr); }
+
+    // Common test resources
+    MemoryFootprint footprint;
+    std::vector<std::unique_ptr<char[]>> blocks;
+};
+
+// Nested scopes attribute memory to the innermost unit and one level per nesting
+TEST_F(MemoryFootprintTest, NestedScopes) {
+    if (MemoryFootprint::HeapBytes() == 0) {
+        GTEST_SKIP() << "Allocator does not report heap usage";
+    }
+
+    {
+        FootprintScope array("Array");
+        blocks.emplace_back(new char[64 * 1024]);
+        for (int i = 0; i < 4; ++i) {
+            FootprintScope element("Element");
+            blocks.emplace_back(new char[256 * 1024]);
+        }
+    }
+
+    const auto & byType = footprint.ByType();
+    ASSERT_EQ(byType.count("Array"), 1u);
+    ASSERT_EQ(byType.count("Element"), 1u);
+    EXPECT_EQ(byType.at("Element").count, 4u);
+    EXPECT_GE(byType.at("Element").bytes, 4u * 256 * 1024);
+    EXPECT_GE(byType.at("Array").bytes, 64u * 1024);
+    EXPECT_LT(byType.at("Array").bytes, 256u * 1024) << "Nested memory counted twice";
+
+    EXPECT_EQ(footprint.ByLevel().at(1).count, 1u);
+    EXPECT_EQ(footprint.ByLevel().at(2).count, 4u);
+    EXPECT_EQ(footprint.TotalBytes(), byType.at("Array").bytes + byType.at("Element").bytes);
+}
+
+// Scopes record nothing without a current footprint
+TEST_F(MemoryFootprintTest, DisabledWithoutFootprint) {
+    MemoryFootprint::SetCurrent(nullptr);
+    {
+        FootprintScope scope("Unit");
+        blocks.emplace_back(new char[4096]);
+    }
+    EXPECT_TRUE(footprint.ByType().empty());
+}
+
+// Estimates can be added directly and show up in the report
+TEST_F(MemoryFootprintTest, ReportAndRss) {
+    footprint.Add("Payloads", 1, 3 * 1024);
+    std::stringstream ss;
+    ss << footprint;
+    EXPECT_NE(ss.str().find("Payloads"), std::string::npos);
+    EXPECT_NE(ss.str().find("level 1"), std::string::npos);
+
+    ASSERT_TRUE(MemoryFootprint::CanMeasureRss());
+    EXPECT_GT(MemoryFootprint::RssBytes(), 0u);
+}
+
+// The heap counters see an allocation made on this thread
+TEST_F(MemoryFootprintTest, HeapCountersMeasure) {
+    ASSERT_TRUE(MemoryFootprint::CanMeasureHeap());
+    uint64_t before = MemoryFootprint::HeapBytes();
+    std::unique_ptr<char[]> block(new char[1 << 20]);
+    block[0] = 1;
+    EXPECT_GE(MemoryFootprint::HeapBytes(), before + (1 << 20));
+}
+
+// Node counts are reported per unit type and per instance
+TEST_F(MemoryFootprintTest, ReportsTreeNodes) {
+    footprint.Add("PE", 3, 4096, 4);
+    footprint.AddNodes("PE", 4 * 9);
+    footprint.SetTreeNodes(50);
+    std::stringstream ss;
+    ss << footprint;
+    EXPECT_NE(ss.str().find("in 50 tree node(s)"), std::string::npos) << ss.str();
+    EXPECT_NE(ss.str().find("36 tree node(s) (9 each)"), std::string::npos) << ss.str();
+}
+
+} // namespace test
+} // namespace gemmini
@@ -0,0 +1,148 @@
+// mx_format_gtest.cpp - Google Test framework tests for the microscaling block formats
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "execute/mx_format.hpp"
+#include "gemmini/common.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Build a format with the given element type and block size
+static MxFormat Format(MxElement element, uint32_t block = 32) {
+    MxFormat format;
+    format.element = element;
+    format.block_size = block;
+    return format;
+}
+
+// Test that packed elements plus one scale byte per block set the transfer size
+TEST(MxFormatTest, Bytes) {
+    EXPECT_EQ(Format(MxElement::None).Bytes(32), 64u);
+    EXPECT_EQ(Format(MxElement::Int8).Bytes(32), 33u);
+    EXPECT_EQ(Format(MxElement::Fp8E4M3, 16).Bytes(32), 34u);
+    EXPECT_EQ(Format(MxElement::Fp4E2M1).Bytes(32), 17u);
+    EXPECT_EQ(Format(MxElement::Fp4E2M1).Bytes(33), 19u);
+
+    MxElement element;
+    EXPECT_TRUE(ParseMxElement("mxfp4", element));
+    EXPECT_EQ(element, MxElement::Fp4E2M1);
+    EXPECT_STREQ(MxElementName(element), "mxfp4");
+    EXPECT_FALSE(ParseMxElement("fp64", element));
+}
+
+// Test that elements round to the nearest value of their format and saturate
+TEST(MxFormatTest, ElementRounding) {
+    MxFormat fp4 = Format(MxElement::Fp4E2M1);
+    EXPECT_EQ(fp4.Quantize(1.5, 0), 3);    // 1.5 in 1 fractional bit
+    EXPECT_EQ(fp4.Quantize(2.9, 0), 6);    // Rounds to 3
+    EXPECT_EQ(fp4.Quantize(-5.0, 0), -8);  // Tie between 4 and 6 goes to even
+    EXPECT_EQ(fp4.Quantize(100.0, 0), 12); // Saturates at 6
+    EXPECT_EQ(fp4.Quantize(12.0, 1), 12);  // 12 / 2^1 = 6
+
+    MxFormat fp8 = Format(MxElement::Fp8E4M3);
+    EXPECT_EQ(fp8.Quantize(300.0, 0), 288 * 4);
+
+    MxFormat int8 = Format(MxElement::Int8);
+    EXPECT_EQ(int8.Quantize(0.5, 0), 32);
+    EXPECT_EQ(int8.Quantize(-4.0, 0), -127);
+    EXPECT_DOUBLE_EQ(int8.Dequantize(32, 3), 4.0);
+}
+
+// Test that a block shares the scale of its largest element and round-trips within half
+// a step of that scale
+TEST(MxFormatTest, BlockRoundTrip) {
+    std::vector<double> values = {1000.0, -3.0, 250.0, 7.0, -512.0, 0.0};
+    std::vector<int16_t> fixed(values.size());
+    MxFormat int8 = Format(MxElement::Int8);
+    int32_t scale = int8.QuantizeBlock(values.data(), values.size(), fixed.data());
+    EXPECT_EQ(scale, 9);
+    double step = std::ldexp(1.0, scale - int32_t(int8.FractionBits()));
+    for (size_t i = 0; i < values.size(); ++i) {
+        EXPECT_NEAR(int8.Dequantize(fixed[i], scale), values[i], step / 2) << i;
+    }
+}
+
+// Test that integer MACs on fixed-point elements followed by the block scales give the
+// dot product
+TEST(MxFormatTest, ScaledDotProduct) {
+    std::vector<double> a = {120.0, -64.0, 33.0, 7.0};
+    std::vector<double> b = {-2.0, 15.0, 9.5, -30.0};
+    double exact = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        exact += a[i] * b[i];
+    }
+
+    for (MxElement element : {MxElement::Int8, MxElement::Fp8E4M3, MxElement::Fp4E2M1}) {
+        MxFormat format = Format(element);
+        std::vector<int16_t> fa(a.size()), fb(b.size());
+        int32_t sa = format.QuantizeBlock(a.data(), a.size(), fa.data());
+        int32_t sb = format.QuantizeBlock(b.data(), b.size(), fb.data());
+        int32_t sum = 0;
+        for (size_t i = 0; i < a.size(); ++i) {
+            sum += int32_t(fa[i]) * fb[i];
+        }
+        double result = format.ScaleSum(sum, sa, sb);
+        // Relative error follows the element's mantissa width
+        double tolerance = element == MxElement::Int8      ? 0.02
+                           : element == MxElement::Fp8E4M3 ? 0.05
+                                                           : 0.25;
+        EXPECT_NEAR(result, exact, std::fabs(exact) * tolerance) << MxElementName(element);
+    }
+}
+
+// Test that a K longer than one block is summed block by block, each partial sum with its
+// own scales, so a block of small values is not lost next to a block of large ones
+TEST(MxFormatTest, MultiBlockDotProduct) {
+    MxFormat format = Format(MxElement::Int8, 16);
+    const uint32_t k = 40;
+    std::vector<double> a(k), b(k);
+    double exact = 0.0;
+    for (uint32_t i = 0; i < k; ++i) {
+        a[i] = i < 16 ? 900.0 + i : 0.5 + 0.25 * (i % 5);
+        b[i] = i % 3 == 0 ? -2.0 : 3.0;
+        exact += a[i] * b[i];
+    }
+    EXPECT_EQ(format.Blocks(k), 3u);
+    EXPECT_EQ(format.Blocks(32), 2u);
+
+    double result = 0.0;
+    std::vector<int16_t> fa(k), fb(k);
+    for (uint32_t begin = 0; begin < k; begin += format.block_size) {
+        uint32_t count = std::min(k - begin, format.block_size);
+        int32_t sa = format.QuantizeBlock(&a[begin], count, &fa[begin]);
+        int32_t sb = format.QuantizeBlock(&b[begin], count, &fb[begin]);
+        int64_t sum = 0;
+        for (uint32_t i = begin; i < begin + count; ++i) {
+            sum += int32_t(fa[i]) * fb[i];
+        }
+        result += format.ScaleSum(sum, sa, sb);
+    }
+    EXPECT_NEAR(result, exact, std::fabs(exact) * 0.01);
+
+    // The small blocks alone are reproduced as well
+    double tail = 0.0, tailExact = 0.0;
+    for (uint32_t begin = 16; begin < k; begin += format.block_size) {
+        uint32_t count = std::min(k - begin, format.block_size);
+        int32_t sa = format.QuantizeBlock(&a[begin], count, &fa[begin]);
+        int32_t sb = format.QuantizeBlock(&b[begin], count, &fb[begin]);
+        int64_t sum = 0;
+        for (uint32_t i = begin; i < begin + count; ++i) {
+            sum += int32_t(fa[i]) * fb[i];
+            tailExact += a[i] * b[i];
+        }
+        tail += format.ScaleSum(sum, sa, sb);
+    }
+    EXPECT_NEAR(tail, tailExact, std::fabs(tailExact) * 0.02);
+}
+
+} // namespace test
+} // namespace gemmini
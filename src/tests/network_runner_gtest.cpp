@@ -0,0 +1,158 @@
+// network_runner_gtest.cpp - Google Test framework tests for the multi-instance network runner
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "driver/network_runner.hpp"
+#include "gemmini/common.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// A chain of GEMM layers with the given (m, k, n) shapes
+static std::vector<Layer> Chain(const std::vector<std::vector<uint32_t>> & shapes) {
+    std::vector<Layer> layers;
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        Layer layer;
+        layer.name = "fc" + std::to_string(i);
+        layer.m = shapes[i][0];
+        layer.k = shapes[i][1];
+        layer.n = shapes[i][2];
+        layers.push_back(layer);
+    }
+    return layers;
+}
+
+// Test that stages are balanced so the slowest one is as fast as possible
+TEST(NetworkRunnerTest, BalancesStages) {
+    NetworkConfig config;
+    config.instances = 2;
+    NetworkRunner runner(config);
+
+    // One heavy layer followed by three light ones: the heavy layer gets its own stage
+    std::vector<Layer> layers = Chain({{16, 256, 256}, {16, 32, 32}, {16, 32, 32},
+                                       {16, 32, 32}});
+    std::vector<uint32_t> firsts = runner.Balance(layers, 2);
+    ASSERT_EQ(firsts.size(), 2u);
+    EXPECT_EQ(firsts[0], 0u);
+    EXPECT_EQ(firsts[1], 1u);
+
+    // More instances than layers use one stage per layer
+    EXPECT_EQ(runner.Balance(Chain({{4, 4, 4}, {4, 4, 4}}), 8).size(), 2u);
+}
+
+// Test that a balanced pipeline beats one instance and that data parallelism has the
+// better makespan for equal stages while the pipeline has the better first-sample latency
+TEST(NetworkRunnerTest, PipelineVersusDataParallel) {
+    std::vector<Layer> layers = Chain({{16, 64, 64}, {16, 64, 64}, {16, 64, 64},
+                                       {16, 64, 64}});
+    NetworkConfig config;
+    config.samples = 16;
+
+    config.instances = 1;
+    NetworkReport single = NetworkRunner(config).Run(layers, NetworkMode::Pipeline);
+
+    config.instances = 4;
+    NetworkRunner runner(config);
+    NetworkReport pipeline = runner.Run(layers, NetworkMode::Pipeline);
+    NetworkReport data = runner.Run(layers, NetworkMode::DataParallel);
+
+    EXPECT_EQ(pipeline.stages.size(), 4u);
+    EXPECT_LT(pipeline.makespan_cycles, single.makespan_cycles);
+    EXPECT_LE(data.makespan_cycles, pipeline.makespan_cycles);
+    // Every instance reads the weights for its first sample only
+    uint64_t weightBytes = 0;
+    for (const Layer & layer : layers) {
+        weightBytes += runner.WeightBytes(layer);
+    }
+    uint64_t weightRead = (weightBytes + config.memory.dma_bytes_per_cycle - 1) /
+                          config.memory.dma_bytes_per_cycle;
+    EXPECT_EQ(data.makespan_cycles, 4 * single.first_latency_cycles - 3 * weightRead);
+    EXPECT_GT(pipeline.Throughput(), single.Throughput());
+}
+
+// Test that data-parallel instances pay for reading weights and inputs from memory, and
+// read the weights again for every sample when they do not fit the scratchpad
+TEST(NetworkRunnerTest, DataParallelReadsFromMemory) {
+    std::vector<Layer> layers = Chain({{16, 256, 256}, {16, 256, 256}});
+    NetworkConfig config;
+    config.instances = 2;
+    config.samples = 8;
+    NetworkRunner runner(config);
+    uint64_t compute = runner.LayerCycles(layers[0]) + runner.LayerCycles(layers[1]);
+    uint64_t inputRead = runner.InputBytes(layers[0]) / config.memory.dma_bytes_per_cycle;
+    uint64_t weightRead = (runner.WeightBytes(layers[0]) + runner.WeightBytes(layers[1])) /
+                          config.memory.dma_bytes_per_cycle;
+
+    NetworkReport resident = runner.Run(layers, NetworkMode::DataParallel);
+    EXPECT_EQ(resident.first_latency_cycles, weightRead + inputRead + compute);
+    EXPECT_EQ(resident.makespan_cycles, weightRead + 4 * (inputRead + compute));
+    EXPECT_EQ(resident.stages[0].transfer_cycles, (weightRead + 4 * inputRead) / 4);
+
+    config.memory.scratchpad_bytes = 64 * 1024;
+    NetworkReport streamed = NetworkRunner(config).Run(layers, NetworkMode::DataParallel);
+    EXPECT_EQ(streamed.makespan_cycles, 4 * (weightRead + inputRead + compute));
+}
+
+// Test that a shared buffer too small for one activation per stage stalls the producer
+TEST(NetworkRunnerTest, SmallBufferStalls) {
+    // A fast first stage feeding a slow second stage
+    std::vector<Layer> layers = Chain({{64, 16, 64}, {64, 64, 512}});
+    NetworkConfig config;
+    config.instances = 2;
+    config.samples = 8;
+
+    config.buffer_bytes = 1 << 30;
+    NetworkReport roomy = NetworkRunner(config).Run(layers, NetworkMode::Pipeline);
+    config.buffer_bytes = 1;
+    NetworkReport tight = NetworkRunner(config).Run(layers, NetworkMode::Pipeline);
+
+    EXPECT_EQ(roomy.stall_cycles, 0u);
+    EXPECT_EQ(tight.buffer_slots, 1u);
+    EXPECT_GT(tight.stall_cycles, 0u);
+
+    // The bottleneck stage sets the makespan either way
+    EXPECT_EQ(tight.makespan_cycles, roomy.makespan_cycles);
+}
+
+// Test that instances contending for one memory controller limit data-parallel scaling and
+// that a second controller relieves it
+TEST(NetworkRunnerTest, InterconnectContention) {
+    std::vector<Layer> layers = Chain({{16, 512, 512}, {16, 512, 512}});
+    NetworkConfig config;
+    config.instances = 4;
+    config.samples = 16;
+    config.memory.scratchpad_bytes = 64 * 1024;  // Weights are fetched for every sample
+    config.interconnect.topology = Topology::Crossbar;
+    config.interconnect.link_bytes = 8;
+    NetworkReport ideal = NetworkRunner(config).Run(layers, NetworkMode::DataParallel);
+
+    config.model_interconnect = true;
+    NetworkReport one = NetworkRunner(config).Run(layers, NetworkMode::DataParallel);
+    config.memory_controllers = 2;
+    NetworkReport two = NetworkRunner(config).Run(layers, NetworkMode::DataParallel);
+
+    EXPECT_TRUE(ideal.links.empty());
+    EXPECT_EQ(one.topology, "crossbar");
+    EXPECT_EQ(one.links.size(), 2u * 5);
+    EXPECT_GT(one.makespan_cycles, ideal.makespan_cycles);
+    EXPECT_GT(one.stages[0].transfer_cycles, 0u);
+    EXPECT_LT(two.makespan_cycles, one.makespan_cycles);
+
+    // The pipeline moves activations between instances over the same network
+    config.interconnect.topology = Topology::Mesh;
+    NetworkReport pipeline = NetworkRunner(config).Run(layers, NetworkMode::Pipeline);
+    ASSERT_EQ(pipeline.stages.size(), 2u);
+    EXPECT_EQ(pipeline.topology, "mesh");
+    EXPECT_GT(pipeline.makespan_cycles, 16 * pipeline.stages[0].compute_cycles);
+}
+
+} // namespace test
+} // namespace gemmini
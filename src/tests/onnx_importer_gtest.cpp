@@ -0,0 +1,243 @@
+// onnx_importer_gtest.cpp - Google Test framework tests for the ONNX importer and layer lists
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "driver/layer_list.hpp"
+#include "driver/onnx_importer.hpp"
+#include "driver/tensor_file.hpp"
+#include "gemmini/common.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Protobuf encoding helpers for building models in memory
+static std::string Varint(uint64_t value) {
+    std::string out;
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+    return out;
+}
+
+static std::string IntField(uint32_t field, int64_t value) {
+    return Varint(field << 3) + Varint(static_cast<uint64_t>(value));
+}
+
+static std::string BytesField(uint32_t field, const std::string & value) {
+    return Varint((field << 3) | 2) + Varint(value.size()) + value;
+}
+
+static std::string IntsAttr(const std::string & name, const std::vector<int64_t> & values) {
+    std::string attr = BytesField(1, name);
+    for (int64_t value : values) {
+        attr += IntField(8, value);
+    }
+    return BytesField(5, attr);
+}
+
+static std::string IntAttr(const std::string & name, int64_t value) {
+    return BytesField(5, BytesField(1, name) + IntField(3, value));
+}
+
+static std::string Node(const std::string & op, const std::string & name,
+                        const std::vector<std::string> & inputs, const std::string & output,
+                        const std::string & attrs = "") {
+    std::string node;
+    for (const auto & input : inputs) {
+        node += BytesField(1, input);
+    }
+    return BytesField(1, node + BytesField(2, output) + BytesField(3, name) + BytesField(4, op) +
+                             attrs);
+}
+
+// int8 initializer filled with a ramp
+static std::string Initializer(const std::string & name, const std::vector<int64_t> & dims) {
+    std::string tensor;
+    size_t count = 1;
+    for (int64_t dim : dims) {
+        tensor += IntField(1, dim);
+        count *= static_cast<size_t>(dim);
+    }
+    std::string raw;
+    for (size_t i = 0; i < count; ++i) {
+        raw.push_back(static_cast<char>(i % 7));
+    }
+    tensor += IntField(2, 3) + BytesField(8, name) + BytesField(9, raw);
+    return BytesField(5, tensor);
+}
+
+// Graph input with a symbolic batch dimension
+static std::string Input(const std::string & name, const std::vector<int64_t> & dims) {
+    std::string shape = BytesField(1, BytesField(2, "N"));
+    for (int64_t dim : dims) {
+        shape += BytesField(1, IntField(1, dim));
+    }
+    std::string type = BytesField(1, IntField(1, 3) + BytesField(2, shape));
+    return BytesField(11, BytesField(1, name) + BytesField(2, type));
+}
+
+// A small residual network:
+//   x -> conv1 -> relu -> conv2 -> add(relu) -> relu -> dw -> gap -> flatten -> fc -> softmax
+static std::string BuildModel() {
+    std::string graph;
+    graph += Node("Conv", "conv1", {"x", "w1"}, "c1",
+                  IntsAttr("kernel_shape", {3, 3}) + IntsAttr("pads", {1, 1, 1, 1}));
+    graph += Node("Relu", "relu1", {"c1"}, "r1");
+    graph += Node("Conv", "conv2", {"r1", "w2"}, "c2",
+                  IntsAttr("kernel_shape", {3, 3}) + IntsAttr("pads", {1, 1, 1, 1}));
+    graph += Node("Add", "add", {"c2", "r1"}, "s");
+    graph += Node("Relu", "relu2", {"s"}, "r2");
+    graph += Node("Conv", "dw", {"r2", "w3"}, "d",
+                  IntAttr("group", 8) + IntsAttr("strides", {2, 2}) +
+                      IntsAttr("pads", {1, 1, 1, 1}));
+    graph += Node("GlobalAveragePool", "gap", {"d"}, "g");
+    graph += Node("Flatten", "flatten", {"g"}, "f");
+    graph += Node("Gemm", "fc", {"f", "w4"}, "y", IntAttr("transB", 1));
+    graph += Node("Softmax", "softmax", {"y"}, "p");
+    graph += Initializer("w1", {8, 3, 3, 3});
+    graph += Initializer("w2", {8, 8, 3, 3});
+    graph += Initializer("w3", {8, 1, 3, 3});
+    graph += Initializer("w4", {10, 8});
+    graph += Input("x", {3, 16, 16});
+    return IntField(1, 8) + BytesField(7, graph);
+}
+
+// Test fixture for importer tests
+class OnnxImporterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char tmpl[] = "/tmp/onnx_importer_gtest.XXXXXX";
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        dir = tmpl;
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir);
+    }
+
+    std::string dir;
+};
+
+// Test that convolutions, fused activations, residuals and the classifier are lowered
+TEST_F(OnnxImporterTest, LowersResidualNetwork) {
+    OnnxImporter::Options options;
+    options.batch = 2;
+    OnnxImporter importer(options);
+    std::vector<Layer> layers = importer.ImportBytes(BuildModel());
+    ASSERT_EQ(layers.size(), 4u);
+
+    EXPECT_EQ(layers[0].name, "conv1");
+    EXPECT_EQ(layers[0].type, LayerType::Conv);
+    EXPECT_EQ(layers[0].batch, 2u);
+    EXPECT_EQ(layers[0].in_c, 3u);
+    EXPECT_EQ(layers[0].OutH(), 16u);
+    EXPECT_EQ(layers[0].activation, "relu");
+    EXPECT_EQ(layers[0].precision, "int8");
+    EXPECT_EQ(layers[0].GemmK(), 27u);
+
+    EXPECT_EQ(layers[1].name, "conv2");
+    EXPECT_EQ(layers[1].residual, "conv1");
+    EXPECT_EQ(layers[1].activation, "relu");
+    EXPECT_TRUE(layers[1].residual_then_act);
+
+    EXPECT_EQ(layers[2].type, LayerType::DepthwiseConv);
+    EXPECT_EQ(layers[2].groups, 8u);
+    EXPECT_EQ(layers[2].OutH(), 8u);
+    EXPECT_EQ(layers[2].GemmCount(), 8u);
+    EXPECT_EQ(layers[2].GemmK(), 9u);
+
+    EXPECT_EQ(layers[3].type, LayerType::Gemm);
+    EXPECT_EQ(layers[3].m, 2u);
+    EXPECT_EQ(layers[3].k, 8u);
+    EXPECT_EQ(layers[3].n, 10u);
+
+    // Softmax has no lowering and is reported
+    ASSERT_EQ(importer.Warnings().size(), 1u);
+    EXPECT_NE(importer.Warnings()[0].find("Softmax"), std::string::npos);
+}
+
+// Test that the text form of a layer list reads back unchanged
+TEST_F(OnnxImporterTest, LayerListRoundTrip) {
+    std::vector<Layer> layers = OnnxImporter().ImportBytes(BuildModel());
+    std::stringstream text;
+    LayerList::Write(text, layers);
+    std::vector<Layer> loaded = LayerList::Read(text);
+
+    ASSERT_EQ(loaded.size(), layers.size());
+    for (size_t i = 0; i < layers.size(); ++i) {
+        EXPECT_EQ(loaded[i].name, layers[i].name);
+        EXPECT_EQ(loaded[i].type, layers[i].type);
+        EXPECT_EQ(loaded[i].Macs(), layers[i].Macs());
+        EXPECT_EQ(loaded[i].activation, layers[i].activation);
+        EXPECT_EQ(loaded[i].residual, layers[i].residual);
+        EXPECT_EQ(loaded[i].residual_then_act, layers[i].residual_then_act);
+    }
+
+    std::stringstream bad("conv1 conv in=1x3x8 out=8x8x8\n");
+    EXPECT_THROW(LayerList::Read(bad), std::runtime_error);
+}
+
+// Test that extracted weights map back with their shape and contents
+TEST_F(OnnxImporterTest, ExtractsWeights) {
+    OnnxImporter::Options options;
+    options.weights_dir = dir + "/weights";
+    std::vector<Layer> layers = OnnxImporter(options).ImportBytes(BuildModel());
+    ASSERT_EQ(layers.size(), 4u);
+
+    ASSERT_FALSE(layers[1].weights.empty());
+    MappedTensor tensor(layers[1].weights);
+    EXPECT_EQ(tensor.Type(), static_cast<uint32_t>(TensorType::Int8));
+    EXPECT_EQ(tensor.Dims(), (std::vector<uint64_t>{8, 8, 3, 3}));
+    ASSERT_EQ(tensor.Bytes(), 8u * 8 * 3 * 3);
+    const int8_t* data = static_cast<const int8_t*>(tensor.Data());
+    for (size_t i = 0; i < tensor.Bytes(); ++i) {
+        ASSERT_EQ(data[i], static_cast<int8_t>(i % 7));
+    }
+
+    EXPECT_THROW(MappedTensor(dir + "/missing.bin"), std::runtime_error);
+}
+
+// Fields with the wrong wire type are rejected instead of being read as another type
+TEST_F(OnnxImporterTest, RejectsWrongWireTypes) {
+    OnnxImporter::Options options;
+
+    // The same attribute with the float encoded as fixed32 is accepted
+    float alpha = 0.5f;
+    std::string fixed(4, '\0');
+    std::memcpy(&fixed[0], &alpha, sizeof(alpha));
+    std::string floatAttr = BytesField(5, BytesField(1, "alpha") + Varint((2 << 3) | 5) + fixed);
+    std::string graph = Node("Relu", "relu", {"x"}, "y", floatAttr) + Input("x", {3, 4, 4});
+    EXPECT_NO_THROW(OnnxImporter(options).ImportBytes(IntField(1, 8) + BytesField(7, graph)));
+
+    // A float attribute encoded as a varint, and an attribute name encoded as a varint
+    std::string floatAsInt = BytesField(5, BytesField(1, "alpha") + IntField(2, 1));
+    std::string nameAsInt = BytesField(5, IntField(1, 7) + IntField(3, 1));
+    for (const std::string & attr : {floatAsInt, nameAsInt}) {
+        graph = Node("Relu", "relu", {"x"}, "y", attr) + Input("x", {3, 4, 4});
+        EXPECT_THROW(OnnxImporter(options).ImportBytes(IntField(1, 8) + BytesField(7, graph)),
+                     std::runtime_error);
+    }
+
+    // A truncated model
+    std::string model = BuildModel();
+    EXPECT_THROW(OnnxImporter(options).ImportBytes(model.substr(0, model.size() / 2)),
+                 std::runtime_error);
+}
+
+} // namespace test
+} // namespace gemmini
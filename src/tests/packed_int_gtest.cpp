@@ -0,0 +1,51 @@
+// packed_int_gtest.cpp - Google Test framework tests for packed int4 weights and int8 activations
+#include <gtest/gtest.h>
+
+#include "execute/packed_int.hpp"
+#include "gemmini/common.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Test that values saturate to their width and nibbles round-trip with their sign
+TEST(PackedIntTest, PackUnpack) {
+    EXPECT_EQ(SaturateInt(100, 4), 7);
+    EXPECT_EQ(SaturateInt(-100, 4), -8);
+    EXPECT_EQ(SaturateInt(-200, 8), -128);
+    EXPECT_EQ(SaturateInt(5, 8), 5);
+
+    int16_t weights = PackInt4(-3, 7);
+    EXPECT_EQ(weights & ~0xFF, 0);  // Two weights take one byte
+    EXPECT_EQ(UnpackInt4(weights, 0), -3);
+    EXPECT_EQ(UnpackInt4(weights, 1), 7);
+    EXPECT_EQ(UnpackInt4(PackInt4(20, -20), 0), 7);
+    EXPECT_EQ(UnpackInt4(PackInt4(20, -20), 1), -8);
+
+    int16_t acts = PackInt8(-128, 127);
+    EXPECT_EQ(UnpackInt8(acts, 0), -128);
+    EXPECT_EQ(UnpackInt8(acts, 1), 127);
+}
+
+// Test that a PE with int4 weights MACs one nibble per lane, and that 16-bit weights
+// multiply as before
+TEST(PackedIntTest, PackedProduct) {
+    int16_t weights = PackInt4(-3, 7);
+    int16_t acts = PackInt8(10, -4);
+    EXPECT_EQ(PackedProduct(weights, acts, 4, 1), -30);
+    EXPECT_EQ(PackedProduct(weights, acts, 4, 2), -30 - 28);
+    EXPECT_EQ(PackedProduct(300, -7, 16, 2), -2100);
+
+    EXPECT_EQ(PackedMacs(4, 2), 2u);
+    EXPECT_EQ(PackedMacs(4, 8), 2u);
+    EXPECT_EQ(PackedMacs(4, 0), 1u);
+    EXPECT_EQ(PackedMacs(16, 2), 1u);
+}
+
+} // namespace test
+} // namespace gemmini
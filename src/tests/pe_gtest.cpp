@@ -277,5 +277,45 @@ TEST_F(PEUnitTest, ConcurrentInputs) {
     EXPECT_EQ(out_psum, 17);
 }
 
+// Test that the array's hot-state table packs PEs densely and keeps their slots apart
+TEST(PEStateTableTest, DenseLayout) {
+    PEStateTable table(4, 8);
+    ASSERT_EQ(table.Size(), 32u);
+
+    // Row-major, two PEs per 64-byte cache line, no PE straddling a line
+    auto base = reinterpret_cast<uintptr_t>(table.Slot(0, 0));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(table.Slot(0, 1)) - base, 32u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(table.Slot(1, 0)) - base, 8u * 32u);
+    EXPECT_EQ(base % alignof(PEHotState), 0u);
+
+    table.Slot(2, 3)->weight = 7;
+    table.Slot(2, 3)->input.act_valid = true;
+    EXPECT_EQ(table.At(2, 3).weight, 7);
+    EXPECT_TRUE(table.At(2, 3).input.act_valid);
+    EXPECT_EQ(table.At(2, 4).weight, 0);
+    EXPECT_FALSE(table.At(2, 2).input.act_valid);
+}
+
+// Test that stepping the table counts down busy PEs and reports each finished MAC once
+TEST(PEStateTableTest, StepReleasesFinishedMacs) {
+    PEStateTable table(2, 2);
+    table.Slot(0, 1)->busy = true;
+    table.Slot(0, 1)->cycle_counter = 1;
+    table.Slot(1, 0)->busy = true;
+    table.Slot(1, 0)->cycle_counter = 2;
+
+    std::vector<size_t> done;
+    auto record = [&done](size_t index) { done.push_back(index); };
+    table.Step(record);
+    EXPECT_EQ(done, (std::vector<size_t>{1}));
+    EXPECT_FALSE(table.At(0, 1).busy);
+    EXPECT_TRUE(table.At(1, 0).busy);
+
+    table.Step(record);
+    table.Step(record);
+    EXPECT_EQ(done, (std::vector<size_t>{1, 2}));
+    EXPECT_FALSE(table.At(1, 0).busy);
+}
+
 } // namespace test
 } // namespace gemmini 
\ No newline at end of file
@@ -0,0 +1,125 @@
+// profile_bench.cpp - Times the weight-stationary mesh step in a generic or profile build
+//
+// The same source is built as profile_bench (generic) and profile_bench_<profile> with the
+// profile's GEMMINI_PROFILE_* definitions, so the two can be compared on one workload:
+//
+//   profile_bench [M K N [rows cols [reps]]]
+//
+// Each mesh cycle updates every PE's hot state the way a PE does in the simulator: latch the
+// west activation and north partial sum, MAC with the stationary weight and count down the
+// compute cycles. Only the mesh step is timed; ports, events and the SPARTA scheduler are not.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "execute/packed_int.hpp"
+#include "execute/pe_state.hpp"
+#include "utils/profile.hpp"
+
+using namespace gemmini;
+
+namespace {
+
+// Mesh parameters held like the SystolicArray holds them
+struct Mesh {
+    ProfileParam<Profile::kRows> rows;
+    ProfileParam<Profile::kCols> cols;
+    ProfileParam<Profile::kComputeCycles> computeCycles;
+    ProfileParam<Profile::kWeightWidth> weightWidth;
+    PEStateTable table;
+
+    Mesh(uint32_t r, uint32_t c)
+        : rows(r, "rows"), cols(c, "cols"), computeCycles(1, "compute_cycles"),
+          weightWidth(16, "weight_width"), table(rows, cols) {}
+
+    // One mesh cycle of an mxk * kxn tile: activation a[t - r][r] enters row r at cycle t.
+    // PEs are updated from the bottom right so each reads its neighbours' previous outputs.
+    uint64_t Step(uint64_t t, uint32_t m, const std::vector<int16_t> & a, uint32_t k) {
+        uint64_t sum = 0;
+        for (uint32_t r = rows; r-- > 0;) {
+            for (uint32_t c = cols; c-- > 0;) {
+                PEHotState & pe = *table.Slot(r, c);
+                StepCompute(pe);
+
+                bool valid;
+                int16_t act;
+                if (c == 0) {
+                    valid = t >= r && t - r < m && r < k;
+                    act = valid ? a[(t - r) * k + r] : 0;
+                } else {
+                    const PEOutput & west = table.At(r, c - 1).output;
+                    valid = west.act_valid;
+                    act = west.act;
+                }
+                int32_t psum = r == 0 ? 0 : table.At(r - 1, c).output.psum;
+
+                pe.output.act_valid = valid;
+                pe.output.psum_valid = valid;
+                if (!valid) {
+                    continue;
+                }
+                pe.partial_sum = psum + PackedProduct(pe.weight, act, weightWidth, 1);
+                pe.output.psum = pe.partial_sum;
+                pe.output.act = act;
+                if (computeCycles > 0) {
+                    pe.busy = true;
+                    pe.cycle_counter = computeCycles;
+                }
+                if (r + 1 == rows) {
+                    sum += static_cast<uint32_t>(pe.output.psum);
+                }
+            }
+        }
+        return sum;
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t m = argc > 1 ? std::atoi(argv[1]) : 256;
+    uint32_t k = argc > 2 ? std::atoi(argv[2]) : 256;
+    uint32_t n = argc > 3 ? std::atoi(argv[3]) : 256;
+    uint32_t rows = argc > 4 ? std::atoi(argv[4]) : 4;
+    uint32_t cols = argc > 5 ? std::atoi(argv[5]) : 4;
+    uint32_t reps = argc > 6 ? std::atoi(argv[6]) : 5;
+
+    Mesh mesh(rows, cols);
+    std::vector<int16_t> a(size_t(m) * mesh.rows);
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<int16_t>(i % 13 - 6);
+    }
+
+    // One pass per (K tile, N tile), each with freshly preloaded weights
+    uint32_t tiles = ((k + mesh.rows - 1) / mesh.rows) * ((n + mesh.cols - 1) / mesh.cols);
+    uint64_t cyclesPerTile = m + mesh.rows + mesh.cols;
+    double best = 0.0;
+    uint64_t checksum = 0;
+    for (uint32_t rep = 0; rep < reps; ++rep) {
+        checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t tile = 0; tile < tiles; ++tile) {
+            for (uint32_t r = 0; r < mesh.rows; ++r) {
+                for (uint32_t c = 0; c < mesh.cols; ++c) {
+                    mesh.table.Slot(r, c)->weight = static_cast<int16_t>((tile + r * c) % 7);
+                }
+            }
+            for (uint64_t t = 0; t < cyclesPerTile; ++t) {
+                checksum += mesh.Step(t, m, a, mesh.rows);
+            }
+        }
+        double ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start).count();
+        best = rep == 0 ? ms : std::min(best, ms);
+    }
+
+    uint64_t updates = uint64_t(tiles) * cyclesPerTile * mesh.rows * mesh.cols;
+    std::cout << "profile=" << Profile::kName << " mesh=" << mesh.rows << "x" << mesh.cols
+              << " gemm=" << m << "x" << k << "x" << n << " best_ms=" << best
+              << " ns_per_pe_cycle=" << best * 1e6 / updates << " checksum=" << checksum
+              << std::endl;
+    return 0;
+}
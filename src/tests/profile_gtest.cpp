@@ -0,0 +1,45 @@
+// profile_gtest.cpp - Google Test framework tests for build profile parameters
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "utils/profile.hpp"
+#include "gemmini/common.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Test that an unfixed parameter keeps its runtime value
+TEST(ProfileTest, RuntimeParam) {
+    ProfileParam<kProfileNotFixed> rows(8, "rows");
+    EXPECT_EQ(rows.Get(), 8u);
+    EXPECT_EQ(rows * 2, 16u);
+}
+
+// Test that a fixed parameter reads as the profile constant whatever it was set to
+TEST(ProfileTest, FixedParam) {
+    ProfileParam<4> matching(4, "rows");
+    EXPECT_EQ(matching.Get(), 4u);
+
+    testing::internal::CaptureStderr();
+    ProfileParam<4> conflicting(16, "rows");
+    std::string warning = testing::internal::GetCapturedStderr();
+    EXPECT_EQ(conflicting.Get(), 4u);
+    EXPECT_NE(warning.find("rows is fixed to 4"), std::string::npos);
+}
+
+// Test that the test build is the generic profile
+TEST(ProfileTest, GenericBuild) {
+    EXPECT_FALSE(Profile::kSpecialized);
+    EXPECT_EQ(Profile::kRows, kProfileNotFixed);
+    EXPECT_STREQ(Profile::kName, "generic");
+}
+
+} // namespace test
+} // namespace gemmini
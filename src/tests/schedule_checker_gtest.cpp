@@ -0,0 +1,213 @@
+// schedule_checker_gtest.cpp - Google Test framework tests for the static schedule checker
+#include <gtest/gtest.h>
+#include <memory>
+
+#include "execute/schedule_checker.hpp"
+#include "execute/tile_schedule.hpp"
+#include "gemmini/common.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Test fixture for schedule checker tests
+class ScheduleCheckerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        schedule = TileSchedule::Plan(16, 32, 16, 4, 4);
+    }
+
+    void TearDown() override {
+        // No cleanup needed
+    }
+
+    // Build a schedule from a subset of the planned operations
+    TileSchedulePtr Without(TileOpType type, size_t nth) {
+        auto copy = std::make_shared<TileSchedule>(schedule->M(), schedule->K(), schedule->N(),
+                                                   schedule->TileRows(), schedule->TileCols());
+        size_t seen = 0;
+        for (const auto & op : schedule->Ops()) {
+            if (op.type == type && seen++ == nth) {
+                continue;
+            }
+            copy->Append(op);
+        }
+        return copy;
+    }
+
+    // Common test resources
+    MemoryConfig config;
+    TileSchedulePtr schedule;
+};
+
+//=============================================================================
+// SECTION 1: Validity Tests
+//=============================================================================
+
+// Planned schedules pass with the default memory configuration
+TEST_F(ScheduleCheckerTest, PlannedScheduleIsValid) {
+    ScheduleReport report = ScheduleChecker(config).Check(*schedule);
+
+    EXPECT_TRUE(report.ok) << report;
+    EXPECT_GT(report.estimated_cycles, 0u);
+    EXPECT_GT(report.peak_scratchpad_bytes, 0u);
+    EXPECT_EQ(report.peak_accumulator_bytes, 4u * 4u * 4u);
+}
+
+// A compute whose A rows were never loaded is rejected
+TEST_F(ScheduleCheckerTest, MissingLoadRejected) {
+    ScheduleReport report = ScheduleChecker(config).Check(*Without(TileOpType::Load, 0));
+
+    EXPECT_FALSE(report.ok);
+    EXPECT_FALSE(report.errors.empty());
+}
+
+// A block that is never stored is rejected
+TEST_F(ScheduleCheckerTest, MissingStoreRejected) {
+    ScheduleReport report = ScheduleChecker(config).Check(*Without(TileOpType::Store, 3));
+
+    EXPECT_FALSE(report.ok);
+}
+
+// Storing a block before all of its K tiles are summed is rejected
+TEST_F(ScheduleCheckerTest, MissingKTileRejected) {
+    ScheduleReport report = ScheduleChecker(config).Check(*Without(TileOpType::Compute, 7));
+
+    EXPECT_FALSE(report.ok);
+    EXPECT_FALSE(report.errors.empty());
+}
+
+//=============================================================================
+// SECTION 2: Capacity and Timing Tests
+//=============================================================================
+
+// Scratchpad and accumulator overflows are detected
+TEST_F(ScheduleCheckerTest, CapacityOverflow) {
+    config.scratchpad_bytes = 256;
+    EXPECT_FALSE(ScheduleChecker(config).Check(*schedule).ok);
+
+    config = MemoryConfig();
+    config.accumulator_bytes = 32;
+    EXPECT_FALSE(ScheduleChecker(config).Check(*schedule).ok);
+}
+
+// Loads hoisted above a running compute conflict only when they share its bank
+TEST_F(ScheduleCheckerTest, SingleBankConflicts) {
+    // Move each B load ahead of the previous tile's store so it overlaps the compute
+    auto hoisted = std::make_shared<TileSchedule>(schedule->M(), schedule->K(), schedule->N(),
+                                                  schedule->TileRows(), schedule->TileCols());
+    TileOp pendingStore;
+    bool hasPendingStore = false;
+    for (const auto & op : schedule->Ops()) {
+        if (op.type == TileOpType::Store) {
+            pendingStore = op;
+            hasPendingStore = true;
+            continue;
+        }
+        hoisted->Append(op);
+        if (hasPendingStore && op.type == TileOpType::Load) {
+            hoisted->Append(pendingStore);
+            hasPendingStore = false;
+        }
+    }
+    hoisted->Append(pendingStore);
+
+    ScheduleReport banked = ScheduleChecker(config).Check(*hoisted);
+    config.scratchpad_banks = 1;
+    ScheduleReport single = ScheduleChecker(config).Check(*hoisted);
+
+    EXPECT_TRUE(banked.ok) << banked;
+    EXPECT_TRUE(single.ok) << single;
+    EXPECT_EQ(banked.bank_conflicts, 0u);
+    EXPECT_GT(single.bank_conflicts, 0u);
+    EXPECT_GE(single.estimated_cycles, banked.estimated_cycles);
+}
+
+// Every K tile costs a compute pass and a B tile load
+TEST_F(ScheduleCheckerTest, EstimateGrowsWithK) {
+    TileSchedulePtr oneTile = TileSchedule::Plan(16, 4, 16, 4, 4);
+    ScheduleReport shallow = ScheduleChecker(config).Check(*oneTile);
+    ScheduleReport deep = ScheduleChecker(config).Check(*schedule);
+
+    EXPECT_TRUE(deep.ok) << deep;
+    ASSERT_EQ(schedule->KBlocks(), 8u);
+
+    // 16 result blocks of 8 passes, each at least a 4-row stream plus fill and drain
+    EXPECT_GE(deep.estimated_cycles, 16u * 8u * (4u + 4u + 4u - 1u));
+    EXPECT_GT(deep.estimated_cycles, 2 * shallow.estimated_cycles);
+}
+
+// Lower DMA bandwidth means more dependency stalls
+TEST_F(ScheduleCheckerTest, BandwidthStalls) {
+    ScheduleReport fast = ScheduleChecker(config).Check(*schedule);
+    config.dma_bytes_per_cycle = 1;
+    ScheduleReport slow = ScheduleChecker(config).Check(*schedule);
+
+    EXPECT_GT(slow.dependency_stall_cycles, fast.dependency_stall_cycles);
+    EXPECT_GT(slow.estimated_cycles, fast.estimated_cycles);
+}
+
+// Slow command issue dominates a small GEMM, and the fence adds to the end
+TEST_F(ScheduleCheckerTest, HostIssueOverhead) {
+    ScheduleReport ideal = ScheduleChecker(config).Check(*schedule);
+    EXPECT_EQ(ideal.host_stall_cycles, 0u);
+
+    HostConfig host;
+    host.issue_cycles = 100;
+    host.fence_cycles = 500;
+    ScheduleReport slow = ScheduleChecker(config, host).Check(*schedule);
+    EXPECT_TRUE(slow.ok) << slow;
+    EXPECT_GT(slow.host_stall_cycles, 0u);
+    EXPECT_GE(slow.estimated_cycles, schedule->Size() * 100 + 500);
+    EXPECT_FALSE(slow.warnings.empty());
+}
+
+// MX operands move fewer bytes per load, so a DMA-bound schedule finishes sooner
+TEST_F(ScheduleCheckerTest, MxOperandsCutLoadTraffic) {
+    config.dma_bytes_per_cycle = 1;
+    ScheduleReport wide = ScheduleChecker(config).Check(*schedule);
+    config.operand_format.element = MxElement::Fp4E2M1;
+    ScheduleReport packed = ScheduleChecker(config).Check(*schedule);
+
+    EXPECT_TRUE(packed.ok) << packed;
+    EXPECT_LT(packed.peak_scratchpad_bytes, wide.peak_scratchpad_bytes);
+    EXPECT_LT(packed.estimated_cycles, wide.estimated_cycles);
+}
+
+// A K tile taller than the MX block streams its rows once per block it spans
+TEST_F(ScheduleCheckerTest, MxBlocksAddComputePasses) {
+    TileSchedulePtr tall = TileSchedule::Plan(16, 64, 16, 4, 4, 32);
+    config.operand_format.element = MxElement::Fp8E4M3;
+    config.operand_format.block_size = 32;
+    ScheduleReport onePass = ScheduleChecker(config).Check(*tall);
+    config.operand_format.block_size = 8;
+    ScheduleReport fourPasses = ScheduleChecker(config).Check(*tall);
+
+    EXPECT_TRUE(fourPasses.ok) << fourPasses;
+    ASSERT_EQ(tall->KBlocks(), 2u);
+
+    // 16 result blocks of 2 K tiles, each 3 more 4-row passes than with one block per tile
+    EXPECT_GE(fourPasses.estimated_cycles, onePass.estimated_cycles + 16u * 2u * 3u * 4u);
+}
+
+// int4 weights take a quarter of the int16 weight bytes and int8 activations half
+TEST_F(ScheduleCheckerTest, Int4WeightsCutLoadTraffic) {
+    config.dma_bytes_per_cycle = 1;
+    ScheduleReport wide = ScheduleChecker(config).Check(*schedule);
+    config.int4_weights = true;
+    ScheduleReport packed = ScheduleChecker(config).Check(*schedule);
+
+    EXPECT_TRUE(packed.ok) << packed;
+    EXPECT_EQ(config.WeightBytes(32), 16u);
+    EXPECT_EQ(config.ActivationBytes(32), 32u);
+    EXPECT_LT(packed.peak_scratchpad_bytes, wide.peak_scratchpad_bytes);
+    EXPECT_LT(packed.estimated_cycles, wide.estimated_cycles);
+}
+
+} // namespace test
+} // namespace gemmini
@@ -0,0 +1,118 @@
+// sparse_memory_gtest.cpp - Google Test framework tests for the sparse DRAM backing store
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "utils/memory_footprint.hpp"
+#include "utils/sparse_memory.hpp"
+#include "gemmini/common.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Test that untouched memory reads as zero and writes allocate only the pages they touch
+TEST(SparseMemoryTest, AllocatesOnWrite) {
+    SparseMemory memory;
+    std::vector<uint8_t> data(10000);
+    std::iota(data.begin(), data.end(), 0);
+
+    // Far apart addresses in a 1 TiB space, the second write straddles four pages
+    memory.Write(0, data.data(), 16);
+    memory.Write((1ull << 40) - 5000, data.data(), data.size());
+    EXPECT_EQ(memory.NumPages(), 1u + 4u);
+
+    std::vector<uint8_t> back(data.size());
+    memory.Read((1ull << 40) - 5000, back.data(), back.size());
+    EXPECT_EQ(back, data);
+
+    // Reads of untouched pages and zero writes do not allocate
+    std::vector<uint8_t> zeros(8192, 0);
+    memory.Read(1ull << 30, back.data(), 8192);
+    EXPECT_TRUE(std::all_of(back.begin(), back.begin() + 8192, [](uint8_t b) { return b == 0; }));
+    memory.Write(1ull << 32, zeros.data(), zeros.size());
+    EXPECT_EQ(memory.NumPages(), 5u);
+    EXPECT_EQ(memory.ResidentBytes(), 5u * SparseMemory::kSmallPageBytes);
+}
+
+// Test that host memory grows with the pages touched, not the address range
+TEST(SparseMemoryTest, RssTracksTouchedPages) {
+    uint64_t rssBefore = MemoryFootprint::RssBytes();
+    SparseMemory memory;
+    std::vector<uint8_t> data(64, 0xab);
+    for (uint64_t i = 0; i < 1024; ++i) {
+        memory.Write(i << 30, data.data(), data.size());
+    }
+    EXPECT_EQ(memory.NumPages(), 1024u);
+    if (rssBefore > 0) {
+        EXPECT_LT(MemoryFootprint::RssBytes() - rssBefore, 32ull << 20);
+    }
+}
+
+// Test that huge pages hold data across what would be many small pages
+TEST(SparseMemoryTest, HugePages) {
+    SparseMemory memory(SparseMemory::kHugePageBytes);
+    std::vector<uint8_t> data(1 << 20, 0xab);
+    memory.Write(5ull << 30, data.data(), data.size());
+    EXPECT_EQ(memory.NumPages(), 1u);
+    EXPECT_EQ(memory.PageBytes(), SparseMemory::kHugePageBytes);
+
+    uint8_t byte = 0;
+    memory.Read((5ull << 30) + data.size() - 1, &byte, 1);
+    EXPECT_EQ(byte, 0xab);
+    memory.Read((5ull << 30) + data.size(), &byte, 1);
+    EXPECT_EQ(byte, 0);
+}
+
+// Test that file-backed ranges read the file, keep writes private and coexist with pages
+TEST(SparseMemoryTest, MapsFiles) {
+    char tmpl[] = "/tmp/sparse_memory_gtest.XXXXXX";
+    int fd = mkstemp(tmpl);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    std::string path = tmpl;
+    std::vector<uint8_t> contents(6000);
+    std::iota(contents.begin(), contents.end(), 1);
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(contents.data()), contents.size());
+    }
+
+    SparseMemory memory;
+    memory.MapFile(0x10000, path, 64);
+    EXPECT_EQ(memory.MappedBytes(), contents.size() - 64);
+
+    // A read spanning the end of the mapping continues into normal pages
+    std::vector<uint8_t> back(contents.size());
+    memory.Read(0x10000, back.data(), back.size());
+    for (size_t i = 0; i < contents.size() - 64; ++i) {
+        ASSERT_EQ(back[i], contents[i + 64]);
+    }
+    EXPECT_EQ(back.back(), 0);
+
+    uint8_t value = 0x5a;
+    memory.Write(0x10000 + 100, &value, 1);
+    memory.Read(0x10000 + 100, &value, 1);
+    EXPECT_EQ(value, 0x5a);
+    EXPECT_EQ(memory.NumPages(), 0u);
+    std::ifstream file(path, std::ios::binary);
+    file.seekg(164);
+    EXPECT_EQ(file.get(), contents[164]);
+
+    EXPECT_THROW(memory.MapFile(0x10100, path), std::runtime_error);
+    unlink(path.c_str());
+}
+
+} // namespace test
+} // namespace gemmini
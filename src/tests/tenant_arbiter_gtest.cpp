@@ -0,0 +1,62 @@
+// tenant_arbiter_gtest.cpp - Google Test framework tests for tenant arbitration
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "execute/tenant_arbiter.hpp"
+#include "gemmini/common.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Count grants per tenant over a number of rounds with every tenant ready
+static std::vector<int> CountGrants(TenantArbiter & arbiter, int rounds) {
+    std::vector<int> grants(arbiter.NumTenants(), 0);
+    std::vector<bool> ready(arbiter.NumTenants(), true);
+    for (int i = 0; i < rounds; ++i) {
+        grants[arbiter.Grant(ready)]++;
+    }
+    return grants;
+}
+
+// A higher-priority tenant always wins while it has work
+TEST(TenantArbiterTest, StrictPriority) {
+    TenantArbiter arbiter({{1, 100}, {0, 1}});
+
+    std::vector<int> grants = CountGrants(arbiter, 20);
+    EXPECT_EQ(grants[0], 0);
+    EXPECT_EQ(grants[1], 20);
+
+    EXPECT_EQ(arbiter.Grant({true, false}), 0);
+    EXPECT_EQ(arbiter.Grant({false, false}), -1);
+}
+
+// Equal-priority tenants share grants in proportion to their weights
+TEST(TenantArbiterTest, WeightedFairShare) {
+    TenantArbiter arbiter({{0, 3}, {0, 1}});
+
+    std::vector<int> grants = CountGrants(arbiter, 400);
+    EXPECT_EQ(grants[0], 300);
+    EXPECT_EQ(grants[1], 100);
+}
+
+// A tenant that was idle does not get a burst of grants for the time it was away
+TEST(TenantArbiterTest, IdleTenantBanksNoCredit) {
+    TenantArbiter arbiter({{0, 1}, {0, 1}});
+
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(arbiter.Grant({true, false}), 0);
+    }
+
+    std::vector<int> grants = CountGrants(arbiter, 10);
+    EXPECT_EQ(grants[0], 5);
+    EXPECT_EQ(grants[1], 5);
+}
+
+} // namespace test
+} // namespace gemmini
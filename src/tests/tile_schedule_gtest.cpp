@@ -0,0 +1,174 @@
+// tile_schedule_gtest.cpp - Google Test framework tests for the Gemmini tile schedule IR
+#include <gtest/gtest.h>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include "execute/tile_schedule.hpp"
+#include "gemmini/common.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Test fixture for tile schedule tests
+class TileScheduleTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // 10x8 * 8x6 on a 4x4 array gives 3 row blocks, 2 column blocks and 2 K tiles
+        schedule = TileSchedule::Plan(10, 8, 6, 4, 4);
+    }
+
+    void TearDown() override {
+        // No cleanup needed
+    }
+
+    // Common test resources
+    TileSchedulePtr schedule;
+};
+
+//=============================================================================
+// SECTION 1: Planning Tests
+//=============================================================================
+
+// The planner covers every result block exactly once
+TEST_F(TileScheduleTest, PlanCoversAllBlocks) {
+    ASSERT_EQ(schedule->RowBlocks(), 3u);
+    ASSERT_EQ(schedule->ColBlocks(), 2u);
+
+    std::vector<int> stores(6, 0);
+    uint32_t loadsA = 0;
+    for (const auto & op : schedule->Ops()) {
+        if (op.type == TileOpType::Store) {
+            stores[op.row_block * 2 + op.col_block]++;
+        } else if (op.type == TileOpType::Load && op.operand == TileOperand::A) {
+            loadsA++;
+        }
+    }
+    for (int count : stores) {
+        EXPECT_EQ(count, 1);
+    }
+    EXPECT_EQ(loadsA, 3u) << "Each A row block should be loaded once";
+    EXPECT_EQ(schedule->Size(), 3u + 6u * (2u * 3u + 1u));
+}
+
+// Every result block loads, preloads and computes its K tiles in order before its store
+TEST_F(TileScheduleTest, PlanSplitsK) {
+    ASSERT_EQ(schedule->KBlocks(), 2u);
+    EXPECT_EQ(schedule->KTileRows(1), 4u);
+
+    uint32_t nextK = 0;
+    for (const auto & op : schedule->Ops()) {
+        if (op.type == TileOpType::Compute) {
+            EXPECT_EQ(op.k_block, nextK);
+            nextK++;
+        } else if (op.type == TileOpType::Store) {
+            EXPECT_EQ(nextK, schedule->KBlocks());
+            nextK = 0;
+        }
+    }
+
+    // A K tile of 8 covers 10x12 * 12x6 in two tiles, the last one short
+    TileSchedulePtr deep = TileSchedule::Plan(10, 12, 6, 4, 4, 8);
+    EXPECT_EQ(deep->KBlocks(), 2u);
+    EXPECT_EQ(deep->KTileRows(1), 4u);
+    EXPECT_TRUE(deep->Matches(10, 12, 6, 4, 4, 8));
+    EXPECT_FALSE(deep->Matches(10, 12, 6, 4, 4));
+}
+
+// Buffers alternate so consecutive tiles never share a B or accumulator buffer
+TEST_F(TileScheduleTest, PlanDoubleBuffers) {
+    EXPECT_EQ(schedule->NumBuffers(), 4u);
+    EXPECT_EQ(schedule->NumAccBuffers(), 2u);
+
+    int lastAcc = -1;
+    for (const auto & op : schedule->Ops()) {
+        if (op.type == TileOpType::Compute && op.k_block == 0) {
+            EXPECT_NE(static_cast<int>(op.acc_buffer), lastAcc);
+            lastAcc = op.acc_buffer;
+        }
+    }
+}
+
+// A schedule preempted mid-block reloads its A row block and any B tile not yet preloaded
+TEST_F(TileScheduleTest, LiveLoadsAfterPreemption) {
+    EXPECT_TRUE(schedule->LiveLoads(0).empty()) << "Nothing is loaded before the first op";
+
+    size_t preload = 0;
+    for (size_t i = 0; i < schedule->Size(); ++i) {
+        const TileOp & op = (*schedule)[i];
+        if (op.type == TileOpType::Preload && op.k_block == 1) {
+            preload = i;
+            break;
+        }
+    }
+    ASSERT_GT(preload, 0u);
+
+    // Before the second preload its B tile and the A row block are still needed
+    std::vector<TileOp> live = schedule->LiveLoads(preload);
+    ASSERT_EQ(live.size(), 2u);
+    EXPECT_EQ(live[0].operand, TileOperand::B);
+    EXPECT_EQ(live[0].k_block, 1u);
+    EXPECT_EQ(live[1].operand, TileOperand::A);
+    EXPECT_EQ(live[1].row_block, 0u);
+
+    // Once preloaded only the A row block is read again
+    live = schedule->LiveLoads(preload + 1);
+    ASSERT_EQ(live.size(), 1u);
+    EXPECT_EQ(live[0].operand, TileOperand::A);
+    EXPECT_TRUE(schedule->LiveLoads(schedule->Size()).empty());
+}
+
+//=============================================================================
+// SECTION 2: Serialization Tests
+//=============================================================================
+
+// Writing and reading a schedule gives back the same operations
+TEST_F(TileScheduleTest, RoundTrip) {
+    std::stringstream ss;
+    schedule->Write(ss);
+    EXPECT_EQ(ss.str().size(), 36u + schedule->Size() * 16u);
+
+    TileSchedulePtr copy = TileSchedule::Read(ss);
+    ASSERT_TRUE(copy->Matches(10, 8, 6, 4, 4));
+    ASSERT_EQ(copy->Size(), schedule->Size());
+    for (size_t i = 0; i < copy->Size(); ++i) {
+        EXPECT_TRUE((*copy)[i] == (*schedule)[i]) << "Operation " << i << " differs";
+    }
+}
+
+// Version 1 files, written before K tiles, read as a single K tile of tile_rows
+TEST_F(TileScheduleTest, ReadsVersion1) {
+    auto u32 = [](uint32_t value) {
+        return std::string{static_cast<char>(value), static_cast<char>(value >> 8),
+                           static_cast<char>(value >> 16), static_cast<char>(value >> 24)};
+    };
+    std::string bytes = std::string("GTSC") + u32(1) + u32(4) + u32(4) + u32(4) + u32(4) +
+                        u32(4) + u32(1) + std::string{0, 0, 0, 0} + u32(0) + u32(0);
+    std::stringstream ss(bytes);
+
+    TileSchedulePtr copy = TileSchedule::Read(ss);
+    ASSERT_TRUE(copy->Matches(4, 4, 4, 4, 4));
+    ASSERT_EQ(copy->Size(), 1u);
+    EXPECT_EQ((*copy)[0].k_block, 0u);
+}
+
+// Malformed input is rejected
+TEST_F(TileScheduleTest, RejectsBadInput) {
+    std::stringstream bad("not a schedule");
+    EXPECT_THROW(TileSchedule::Read(bad), std::runtime_error);
+
+    std::stringstream ss;
+    schedule->Write(ss);
+    std::string truncated = ss.str().substr(0, ss.str().size() - 5);
+    std::stringstream partial(truncated);
+    EXPECT_THROW(TileSchedule::Read(partial), std::runtime_error);
+}
+
+} // namespace test
+} // namespace gemmini
@@ -0,0 +1,140 @@
+// wave_queue_gtest.cpp - Google Test framework tests for systolic array wave admission
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "execute/wave_queue.hpp"
+#include "gemmini/common.hpp"
+#include "gemmini/matrix.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+namespace {
+
+VectorPtr MakeVector(const std::vector<int16_t> & values) {
+    VectorPtr vec = std::make_shared<Vector>(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        vec->set(i, values[i]);
+    }
+    return vec;
+}
+
+MatrixPtr MakeWeights(uint32_t rows, uint32_t cols, int16_t value) {
+    MatrixPtr weights = std::make_shared<Matrix>(rows, cols);
+    for (uint32_t r = 0; r < rows; ++r) {
+        for (uint32_t c = 0; c < cols; ++c) {
+            weights->set(r, c, value);
+        }
+    }
+    return weights;
+}
+
+// Advance every wave in flight by one cycle, like the array's tick
+void Step(WaveQueue & queue) {
+    for (WaveQueue::Wave & wave : queue.Waves()) {
+        wave.cycle++;
+    }
+}
+
+} // namespace
+
+// Test that overlapping waves enter one feed (rows cycles) apart
+TEST(WaveQueueTest, AdmissionSpacing) {
+    const uint32_t rows = 4;
+    WaveQueue queue(rows, true);
+    for (int i = 0; i < 3; ++i) {
+        queue.Push(MakeVector({1, 2, 3, 4}));
+    }
+
+    std::vector<uint32_t> admitted;
+    for (uint32_t cycle = 0; cycle < 12; ++cycle) {
+        if (queue.Admit()) {
+            admitted.push_back(cycle);
+        }
+        Step(queue);
+    }
+    EXPECT_EQ(admitted, (std::vector<uint32_t>{0, rows, 2 * rows}));
+    EXPECT_EQ(queue.NumPending(), 0u);
+}
+
+// Test that without overlap a wave waits for the array to empty
+TEST(WaveQueueTest, NoOverlapWaitsForEmptyArray) {
+    WaveQueue queue(4, false);
+    queue.Push(MakeVector({1}));
+    queue.Push(MakeVector({2}));
+
+    EXPECT_TRUE(queue.Admit());
+    for (int i = 0; i < 10; ++i) {
+        Step(queue);
+        EXPECT_FALSE(queue.Admit());
+    }
+    queue.PopFront();
+    EXPECT_TRUE(queue.Admit());
+}
+
+// Test that waves complete in the order they entered
+TEST(WaveQueueTest, InOrderResults) {
+    const uint32_t rows = 2;
+    const uint32_t latency = 5;
+    WaveQueue queue(rows, true);
+    for (int16_t i = 0; i < 4; ++i) {
+        queue.Push(MakeVector({i}));
+    }
+
+    std::vector<uint64_t> tags;
+    for (uint32_t cycle = 0; cycle < 40; ++cycle) {
+        queue.Admit();
+        Step(queue);
+        while (queue.FrontDone(latency)) {
+            WaveQueue::Wave wave = queue.PopFront();
+            EXPECT_GT(wave.cycle, latency);
+            EXPECT_EQ(wave.input->get(0), static_cast<int16_t>(wave.tag));
+            tags.push_back(wave.tag);
+        }
+    }
+    EXPECT_EQ(tags, (std::vector<uint64_t>{0, 1, 2, 3}));
+}
+
+// Test that a preload only affects waves admitted after it
+TEST(WaveQueueTest, WeightTagging) {
+    WaveQueue queue(2, true);
+    queue.Preload(MakeWeights(2, 2, 1));
+    queue.Push(MakeVector({1, 1}));
+    queue.Push(MakeVector({1, 1}));
+
+    ASSERT_TRUE(queue.Admit());
+    queue.Preload(MakeWeights(2, 2, 3));
+    Step(queue);
+    Step(queue);
+    ASSERT_TRUE(queue.Admit());
+
+    WaveSumsPtr first = WaveResult(queue.Waves()[0], 2, 2, 16, 1);
+    WaveSumsPtr second = WaveResult(queue.Waves()[1], 2, 2, 16, 1);
+    EXPECT_EQ((*first)[0], 2);
+    EXPECT_EQ((*second)[0], 6);
+}
+
+// Test that results keep 32 bits and saturate instead of wrapping
+TEST(WaveQueueTest, ResultKeepsAccumulatorWidth) {
+    WaveQueue queue(2, true);
+    queue.Preload(MakeWeights(2, 2, 30000));
+    queue.Push(MakeVector({30000, 30000}));
+    ASSERT_TRUE(queue.Admit());
+    EXPECT_EQ((*WaveResult(queue.Waves()[0], 2, 2, 16, 1))[0], 1800000000);
+
+    WaveQueue full(2, true);
+    full.Preload(MakeWeights(2, 2, -32768));
+    full.Push(MakeVector({-32768, -32768}));
+    ASSERT_TRUE(full.Admit());
+    EXPECT_EQ((*WaveResult(full.Waves()[0], 2, 2, 16, 1))[1], INT32_MAX);
+}
+
+} // namespace test
+} // namespace gemmini
@@ -0,0 +1,213 @@
+// work_queue_gtest.cpp - Google Test framework tests for the shared-directory work queue
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "driver/work_queue.hpp"
+#include "gemmini/common.hpp"
+
+// Main function for Google Test
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+namespace gemmini {
+namespace test {
+
+// Stand-in for a simulation: the "checksum" identifies the job
+static BatchResult FakeRun(const BatchJob & job) {
+    BatchResult result;
+    result.name = job.name;
+    result.ticks = job.m + job.k + job.n;
+    result.checksum = uint64_t(job.m) * job.k * job.n + job.seed;
+    result.ok = true;
+    return result;
+}
+
+// Test fixture for work queue tests
+class WorkQueueTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char tmpl[] = "/tmp/work_queue_gtest.XXXXXX";
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        dir = tmpl;
+        for (uint32_t i = 0; i < 40; ++i) {
+            BatchJob job;
+            job.name = "job" + std::to_string(i);
+            job.m = 4 + i;
+            job.k = 8;
+            job.n = 4;
+            job.seed = i;
+            jobs.push_back(job);
+        }
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir);
+    }
+
+    // Common test resources
+    std::string dir;
+    std::vector<BatchJob> jobs;
+};
+
+//=============================================================================
+// SECTION 1: Claiming Tests
+//=============================================================================
+
+// A job can only be claimed once, even through separate queue objects
+TEST_F(WorkQueueTest, ClaimIsExclusive) {
+    WorkQueue first(dir);
+    WorkQueue second(dir);
+    first.Submit({jobs[0]});
+    ASSERT_EQ(first.NumPending(), 1u);
+
+    WorkQueue::Claim claim;
+    ASSERT_TRUE(first.TryClaim(claim));
+    EXPECT_EQ(claim.job.name, "job0");
+    EXPECT_EQ(claim.job.seed, 0u);
+    EXPECT_FALSE(second.TryClaim(claim));
+    EXPECT_EQ(first.NumClaimed(), 1u);
+
+    first.Complete(claim, FakeRun(claim.job));
+    EXPECT_EQ(first.NumClaimed(), 0u);
+    ASSERT_EQ(second.LoadResults().size(), 1u);
+    EXPECT_EQ(second.LoadResults()[0].checksum, FakeRun(jobs[0]).checksum);
+}
+
+// Submitting the same jobs twice keeps both submissions and both results
+TEST_F(WorkQueueTest, ResubmitKeepsBoth) {
+    WorkQueue queue(dir);
+    queue.Submit({jobs[0], jobs[1]});
+    queue.Submit({jobs[0]});
+    ASSERT_EQ(queue.NumPending(), 3u);
+
+    EXPECT_EQ(queue.Work(1, FakeRun), 3u);
+    WorkQueue::MergeSummary summary = queue.MergeResults(dir + "/results.db");
+    EXPECT_EQ(summary.merged, 3u);
+    ASSERT_EQ(summary.repeated.size(), 1u);
+    EXPECT_EQ(summary.repeated[0], "job0");
+}
+
+// Claims past their lease go back to pending
+TEST_F(WorkQueueTest, ExpiredLeaseRequeued) {
+    WorkQueue queue(dir, std::chrono::seconds(60));
+    queue.Submit({jobs[0]});
+    WorkQueue::Claim claim;
+    ASSERT_TRUE(queue.TryClaim(claim));
+    EXPECT_EQ(queue.RequeueStale(), 0u) << "A fresh claim of a live process is not stale";
+
+    auto old = std::filesystem::file_time_type::clock::now() - std::chrono::minutes(5);
+    std::filesystem::last_write_time(claim.file, old);
+    EXPECT_EQ(queue.RequeueStale(), 1u);
+    EXPECT_EQ(queue.NumPending(), 1u);
+    EXPECT_EQ(queue.NumClaimed(), 0u);
+}
+
+// A merge lists jobs that have no result yet
+TEST_F(WorkQueueTest, MergeReportsUnfinishedJobs) {
+    WorkQueue queue(dir);
+    queue.Submit({jobs[0], jobs[1], jobs[2]});
+    WorkQueue::Claim claim;
+    ASSERT_TRUE(queue.TryClaim(claim));
+    queue.Complete(claim, FakeRun(claim.job));
+    ASSERT_TRUE(queue.TryClaim(claim));
+
+    WorkQueue::MergeSummary summary = queue.MergeResults(dir + "/results.db");
+    EXPECT_EQ(summary.merged, 1u);
+    EXPECT_EQ(summary.pending.size(), 1u);
+    EXPECT_EQ(summary.claimed.size(), 1u);
+    EXPECT_TRUE(summary.stale.empty());
+}
+
+//=============================================================================
+// SECTION 2: Multi-Process Tests
+//=============================================================================
+
+// Several processes drain one queue, every job runs exactly once and merges into one table
+TEST_F(WorkQueueTest, ProcessesShareQueue) {
+    WorkQueue(dir).Submit(jobs);
+
+    std::vector<pid_t> children;
+    for (int p = 0; p < 4; ++p) {
+        pid_t pid = fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            WorkQueue(dir).Work(2, FakeRun);
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+
+    WorkQueue queue(dir);
+    EXPECT_EQ(queue.NumPending(), 0u);
+    EXPECT_EQ(queue.NumClaimed(), 0u);
+
+    std::map<std::string, BatchResult> byName;
+    for (const auto & result : queue.LoadResults()) {
+        EXPECT_TRUE(byName.emplace(result.name, result).second) << result.name << " ran twice";
+    }
+    ASSERT_EQ(byName.size(), jobs.size());
+    for (const auto & job : jobs) {
+        EXPECT_EQ(byName[job.name].checksum, FakeRun(job).checksum);
+        EXPECT_FALSE(byName[job.name].host.empty());
+    }
+
+    // Merging twice replaces rows instead of duplicating them
+    std::string dbPath = dir + "/results.db";
+    EXPECT_EQ(queue.MergeResults(dbPath).merged, jobs.size());
+    WorkQueue::MergeSummary summary = queue.MergeResults(dbPath);
+    EXPECT_EQ(summary.merged, jobs.size());
+    EXPECT_TRUE(summary.pending.empty());
+    EXPECT_TRUE(summary.claimed.empty());
+    EXPECT_TRUE(summary.repeated.empty());
+
+    sqlite3* db = nullptr;
+    ASSERT_EQ(sqlite3_open(dbPath.c_str(), &db), SQLITE_OK);
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM results WHERE ok = 1", -1, &stmt, nullptr);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_EQ(sqlite3_column_int(stmt, 0), static_cast<int>(jobs.size()));
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+}
+
+// A job claimed by a process that died is requeued and run by the next worker
+TEST_F(WorkQueueTest, DeadWorkerClaimRequeued) {
+    WorkQueue(dir).Submit({jobs[0], jobs[1]});
+
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        // Crash while holding the claim
+        WorkQueue::Claim claim;
+        WorkQueue(dir).TryClaim(claim);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    WorkQueue queue(dir);
+    ASSERT_EQ(queue.NumClaimed(), 1u);
+    EXPECT_EQ(queue.MergeResults(dir + "/results.db").stale.size(), 1u);
+
+    EXPECT_EQ(queue.Work(1, FakeRun), 2u);
+    EXPECT_EQ(queue.NumClaimed(), 0u);
+    EXPECT_EQ(queue.LoadResults().size(), 2u);
+}
+
+} // namespace test
+} // namespace gemmini
@@ -0,0 +1,71 @@
+// aligned_allocator.hpp - Over-aligned STL allocator for vector-friendly storage
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#include "gemmini/common.hpp"
+#include "utils/arena.hpp"
+
+BEGIN_NS(gemmini)
+
+// Cache line size assumed for row alignment and padding
+constexpr size_t kCacheLineBytes = 64;
+
+// STL allocator returning storage aligned to Align bytes. Storage comes from the arena
+// that was current on the constructing thread, or from the global heap if there was none.
+template <typename T, size_t Align = kCacheLineBytes>
+class AlignedAllocator {
+public:
+    static_assert(Align >= alignof(T), "Alignment must not be weaker than the type's");
+    static_assert((Align & (Align - 1)) == 0, "Alignment must be a power of two");
+
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Align>;
+    };
+
+    AlignedAllocator() noexcept : mArena(Arena::Current()) {}
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align> & other) noexcept
+        : mArena(other.GetArena()) {}
+
+    T* allocate(size_t n) {
+        if (mArena) {
+            return static_cast<T*>(mArena->Allocate(n * sizeof(T), Align));
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (mArena) {
+            mArena->Deallocate(p, n * sizeof(T));
+            return;
+        }
+        ::operator delete(p, std::align_val_t(Align));
+    }
+
+    Arena* GetArena() const noexcept { return mArena; }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Align> & other) const noexcept {
+        return mArena == other.GetArena();
+    }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Align> & other) const noexcept {
+        return mArena != other.GetArena();
+    }
+
+private:
+    Arena* mArena;
+};
+
+END_NS(gemmini)
@@ -0,0 +1,110 @@
+// arena.hpp - Per-thread bump allocation arena for simulation data
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// Arena - chunked bump allocator. Memory is only returned when the arena is reset or
+// destroyed, so everything allocated from it must be released before that.
+//
+// An arena created on a worker thread is first touched by that thread, which keeps its
+// pages on the worker's NUMA node under the default Linux first-touch policy.
+class Arena {
+public:
+    explicit Arena(size_t chunkBytes = 64 << 20) : mChunkBytes(chunkBytes) {}
+
+    ~Arena() { Release(); }
+
+    Arena(const Arena &) = delete;
+    Arena & operator=(const Arena &) = delete;
+
+    // Allocate bytes with the given power-of-two alignment
+    void* Allocate(size_t bytes, size_t align) {
+        size_t offset = (mOffset + align - 1) & ~(align - 1);
+        if (mChunks.empty() || offset + bytes > mChunks.back().size) {
+            NewChunk(std::max(bytes + align, mChunkBytes));
+            offset = 0;
+        }
+        void* p = mChunks.back().base + offset;
+        mOffset = offset + bytes;
+        mBytesAllocated += bytes;
+        return p;
+    }
+
+    // Individual frees are no-ops, the memory is reclaimed by Reset()
+    void Deallocate(void*, size_t bytes) { mBytesFreed += bytes; }
+
+    // Drop all allocations but keep the first chunk for reuse
+    void Reset() {
+        while (mChunks.size() > 1) {
+            ::operator delete(mChunks.back().base, std::align_val_t(kChunkAlign));
+            mChunks.pop_back();
+        }
+        mOffset = 0;
+        mBytesAllocated = 0;
+        mBytesFreed = 0;
+    }
+
+    // Statistics
+    size_t BytesAllocated() const { return mBytesAllocated; }
+    size_t BytesLive() const { return mBytesAllocated - mBytesFreed; }
+    size_t NumChunks() const { return mChunks.size(); }
+
+    // Arena used by allocations on the calling thread, nullptr for the global heap
+    static Arena* Current() { return CurrentSlot(); }
+    static void SetCurrent(Arena* arena) { CurrentSlot() = arena; }
+
+private:
+    struct Chunk {
+        char* base;
+        size_t size;
+    };
+
+    static constexpr size_t kChunkAlign = 4096;
+
+    const size_t mChunkBytes;
+    std::vector<Chunk> mChunks;
+    size_t mOffset = 0;
+    size_t mBytesAllocated = 0;
+    size_t mBytesFreed = 0;
+
+    void NewChunk(size_t bytes) {
+        char* base = static_cast<char*>(::operator new(bytes, std::align_val_t(kChunkAlign)));
+        mChunks.push_back({base, bytes});
+    }
+
+    void Release() {
+        for (auto & chunk : mChunks) {
+            ::operator delete(chunk.base, std::align_val_t(kChunkAlign));
+        }
+        mChunks.clear();
+        mOffset = 0;
+    }
+
+    static Arena*& CurrentSlot() {
+        thread_local Arena* current = nullptr;
+        return current;
+    }
+};
+
+// ArenaScope - makes an arena current on this thread for the lifetime of the scope
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena* arena) : mPrevious(Arena::Current()) { Arena::SetCurrent(arena); }
+    ~ArenaScope() { Arena::SetCurrent(mPrevious); }
+
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope & operator=(const ArenaScope &) = delete;
+
+private:
+    Arena* mPrevious;
+};
+
+END_NS(gemmini)
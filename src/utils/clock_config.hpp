@@ -0,0 +1,48 @@
+// clock_config.hpp - Clock domain frequencies for the Gemmini simulator
+#pragma once
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// Frequencies of the simulator's clock domains in MHz
+struct ClockConfig {
+    double mesh_mhz = 1000.0; // Systolic array and PEs
+    double spad_mhz = 1000.0; // Scratchpad and accumulator
+    double dram_mhz = 1000.0; // DMA engine and DRAM interface
+    double cmd_mhz = 1000.0;  // Command interface (matrix multiplier control)
+
+    // Apply a "domain=mhz" setting, returns false for an unknown domain or a value that is
+    // not a plain positive number, such as "1ghz"
+    bool Set(const std::string & spec) {
+        size_t eq = spec.find('=');
+        if (eq == std::string::npos) {
+            return false;
+        }
+        std::string domain = spec.substr(0, eq);
+        const char* value = spec.c_str() + eq + 1;
+        char* end = nullptr;
+        double mhz = std::strtod(value, &end);
+        if (end == value || *end != '\0' || !std::isfinite(mhz) || mhz <= 0.0) {
+            return false;
+        }
+        if (domain == "mesh") {
+            mesh_mhz = mhz;
+        } else if (domain == "spad") {
+            spad_mhz = mhz;
+        } else if (domain == "dram") {
+            dram_mhz = mhz;
+        } else if (domain == "cmd") {
+            cmd_mhz = mhz;
+        } else {
+            return false;
+        }
+        return true;
+    }
+};
+
+END_NS(gemmini)
@@ -0,0 +1,114 @@
+// dram_trace.cpp - Implementation of the buffered DRAM trace writer
+#include "utils/dram_trace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace gemmini {
+
+bool ParseDramTraceFormat(const std::string & name, DramTraceFormat & format) {
+    if (name == "dramsim3") {
+        format = DramTraceFormat::DRAMSim3;
+    } else if (name == "ramulator") {
+        format = DramTraceFormat::Ramulator;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+DramTraceWriter::DramTraceWriter(const DramTraceConfig & config)
+    : mConfig(config), mBytesPerCycle(std::max(1u, config.bytes_per_cycle)),
+      mFile(config.path) {
+    if (!mFile) {
+        throw std::runtime_error("Cannot create DRAM trace: " + config.path);
+    }
+    mFilling.reserve(mConfig.buffer_transfers);
+    mPending.reserve(mConfig.buffer_transfers);
+    mWriter = std::thread(&DramTraceWriter::WriterLoop, this);
+}
+
+DramTraceWriter::~DramTraceWriter() {
+    Close();
+}
+
+void DramTraceWriter::Close() {
+    if (mClosed) {
+        return;
+    }
+    HandOff();
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCondition.notify_all();
+    mWriter.join();
+    mFile.close();
+    mClosed = true;
+}
+
+// Swap the filled buffer with the writer's once it has drained the previous one
+void DramTraceWriter::HandOff() {
+    if (mFilling.empty()) {
+        return;
+    }
+    mTransfers += mFilling.size();
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this] { return mPending.empty(); });
+    mPending.swap(mFilling);
+    lock.unlock();
+    mCondition.notify_all();
+}
+
+void DramTraceWriter::WriterLoop() {
+    std::vector<Transfer> transfers;
+    transfers.reserve(mConfig.buffer_transfers);
+    std::string text;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this] { return !mPending.empty() || mStopping; });
+            if (mPending.empty()) {
+                return;
+            }
+            transfers.swap(mPending);
+        }
+        mCondition.notify_all();
+
+        WriteTransfers(transfers, text);
+        mFile.write(text.data(), static_cast<std::streamsize>(text.size()));
+        transfers.clear();
+        text.clear();
+    }
+}
+
+// Format transfers as one line per aligned burst
+void DramTraceWriter::WriteTransfers(const std::vector<Transfer> & transfers,
+                                     std::string & text) {
+    uint64_t burst = std::max(1u, mConfig.burst_bytes);
+    char line[64];
+    for (const auto & transfer : transfers) {
+        uint64_t bandwidth = transfer.bytes_per_cycle;
+        uint64_t first = transfer.address / burst * burst;
+        uint64_t end = transfer.address + std::max(1u, transfer.bytes);
+        for (uint64_t address = first; address < end; address += burst) {
+            int length;
+            if (mConfig.format == DramTraceFormat::DRAMSim3) {
+                uint64_t cycle = transfer.cycle + (address - first) / bandwidth;
+                length = snprintf(line, sizeof(line), "0x%llx %s %llu\n",
+                                  static_cast<unsigned long long>(address),
+                                  transfer.write ? "WRITE" : "READ",
+                                  static_cast<unsigned long long>(cycle));
+            } else {
+                length = snprintf(line, sizeof(line), "0x%llx %c\n",
+                                  static_cast<unsigned long long>(address),
+                                  transfer.write ? 'W' : 'R');
+            }
+            text.append(line, static_cast<size_t>(length));
+            ++mBursts;
+        }
+    }
+}
+
+} // namespace gemmini
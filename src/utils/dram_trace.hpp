@@ -0,0 +1,91 @@
+// dram_trace.hpp - DRAM transaction traces for external memory simulators
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// Trace line formats
+enum class DramTraceFormat {
+    DRAMSim3,  // "0x<addr> READ|WRITE <cycle>"
+    Ramulator, // "0x<addr> R|W", Ramulator's DRAM trace mode has no timestamps
+};
+
+// Parse "dramsim3" or "ramulator", returns false for anything else
+bool ParseDramTraceFormat(const std::string & name, DramTraceFormat & format);
+
+struct DramTraceConfig {
+    std::string path;
+    DramTraceFormat format = DramTraceFormat::DRAMSim3;
+    uint32_t burst_bytes = 64;       // Transfers are split into aligned bursts of this size
+    uint32_t bytes_per_cycle = 16;   // Bursts of one transfer are spaced at this bandwidth,
+                                     // in bytes per trace cycle
+    size_t buffer_transfers = 65536; // Transfers buffered before handing off to the writer
+};
+
+// DramTraceWriter - records DMA transfers and writes them as burst-level trace lines from a
+// background thread. Recording only appends to an in-memory buffer; a full buffer is swapped
+// with the writer's, so the simulation waits only if the writer falls a whole buffer behind.
+class DramTraceWriter {
+public:
+    explicit DramTraceWriter(const DramTraceConfig & config);
+    ~DramTraceWriter();
+
+    DramTraceWriter(const DramTraceWriter &) = delete;
+    DramTraceWriter & operator=(const DramTraceWriter &) = delete;
+
+    // Record one transfer starting at cycle
+    void Record(uint64_t cycle, uint64_t address, uint32_t bytes, bool write) {
+        mFilling.push_back({cycle, address, bytes, mBytesPerCycle, write});
+        if (mFilling.size() >= mConfig.buffer_transfers) {
+            HandOff();
+        }
+    }
+
+    // Burst spacing of transfers recorded from now on
+    void SetBytesPerCycle(uint32_t bytesPerCycle) { mBytesPerCycle = std::max(1u, bytesPerCycle); }
+
+    // Write out everything recorded so far and close the file
+    void Close();
+
+    const DramTraceConfig & Config() const { return mConfig; }
+    uint64_t NumTransfers() const { return mTransfers; }
+    uint64_t NumBursts() const { return mBursts; }
+
+private:
+    struct Transfer {
+        uint64_t cycle;
+        uint64_t address;
+        uint32_t bytes;
+        uint32_t bytes_per_cycle;
+        bool write;
+    };
+
+    const DramTraceConfig mConfig;
+    uint32_t mBytesPerCycle;
+    std::ofstream mFile;
+    std::vector<Transfer> mFilling;  // Owned by the simulation thread
+    std::vector<Transfer> mPending;  // Handed to the writer thread
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStopping = false;
+    bool mClosed = false;
+    std::thread mWriter;
+    uint64_t mTransfers = 0;
+    uint64_t mBursts = 0;            // Written by the writer thread, read after Close()
+
+    void HandOff();
+    void WriterLoop();
+    void WriteTransfers(const std::vector<Transfer> & transfers, std::string & text);
+};
+
+END_NS(gemmini)
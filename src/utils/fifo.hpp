@@ -10,7 +10,6 @@
 #include <string>
 #include <type_traits>
 
-#include "sparta/events/EventSet.hpp"
 #include "sparta/events/UniqueEvent.hpp"
 #include "sparta/log/MessageSource.hpp"
 #include "sparta/ports/DataPort.hpp"
@@ -58,6 +57,7 @@ public:
     // Parameters
     PARAMETER(uint32_t, depth, 1, "Depth of the FIFO (number of cycles of delay)")
     PARAMETER(bool, debug_mode, false, "Enable debug output")
+    PARAMETER(bool, enable_logging, false, "Create a log source for this FIFO")
 };
 
 // Port Set for DelayFifo
@@ -90,11 +90,15 @@ public:
 
     // Constructor
     DelayFifo(sparta::TreeNode* node, const DelayFifoParameterSet<T>* params)
-        : sparta::Unit(node), mPortSet(node), mUnitEventSet(node),
-          mLogger(node, "delay_fifo", "Delay FIFO Log"),
+        : sparta::Unit(node), mPortSet(node),
           mDepth(params->depth), mDebugMode(params->debug_mode),
-          mTickEvent(&mUnitEventSet, "tick_event", CREATE_SPARTA_HANDLER(DelayFifo, Tick)) {
-        
+          mTickEvent(&getEventSet(), "tick_event", CREATE_SPARTA_HANDLER(DelayFifo, Tick)) {
+
+        // Two FIFOs per PE, so the log source is only built when asked for
+        if (params->enable_logging) {
+            mLogger.reset(new sparta::log::MessageSource(node, "delay_fifo", "Delay FIFO Log"));
+        }
+
         // Register port handlers
         mPortSet.in.registerConsumerHandler(
             CREATE_SPARTA_HANDLER_WITH_DATA(DelayFifo, HandleInput, T));
@@ -144,11 +148,8 @@ private:
     // Port set
     DelayFifoPortSet<T> mPortSet;
     
-    // Event set for scheduling
-    sparta::EventSet mUnitEventSet;
-    
-    // Logger
-    sparta::log::MessageSource mLogger;
+    // Logger, only created when logging is enabled
+    std::unique_ptr<sparta::log::MessageSource> mLogger;
     
     // FIFO storage
     std::deque<T> mFifo;
@@ -0,0 +1,35 @@
+// lazy_counter.hpp - Read-only counter whose value is computed when it is read
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "sparta/statistics/ReadOnlyCounter.hpp"
+#include "sparta/statistics/StatisticSet.hpp"
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// LazyCounter - statistic backed by a function instead of a stored count. Nothing is
+// updated during simulation; the value is computed only when a report reads it.
+class LazyCounter : public sparta::ReadOnlyCounter {
+public:
+    using ValueFunc = std::function<counter_type()>;
+
+    LazyCounter(sparta::StatisticSet* parent, const std::string & name, const std::string & desc,
+                ValueFunc func)
+        : sparta::ReadOnlyCounter(parent, name, desc, sparta::CounterBase::COUNT_NORMAL, &mValue),
+          mFunc(std::move(func)) {}
+
+    counter_type get() const override {
+        mValue = mFunc();
+        return mValue;
+    }
+
+private:
+    mutable counter_type mValue = 0;
+    ValueFunc mFunc;
+};
+
+END_NS(gemmini)
@@ -0,0 +1,138 @@
+// memory_footprint.cpp - Implementation of host memory accounting
+#include "utils/memory_footprint.hpp"
+
+#include <fstream>
+#include <iomanip>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#ifdef __APPLE__
+#include <mach/mach.h>
+#include <malloc/malloc.h>
+#endif
+#include <unistd.h>
+
+namespace gemmini {
+
+void MemoryFootprint::Add(const std::string & type, uint32_t level, uint64_t bytes,
+                          uint64_t count) {
+    Entry & byType = mByType[type];
+    byType.bytes += bytes;
+    byType.count += count;
+    Entry & byLevel = mByLevel[level];
+    byLevel.bytes += bytes;
+    byLevel.count += count;
+    mTotalBytes += bytes;
+}
+
+uint64_t MemoryFootprint::HeapBytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#elif defined(__GLIBC__)
+    // The int counters of older glibc wrap above 2 GiB of heap
+    struct mallinfo info = mallinfo();
+    return static_cast<uint32_t>(info.uordblks) + static_cast<uint32_t>(info.hblkhd);
+#elif defined(__APPLE__)
+    // nullptr sums all malloc zones
+    malloc_statistics_t stats;
+    malloc_zone_statistics(nullptr, &stats);
+    return stats.size_in_use;
+#else
+    return 0;
+#endif
+}
+
+uint64_t MemoryFootprint::RssBytes() {
+#ifdef __APPLE__
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info),
+                  &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+#else
+    // statm holds sizes in pages: total, resident, ...
+    std::ifstream statm("/proc/self/statm");
+    uint64_t totalPages = 0;
+    uint64_t residentPages = 0;
+    if (!(statm >> totalPages >> residentPages)) {
+        return 0;
+    }
+    return residentPages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+bool MemoryFootprint::CanMeasureHeap() {
+#if defined(__GLIBC__) || defined(__APPLE__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool MemoryFootprint::CanMeasureRss() {
+    static const bool measurable = RssBytes() > 0;
+    return measurable;
+}
+
+FootprintScope::FootprintScope(const char* type)
+    : mType(type), mFootprint(MemoryFootprint::Current()), mParent(TopSlot()),
+      mLevel(mParent ? mParent->mLevel + 1 : 1), mStartBytes(0) {
+    if (mFootprint) {
+        mStartBytes = MemoryFootprint::HeapBytes();
+    }
+    TopSlot() = this;
+}
+
+FootprintScope::~FootprintScope() {
+    TopSlot() = mParent;
+    if (!mFootprint) {
+        return;
+    }
+
+    // Heap can shrink while a unit is built (e.g. temporaries freed), never report below 0
+    uint64_t endBytes = MemoryFootprint::HeapBytes();
+    uint64_t total = endBytes > mStartBytes ? endBytes - mStartBytes : 0;
+    uint64_t own = total > mChildBytes ? total - mChildBytes : 0;
+    mFootprint->Add(mType, mLevel, own);
+    if (mParent) {
+        mParent->mChildBytes += total;
+    }
+}
+
+std::ostream & operator<<(std::ostream & os, const MemoryFootprint & footprint) {
+    auto kb = [](uint64_t bytes) { return (bytes + 1023) / 1024; };
+
+    os << "Memory footprint: " << kb(footprint.TotalBytes()) << " KiB";
+    if (footprint.TreeNodes() > 0) {
+        os << " in " << footprint.TreeNodes() << " tree node(s)";
+    }
+    os << std::endl;
+    os << "  by unit type:" << std::endl;
+    for (const auto & entry : footprint.ByType()) {
+        os << "    " << std::left << std::setw(20) << entry.first << std::right << std::setw(10)
+           << kb(entry.second.bytes) << " KiB in " << entry.second.count << " instance(s)";
+        if (entry.second.count > 1) {
+            os << ", " << entry.second.bytes / entry.second.count << " B each";
+        }
+        if (entry.second.nodes > 0) {
+            os << ", " << entry.second.nodes << " tree node(s)";
+            if (entry.second.count > 1) {
+                os << " (" << entry.second.nodes / entry.second.count << " each)";
+            }
+        }
+        os << std::endl;
+    }
+    os << "  by tree level:" << std::endl;
+    for (const auto & entry : footprint.ByLevel()) {
+        os << "    level " << std::left << std::setw(14) << entry.first << std::right
+           << std::setw(10) << kb(entry.second.bytes) << " KiB in " << entry.second.count
+           << " node(s)" << std::endl;
+    }
+    return os;
+}
+
+} // namespace gemmini
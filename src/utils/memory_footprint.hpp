@@ -0,0 +1,104 @@
+// memory_footprint.hpp - Host memory accounting per unit type and tree level
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// MemoryFootprint - host memory attributed to the parts of one simulation. Tree units are
+// measured with FootprintScope while they are built; data that only exists during the run
+// (scratchpad contents, payloads) is added as an estimate before it starts.
+class MemoryFootprint {
+public:
+    struct Entry {
+        uint64_t bytes = 0;
+        uint64_t count = 0;
+        uint64_t nodes = 0; // Tree nodes in the instances' subtrees, if counted
+    };
+
+    // Attribute bytes to one instance of a unit type at a tree level (1 = below the root)
+    void Add(const std::string & type, uint32_t level, uint64_t bytes, uint64_t count = 1);
+
+    // Attribute tree nodes to a unit type, and set the node count of the whole tree
+    void AddNodes(const std::string & type, uint64_t nodes) { mByType[type].nodes += nodes; }
+    void SetTreeNodes(uint64_t nodes) { mTreeNodes = nodes; }
+    uint64_t TreeNodes() const { return mTreeNodes; }
+
+    const std::map<std::string, Entry> & ByType() const { return mByType; }
+    const std::map<uint32_t, Entry> & ByLevel() const { return mByLevel; }
+    uint64_t TotalBytes() const { return mTotalBytes; }
+
+    // Footprint that scopes on the calling thread record into, nullptr to disable
+    static MemoryFootprint* Current() { return CurrentSlot(); }
+    static void SetCurrent(MemoryFootprint* footprint) { CurrentSlot() = footprint; }
+
+    // Bytes currently allocated from the heap by the whole process, from mallinfo2 (glibc)
+    // or the malloc zones (macOS); 0 where the allocator cannot report it
+    static uint64_t HeapBytes();
+
+    // Resident set size of the process, from /proc (Linux) or the Mach task info (macOS);
+    // 0 where neither is available
+    static uint64_t RssBytes();
+
+    // Whether HeapBytes and RssBytes report real values on this host. Tree footprints and
+    // RSS budgets read as 0 where they do not.
+    static bool CanMeasureHeap();
+    static bool CanMeasureRss();
+
+private:
+    std::map<std::string, Entry> mByType;
+    std::map<uint32_t, Entry> mByLevel;
+    uint64_t mTotalBytes = 0;
+    uint64_t mTreeNodes = 0;
+
+    static MemoryFootprint*& CurrentSlot() {
+        thread_local MemoryFootprint* current = nullptr;
+        return current;
+    }
+};
+
+// FootprintScope - measures the heap growth while one unit is built and records it in the
+// current footprint. Scopes nest like the tree: memory of a nested scope is attributed to
+// the inner unit only, and each level of nesting is one tree level.
+//
+// The heap counters are process-wide, so allocations by other threads during the scope
+// are attributed to it as well. The batch runner builds trees one at a time, but other
+// workers keep running their jobs meanwhile, so it only reports tree memory for a job
+// built while no other job was running.
+class FootprintScope {
+public:
+    explicit FootprintScope(const char* type);
+    ~FootprintScope();
+
+    FootprintScope(const FootprintScope &) = delete;
+    FootprintScope & operator=(const FootprintScope &) = delete;
+
+private:
+    const char* mType;
+    MemoryFootprint* mFootprint;
+    FootprintScope* mParent;
+    uint32_t mLevel;
+    uint64_t mStartBytes;
+    uint64_t mChildBytes = 0;
+
+    static FootprintScope*& TopSlot() {
+        thread_local FootprintScope* top = nullptr;
+        return top;
+    }
+};
+
+// RSS budget checked before a simulation runs
+struct MemoryBudget {
+    uint64_t rss_bytes = 0; // 0 disables the check
+    bool fail = false;      // Refuse to run instead of only warning
+};
+
+// Print the footprint by unit type and by tree level
+std::ostream & operator<<(std::ostream & os, const MemoryFootprint & footprint);
+
+END_NS(gemmini)
@@ -0,0 +1,79 @@
+// profile.hpp - Build profile that fixes array parameters at compile time
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+#include "gemmini/common.hpp"
+
+// A profile build (cmake -DGEMMINI_PROFILE=config/systolic_config.yaml) defines these from the
+// profile's YAML. Anything left undefined stays a runtime parameter.
+#ifndef GEMMINI_PROFILE_NAME
+#define GEMMINI_PROFILE_NAME "generic"
+#endif
+#ifndef GEMMINI_PROFILE_ROWS
+#define GEMMINI_PROFILE_ROWS gemmini::kProfileNotFixed
+#endif
+#ifndef GEMMINI_PROFILE_COLS
+#define GEMMINI_PROFILE_COLS gemmini::kProfileNotFixed
+#endif
+#ifndef GEMMINI_PROFILE_COMPUTE_CYCLES
+#define GEMMINI_PROFILE_COMPUTE_CYCLES gemmini::kProfileNotFixed
+#endif
+#ifndef GEMMINI_PROFILE_DELAY_CYCLES
+#define GEMMINI_PROFILE_DELAY_CYCLES gemmini::kProfileNotFixed
+#endif
+#ifndef GEMMINI_PROFILE_ACT_WIDTH
+#define GEMMINI_PROFILE_ACT_WIDTH gemmini::kProfileNotFixed
+#endif
+#ifndef GEMMINI_PROFILE_WEIGHT_WIDTH
+#define GEMMINI_PROFILE_WEIGHT_WIDTH gemmini::kProfileNotFixed
+#endif
+
+BEGIN_NS(gemmini)
+
+constexpr uint32_t kProfileNotFixed = ~0u;
+
+// Settings of the build profile, kProfileNotFixed where the runtime parameter is used
+struct Profile {
+    static constexpr const char* kName = GEMMINI_PROFILE_NAME;
+    static constexpr uint32_t kRows = GEMMINI_PROFILE_ROWS;
+    static constexpr uint32_t kCols = GEMMINI_PROFILE_COLS;
+    static constexpr uint32_t kComputeCycles = GEMMINI_PROFILE_COMPUTE_CYCLES;
+    static constexpr uint32_t kDelayCycles = GEMMINI_PROFILE_DELAY_CYCLES;
+    static constexpr uint32_t kActWidth = GEMMINI_PROFILE_ACT_WIDTH;
+    static constexpr uint32_t kWeightWidth = GEMMINI_PROFILE_WEIGHT_WIDTH;
+
+    static constexpr bool kSpecialized = kRows != kProfileNotFixed || kCols != kProfileNotFixed ||
+                                         kComputeCycles != kProfileNotFixed ||
+                                         kDelayCycles != kProfileNotFixed;
+};
+
+// PEs hold activations and weights in 16-bit registers
+static_assert(Profile::kActWidth == kProfileNotFixed || Profile::kActWidth <= 16,
+              "Profile act_width must fit the PE's 16-bit activation register");
+static_assert(Profile::kWeightWidth == kProfileNotFixed || Profile::kWeightWidth <= 16,
+              "Profile weight_width must fit the PE's 16-bit weight register");
+
+// ProfileParam - a parameter that reads as the compile-time constant kFixed when the build
+// profile fixes it, so loops and branches on it fold away, and as the runtime value otherwise.
+// A runtime value that disagrees with the profile is reported and ignored.
+template <uint32_t kFixed>
+class ProfileParam {
+public:
+    ProfileParam(uint32_t value, const char* name)
+        : mValue(kFixed == kProfileNotFixed ? value : kFixed) {
+        if (kFixed != kProfileNotFixed && value != kFixed) {
+            std::cerr << "Warning: " << name << " is fixed to " << kFixed << " by the "
+                      << Profile::kName << " build profile, ignoring " << value << std::endl;
+        }
+    }
+
+    operator uint32_t() const { return kFixed == kProfileNotFixed ? mValue : kFixed; }
+    uint32_t Get() const { return *this; }
+
+private:
+    uint32_t mValue;
+};
+
+END_NS(gemmini)
@@ -0,0 +1,189 @@
+// sparse_memory.cpp - Implementation of the sparse DRAM backing store
+#include "utils/sparse_memory.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace gemmini {
+
+// Anonymous memory the kernel only backs with host pages once they are touched
+static void* MapAnonymous(size_t bytes, int prot) {
+    void* mapping = mmap(nullptr, bytes, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                         -1, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    return mapping;
+}
+
+static bool AllZero(const uint8_t* data, uint64_t bytes) {
+    for (uint64_t i = 0; i < bytes; ++i) {
+        if (data[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SparseMemory::SparseMemory(uint64_t pageBytes)
+    : mPageBytes(pageBytes == kHugePageBytes ? kHugePageBytes : kSmallPageBytes),
+      mChunkBytes(kHugePageBytes),
+      mZeroPage(static_cast<const uint8_t*>(MapAnonymous(mPageBytes, PROT_READ))) {}
+
+SparseMemory::~SparseMemory() {
+    for (const auto & chunk : mChunks) {
+        munmap(chunk.first, chunk.second);
+    }
+    for (const auto & region : mRegions) {
+        munmap(region.second.mapping, region.second.mapping_bytes);
+    }
+    munmap(const_cast<uint8_t*>(mZeroPage), mPageBytes);
+}
+
+uint8_t* SparseMemory::FindPage(uint64_t page) const {
+    if (page == mLastPage) {
+        return mLastData;
+    }
+    auto it = mPages.find(page);
+    if (it == mPages.end()) {
+        return nullptr;
+    }
+    mLastPage = page;
+    mLastData = it->second;
+    return it->second;
+}
+
+uint8_t* SparseMemory::AllocatePage(uint64_t page) {
+    if (mChunkNext == mChunkEnd) {
+        void* chunk = MapAnonymous(mChunkBytes, PROT_READ | PROT_WRITE);
+#ifdef MADV_HUGEPAGE
+        if (mPageBytes == kHugePageBytes) {
+            madvise(chunk, mChunkBytes, MADV_HUGEPAGE);
+        }
+#endif
+        mChunks.emplace_back(chunk, mChunkBytes);
+        mChunkNext = static_cast<uint8_t*>(chunk);
+        mChunkEnd = mChunkNext + mChunkBytes;
+    }
+    uint8_t* data = mChunkNext;
+    mChunkNext += mPageBytes;
+    mPages[page] = data;
+    mLastPage = page;
+    mLastData = data;
+    return data;
+}
+
+const SparseMemory::Region* SparseMemory::FindRegion(uint64_t address, uint64_t & start,
+                                                     uint64_t & limit) const {
+    auto next = mRegions.upper_bound(address);
+    if (next != mRegions.begin()) {
+        auto it = std::prev(next);
+        if (address < it->first + it->second.bytes) {
+            start = it->first;
+            limit = it->first + it->second.bytes - address;
+            return &it->second;
+        }
+    }
+    limit = next == mRegions.end() ? ~0ull : next->first - address;
+    return nullptr;
+}
+
+void SparseMemory::Read(uint64_t address, void* data, uint64_t bytes) const {
+    uint8_t* out = static_cast<uint8_t*>(data);
+    while (bytes > 0) {
+        uint64_t start = 0;
+        uint64_t limit;
+        const Region* region = FindRegion(address, start, limit);
+        uint64_t length = std::min(bytes, limit);
+        if (region) {
+            std::memcpy(out, region->data + (address - start), length);
+        } else {
+            uint64_t offset = address & (mPageBytes - 1);
+            length = std::min(length, mPageBytes - offset);
+            const uint8_t* page = FindPage(address / mPageBytes);
+            std::memcpy(out, (page ? page : mZeroPage) + offset, length);
+        }
+        address += length;
+        out += length;
+        bytes -= length;
+    }
+}
+
+void SparseMemory::Write(uint64_t address, const void* data, uint64_t bytes) {
+    const uint8_t* in = static_cast<const uint8_t*>(data);
+    while (bytes > 0) {
+        uint64_t start = 0;
+        uint64_t limit;
+        const Region* region = FindRegion(address, start, limit);
+        uint64_t length = std::min(bytes, limit);
+        if (region) {
+            std::memcpy(region->data + (address - start), in, length);
+        } else {
+            uint64_t offset = address & (mPageBytes - 1);
+            length = std::min(length, mPageBytes - offset);
+            uint64_t pageNumber = address / mPageBytes;
+            uint8_t* page = FindPage(pageNumber);
+            // Zeros written to an untouched page leave it on the shared zero page
+            if (!page && !AllZero(in, length)) {
+                page = AllocatePage(pageNumber);
+            }
+            if (page) {
+                std::memcpy(page + offset, in, length);
+            }
+        }
+        address += length;
+        in += length;
+        bytes -= length;
+    }
+}
+
+void SparseMemory::MapFile(uint64_t address, const std::string & path, uint64_t offset,
+                           uint64_t bytes) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file to map: " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || offset > static_cast<uint64_t>(st.st_size)) {
+        close(fd);
+        throw std::runtime_error("Mapping offset is past the end of " + path);
+    }
+    uint64_t available = static_cast<uint64_t>(st.st_size) - offset;
+    bytes = bytes == 0 ? available : std::min(bytes, available);
+
+    uint64_t end = address + bytes;
+    auto next = mRegions.lower_bound(address);
+    if (bytes == 0 || (next != mRegions.end() && next->first < end) ||
+        (next != mRegions.begin() &&
+         std::prev(next)->first + std::prev(next)->second.bytes > address)) {
+        close(fd);
+        throw std::runtime_error("Mapping of " + path + " is empty or overlaps another file");
+    }
+
+    // mmap offsets must be page aligned, map from the page holding offset
+    uint64_t hostPage = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t mapOffset = offset / hostPage * hostPage;
+    size_t mapBytes = static_cast<size_t>(offset - mapOffset + bytes);
+    void* mapping = mmap(nullptr, mapBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+                         static_cast<off_t>(mapOffset));
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map file: " + path);
+    }
+
+    Region region;
+    region.bytes = bytes;
+    region.data = static_cast<uint8_t*>(mapping) + (offset - mapOffset);
+    region.mapping = mapping;
+    region.mapping_bytes = mapBytes;
+    mRegions[address] = region;
+    mMappedBytes += bytes;
+}
+
+} // namespace gemmini
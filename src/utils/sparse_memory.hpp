@@ -0,0 +1,79 @@
+// sparse_memory.hpp - Sparse page-based backing store for simulated DRAM contents
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gemmini/common.hpp"
+
+BEGIN_NS(gemmini)
+
+// SparseMemory - byte-addressable memory for a large simulated address space that only
+// holds the pages actually written. Pages are allocated on the first write of non-zero data;
+// every other page reads as the one shared zero page. Files (e.g. extracted weight tensors)
+// can be mapped over address ranges and are paged in by the host on demand; writes to them
+// stay private to this memory. Host RSS therefore tracks only the data that is touched.
+//
+// Not thread-safe; each simulation owns its memory.
+class SparseMemory {
+public:
+    static constexpr uint64_t kSmallPageBytes = 4096;
+    static constexpr uint64_t kHugePageBytes = 2ull << 20;
+
+    // pageBytes is kSmallPageBytes or kHugePageBytes
+    explicit SparseMemory(uint64_t pageBytes = kSmallPageBytes);
+    ~SparseMemory();
+
+    SparseMemory(const SparseMemory &) = delete;
+    SparseMemory & operator=(const SparseMemory &) = delete;
+
+    void Read(uint64_t address, void* data, uint64_t bytes) const;
+    void Write(uint64_t address, const void* data, uint64_t bytes);
+
+    // Map bytes of a file starting at offset (0 = to the end of the file) at address.
+    // Mapped ranges take precedence over pages and must not overlap each other.
+    void MapFile(uint64_t address, const std::string & path, uint64_t offset = 0,
+                 uint64_t bytes = 0);
+
+    uint64_t PageBytes() const { return mPageBytes; }
+    uint64_t NumPages() const { return mPages.size(); }
+    uint64_t ResidentBytes() const { return mPages.size() * mPageBytes; }
+    uint64_t MappedBytes() const { return mMappedBytes; }
+
+private:
+    struct Region {
+        uint64_t bytes;
+        uint8_t* data;     // Start of the range inside the mapping
+        void* mapping;
+        size_t mapping_bytes;
+    };
+
+    const uint64_t mPageBytes;
+    const uint64_t mChunkBytes;
+    std::unordered_map<uint64_t, uint8_t*> mPages; // Page number to page data
+    std::map<uint64_t, Region> mRegions;           // Mapped files by start address
+    uint64_t mMappedBytes = 0;
+    const uint8_t* mZeroPage;
+
+    // Pages are carved from large anonymous mappings
+    std::vector<std::pair<void*, size_t>> mChunks;
+    uint8_t* mChunkNext = nullptr;
+    uint8_t* mChunkEnd = nullptr;
+
+    // Last page looked up, accesses are mostly sequential
+    mutable uint64_t mLastPage = ~0ull;
+    mutable uint8_t* mLastData = nullptr;
+
+    uint8_t* FindPage(uint64_t page) const;
+    uint8_t* AllocatePage(uint64_t page);
+
+    // Mapped region containing address, or nullptr; limit is set to the bytes that can be
+    // accessed before the next region boundary
+    const Region* FindRegion(uint64_t address, uint64_t & start, uint64_t & limit) const;
+};
+
+END_NS(gemmini)